@@ -0,0 +1,124 @@
+/*
+ * Cybor's Counter Strike v2.5 - Audio Mixer Test
+ * Drives the audio system headless, the way a busy firefight would: shots
+ * all around the listener at a rate that keeps the requested number of
+ * voices playing. Only the most audible are mixed, so the mixer's cost per
+ * block, reported against its real-time budget, should hold steady however
+ * many voices are asked for. Can write the mix to a WAV file to listen to.
+ *
+ * Usage: CyborCounterStrike_AudioTest [--voices N] [--seconds S] [--wav FILE] [--seed S]
+ */
+
+#include "src/Audio/CyborAudioSystem.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int TICK_RATE = 64;
+const float SHOT_LENGTH = 0.25f; // Seconds, the synthesized weapon_fire
+const float MAX_DISTANCE = 40.0f;
+
+struct AudioTestConfig {
+    int voices = 32;
+    double seconds = 10.0;
+    std::string wavPath;
+    uint32_t seed = 1;
+};
+
+bool ParseArguments(int argc, char* argv[], AudioTestConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return false;
+        }
+        const std::string value = argv[++i];
+
+        if (option == "--voices") config.voices = std::atoi(value.c_str());
+        else if (option == "--seconds") config.seconds = std::atof(value.c_str());
+        else if (option == "--wav") config.wavPath = value;
+        else if (option == "--seed") config.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return false;
+        }
+    }
+
+    if (config.voices < 1 || config.seconds <= 0.0) {
+        std::cerr << "Invalid audio test settings" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PrintStats(const CyborAudioMixer::Stats& stats) {
+    const double budget = static_cast<double>(CyborAudioMixer::BLOCK_FRAMES) / CyborAudioMixer::SAMPLE_RATE;
+    std::cout << "  " << stats.voices << " voices (" << stats.realVoices << " mixed), mix " << stats.meanMixTime * 1e6 << " us mean, "
+              << stats.maxMixTime * 1e6 << " us max per block (" << stats.meanMixTime / budget * 100.0
+              << "% of the " << budget * 1000.0 << " ms budget), " << stats.blocks << " blocks, "
+              << stats.stolenVoices << " stolen, " << stats.droppedCommands << " commands dropped" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    AudioTestConfig config;
+    if (!ParseArguments(argc, argv, config)) return -1;
+
+    std::cout << "=================================================" << std::endl;
+    std::cout << "  CYBOR'S COUNTER STRIKE v2.5 - AUDIO MIXER TEST" << std::endl;
+    std::cout << "=================================================" << std::endl;
+
+    std::unique_ptr<CyborAudioSink> sink;
+    if (config.wavPath.empty()) sink = std::make_unique<CyborNullAudioSink>();
+    else sink = std::make_unique<CyborWavFileSink>(config.wavPath);
+
+    CyborAudioSystem audio;
+    if (!audio.Initialize(std::move(sink))) return -1;
+    audio.SetListenerPosition(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // Each shot plays for SHOT_LENGTH, so this many a tick keeps about the requested number going
+    const double shotsPerTick = config.voices / SHOT_LENGTH / TICK_RATE;
+    std::mt19937 random(config.seed);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> distance(1.0f, MAX_DISTANCE * 0.5f);
+
+    const float deltaTime = 1.0f / TICK_RATE;
+    const Clock::duration tickInterval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(deltaTime));
+    const Clock::time_point start = Clock::now();
+    Clock::time_point nextTick = start;
+    double pendingShots = 0.0;
+    int second = 0;
+    while (std::chrono::duration<double>(Clock::now() - start).count() < config.seconds) {
+        for (pendingShots += shotsPerTick; pendingShots >= 1.0; pendingShots -= 1.0) {
+            const float a = angle(random);
+            const float d = distance(random);
+            audio.PlaySound3D("weapon_fire", glm::vec3(std::cos(a) * d, 0.0f, std::sin(a) * d), 1.0f, MAX_DISTANCE);
+        }
+        audio.Update(deltaTime);
+
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (static_cast<int>(elapsed) > second) {
+            second = static_cast<int>(elapsed);
+            std::cout << "After " << second << " s:" << std::endl;
+            PrintStats(audio.GetMixerStats());
+        }
+
+        nextTick += tickInterval;
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    std::cout << "Final:" << std::endl;
+    PrintStats(audio.GetMixerStats());
+    audio.Shutdown();
+    if (!config.wavPath.empty()) std::cout << "Mix written to " << config.wavPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Cybor's Counter Strike v2.5 - Demo Inspector
+ * Reads a demo recorded by a server (CyborCounterStrike_LoadTest --record,
+ * or CyborNetworkManager::StartDemoRecording) and prints its contents: the
+ * blocks, the game events, and the world at any tick.
+ *
+ * Usage: CyborCounterStrike_Demo FILE [--seek TICK] [--events]
+ */
+
+#include "src/Network/CyborDemo.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* EventName(CyborNetworkManager::GameEvent::Type type) {
+    switch (type) {
+        case CyborNetworkManager::GameEvent::Type::PLAYER_JOINED: return "joined";
+        case CyborNetworkManager::GameEvent::Type::PLAYER_LEFT: return "left";
+        case CyborNetworkManager::GameEvent::Type::KILL: return "kill";
+        case CyborNetworkManager::GameEvent::Type::ROUND_END: return "round end";
+    }
+    return "unknown";
+}
+
+void PrintEvents(CyborDemoReader& demo) {
+    std::cout << "Events:" << std::endl;
+    demo.Rewind();
+    int events = 0;
+    while (demo.Next()) {
+        if (demo.GetRecordType() != CyborDemoReader::RecordType::EVENT) continue;
+        const CyborNetworkManager::GameEvent& event = demo.GetEvent();
+        std::cout << "  tick " << demo.GetTick() << ": " << EventName(event.type) << " subject " << event.subjectId
+                  << " instigator " << event.instigatorId << " value " << event.value;
+        if (!event.text.empty()) std::cout << " \"" << event.text << "\"";
+        std::cout << std::endl;
+        events++;
+    }
+    std::cout << "  " << events << " events" << std::endl;
+}
+
+void PrintWorld(CyborDemoReader& demo, uint32_t tick) {
+    const Clock::time_point start = Clock::now();
+    if (!demo.Seek(tick)) {
+        std::cerr << "No snapshot at or after tick " << tick << std::endl;
+        return;
+    }
+    const double seekMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::vector<CyborSnapshotCodec::EntityState> states;
+    demo.GetEntityStates(states);
+    std::cout << "Tick " << demo.GetTick() << ", server time " << demo.GetSnapshot().serverTime << " s, "
+              << states.size() << " entities (seek took " << std::setprecision(3) << seekMs << " ms):" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const CyborSnapshotCodec::EntityState& state : states) {
+        std::cout << "  entity " << state.entityId << " at (" << state.position.x << ", " << state.position.y << ", "
+                  << state.position.z << ") yaw " << state.yaw << " health " << static_cast<int>(state.health)
+                  << (state.alive ? "" : " dead") << " team " << static_cast<int>(state.team) << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " FILE [--seek TICK] [--events]" << std::endl;
+        return -1;
+    }
+
+    const std::string path = argv[1];
+    bool seek = false;
+    uint32_t seekTick = 0;
+    bool events = false;
+    for (int i = 2; i < argc; i++) {
+        const std::string option = argv[i];
+        if (option == "--events") {
+            events = true;
+        } else if (option == "--seek" && i + 1 < argc) {
+            seek = true;
+            seekTick = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return -1;
+        }
+    }
+
+    CyborDemoReader demo;
+    if (!demo.Open(path)) return -1;
+
+    const float snapshotInterval = demo.GetSnapshotInterval();
+    std::cout << path << ": " << demo.GetTickCount() << " snapshots in " << demo.GetBlockCount() << " blocks, "
+              << demo.GetTickCount() * snapshotInterval << " s at " << 1.0f / snapshotInterval
+              << " snapshots per second" << std::endl;
+
+    if (events) PrintEvents(demo);
+    if (seek) PrintWorld(demo, seekTick);
+    return 0;
+}
@@ -0,0 +1,664 @@
+/*
+ * Cybor's Counter Strike v2.5 - Server Load Test
+ * Runs a headless server and hundreds to thousands of synthetic clients over
+ * loopback, then reports server tick time, bandwidth per client and packet
+ * rates. Tells us how many players a box can hold before the tick overruns.
+ *
+ * Usage: CyborCounterStrike_LoadTest [--clients N] [--seconds S] [--tickrate HZ]
+ *            [--snapshot-rate HZ] [--port P] [--mode script|wander] [--client-threads T]
+ *            [--key HEX] [--latency MS] [--jitter MS] [--loss PERCENT] [--seed S]
+ *            [--degrade on|off] [--client-bandwidth BYTES_PER_SECOND]
+ *            [--spectators N] [--broadcast-delay S] [--record DEMO_FILE]
+ */
+
+#include "src/Engine/CyborTickScheduler.h"
+#include "src/Network/CyborNetworkManager.h"
+#include "src/Network/CyborBroadcastRelay.h"
+#include "src/Game/CyborPlayer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const float ARENA_RADIUS = 56.0f; // Inside the snapshot quantization bounds
+const float EYE_HEIGHT = 1.6f;
+const double CONNECT_TIMEOUT = 15.0;
+
+struct LoadTestConfig {
+    int clients = 256;
+    double seconds = 20.0;
+    int tickRate = 64;
+    int snapshotRate = 20;
+    int clientBandwidth = 0; // Snapshot bytes per second per client; 0 for one packet per snapshot
+    int port = 27115;
+    bool wander = true; // Bot-driven; false replays one scripted route per client
+    int clientThreads = 2;
+    std::string key;
+    CyborLinkEmulator::Settings link;
+    bool emulateLink = false;
+    uint64_t seed = 1;
+    bool degrade = true; // Shed snapshot detail when the tick runs over
+    int spectators = 0;  // Watching through a broadcast relay on port + 1
+    double broadcastDelay = 1.0; // The server refuses relays without one
+    std::string demoPath; // Server records a demo here when set
+};
+
+double Seconds(Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+float WrapYaw(float yaw) {
+    while (yaw > 180.0f) yaw -= 360.0f;
+    while (yaw <= -180.0f) yaw += 360.0f;
+    return yaw;
+}
+
+// Server's view of its clients' links, averaged over the connections with a measured round trip
+struct LinkSummary {
+    int connections = 0;
+    double rtt = 0.0;
+    double jitter = 0.0;
+    double upLoss = 0.0;   // Client to server
+    double downLoss = 0.0; // Server to client
+};
+
+// What the spectators saw, filled in when the broadcast thread finishes
+struct BroadcastSummary {
+    int spectators = 0;
+    double serverBandwidth = 0.0;    // Relay's link to the game server, bytes per second
+    double spectatorBandwidth = 0.0; // Per spectator
+    double entities = 0.0;           // Mean entities in a spectator's latest snapshot
+    uint64_t received = 0;
+    uint64_t relayed = 0;
+};
+
+double Percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+/*
+ * LoadTestServer - Headless authoritative server on its own thread
+ * Runs every client's commands through the same movement code as the game and
+ * answers with player state and world snapshots, timing each tick.
+ */
+class LoadTestServer {
+public:
+    explicit LoadTestServer(const LoadTestConfig& config)
+        : m_config(config), m_running(false), m_measuring(false), m_scheduler(config.tickRate),
+          m_measuredStats(), m_tick(0) {
+        m_scheduler.EnableDegradation(config.degrade);
+        m_scheduler.EnableReporting(true);
+    }
+
+    bool Start() {
+        m_network.Initialize();
+        m_network.SetSnapshotRate(m_config.snapshotRate);
+        m_network.SetClientBandwidthLimit(m_config.clientBandwidth);
+        m_network.SetBroadcastDelay(static_cast<float>(m_config.broadcastDelay));
+        m_network.AllowBroadcastRelay("127.0.0.1");
+        if (m_config.emulateLink && !m_network.SetLinkEmulation(m_config.link, m_config.seed)) return false;
+        if (!m_config.key.empty()) {
+            if (!m_network.SetCyborKey(m_config.key)) return false;
+            m_network.SetCyborEncryption(true);
+        }
+        if (!m_network.StartServer(m_config.port, m_config.clients + (m_config.spectators > 0 ? 1 : 0))) return false;
+        if (!m_config.demoPath.empty() && !m_network.StartDemoRecording(m_config.demoPath)) return false;
+
+        m_running = true;
+        m_thread = std::thread(&LoadTestServer::Run, this);
+        return true;
+    }
+
+    void Stop() {
+        m_running = false;
+        if (m_thread.joinable()) m_thread.join();
+        m_network.Shutdown();
+    }
+
+    // Any thread
+    int GetPlayerCount() const { return m_network.GetPlayerCount(); }
+    const CyborUdpTransport& GetTransport() const { return m_network.GetTransport(); }
+    void SetMeasuring(bool measuring) { m_measuring = measuring; }
+
+    // After Stop()
+    const std::vector<double>& GetTickTimes() const { return m_tickTimes; }
+    const CyborTickScheduler::Stats& GetStats() const { return m_measuredStats; }
+    const LinkSummary& GetLinkSummary() const { return m_measuredLinks; }
+    double GetBudget() const { return m_scheduler.GetBudget(); }
+
+private:
+    struct SimulatedPlayer {
+        CyborPlayer player;
+        uint32_t entityId;
+        uint8_t team;
+        uint32_t lastSequence;
+        uint64_t lastSeenTick;
+    };
+
+    const LoadTestConfig& m_config;
+    CyborNetworkManager m_network;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_measuring;
+
+    // Server thread only
+    std::unordered_map<uint32_t, std::unique_ptr<SimulatedPlayer>> m_players;
+    std::vector<CyborSnapshotCodec::EntityState> m_states;
+    CyborTickScheduler m_scheduler;
+    CyborTickScheduler::Stats m_measuredStats;
+    LinkSummary m_measuredLinks;
+    std::vector<double> m_tickTimes;
+    uint64_t m_tick;
+
+    void Run() {
+        bool measuring = false;
+        while (m_running) {
+            m_scheduler.WaitForNextTick();
+
+            // Statistics cover the measured window only
+            if (m_measuring != measuring) {
+                measuring = m_measuring;
+                if (measuring) {
+                    m_scheduler.ResetStats();
+                } else {
+                    m_measuredStats = m_scheduler.GetStats();
+                    m_measuredLinks = SummarizeLinks();
+                }
+            }
+
+            Tick(m_scheduler.GetTickInterval());
+            if (measuring) m_tickTimes.push_back(m_scheduler.GetLastTick().totalTime);
+            m_network.SetSnapshotLevelOfDetail(m_scheduler.GetDegradationLevel());
+        }
+        if (measuring) {
+            m_measuredStats = m_scheduler.GetStats();
+            m_measuredLinks = SummarizeLinks();
+        }
+    }
+
+    LinkSummary SummarizeLinks() const {
+        LinkSummary links;
+        CyborNetworkStats::Summary stats;
+        for (const auto& info : *m_network.GetConnectedPlayers()) {
+            if (!m_network.GetConnectionStats(info.peerId, stats) || !stats.hasRtt) continue;
+            links.connections++;
+            links.rtt += stats.rtt;
+            links.jitter += stats.jitter;
+            links.upLoss += stats.packetLoss;
+            links.downLoss += stats.outboundLoss;
+        }
+        if (links.connections > 0) {
+            links.rtt /= links.connections;
+            links.jitter /= links.connections;
+            links.upLoss /= links.connections;
+            links.downLoss /= links.connections;
+        }
+        return links;
+    }
+
+    void Tick(float deltaTime) {
+        m_scheduler.BeginTick();
+        m_scheduler.BeginPhase(CyborTickScheduler::Phase::RECEIVE);
+        m_network.Update(deltaTime);
+        m_tick++;
+
+        m_scheduler.BeginPhase(CyborTickScheduler::Phase::SIMULATE);
+
+        CyborNetworkManager::PlayerRoster roster = m_network.GetConnectedPlayers();
+        m_states.clear();
+        for (const auto& info : *roster) {
+            SimulatedPlayer& simulated = GetPlayer(info.peerId);
+            simulated.lastSeenTick = m_tick;
+
+            std::vector<CyborInputCommand>& commands = m_network.GetClientCommands(info.peerId);
+            for (const auto& command : commands) {
+                simulated.player.SimulateCommand(command);
+                simulated.lastSequence = command.sequence;
+            }
+            const bool ranCommands = !commands.empty();
+            commands.clear();
+
+            const CyborMoveState state = simulated.player.GetMoveState();
+            if (ranCommands) m_network.SendPlayerState(info.peerId, simulated.lastSequence, state);
+            m_network.SetClientViewer(info.peerId, simulated.entityId,
+                                      state.position + glm::vec3(0.0f, EYE_HEIGHT, 0.0f), simulated.team);
+
+            CyborSnapshotCodec::EntityState entity;
+            entity.entityId = simulated.entityId;
+            entity.position = state.position;
+            entity.yaw = simulated.player.GetYaw();
+            entity.pitch = simulated.player.GetPitch();
+            entity.health = simulated.player.GetHealth();
+            entity.armor = simulated.player.GetArmor();
+            entity.weaponType = 0;
+            entity.team = simulated.team;
+            entity.alive = simulated.player.IsAlive();
+            m_states.push_back(entity);
+        }
+
+        // Forget players who left
+        for (auto it = m_players.begin(); it != m_players.end();) {
+            it = it->second->lastSeenTick == m_tick ? std::next(it) : m_players.erase(it);
+        }
+
+        m_scheduler.BeginPhase(CyborTickScheduler::Phase::SEND);
+        m_network.SendWorldSnapshot(m_states);
+        m_scheduler.EndTick();
+    }
+
+    SimulatedPlayer& GetPlayer(uint32_t peerId) {
+        auto it = m_players.find(peerId);
+        if (it != m_players.end()) return *it->second;
+
+        // Spread evenly over the arena (a sunflower pattern) so everyone has neighbours in sight
+        auto simulated = std::make_unique<SimulatedPlayer>();
+        const float angle = peerId * 2.39996f; // Golden angle
+        const float radius = ARENA_RADIUS * std::sqrt((peerId % 997 + 0.5f) / 997.0f);
+        simulated->player.Initialize(glm::vec3(radius * std::cos(angle), 1.8f, radius * std::sin(angle)));
+        simulated->entityId = peerId + 1;
+        simulated->team = static_cast<uint8_t>(peerId % 2);
+        simulated->lastSequence = 0;
+        simulated->lastSeenTick = 0;
+        return *m_players.emplace(peerId, std::move(simulated)).first->second;
+    }
+};
+
+/*
+ * SyntheticClient - One simulated player, a full client network stack without the game
+ * Sends a command every tick, from a fixed script or a wandering bot that
+ * steers back when the server says it has strayed too far.
+ */
+class SyntheticClient {
+public:
+    SyntheticClient(int index, const LoadTestConfig& config)
+        : m_index(index), m_config(config), m_random(config.seed * 7919 + index),
+          m_sequence(0), m_time(0.0f), m_yaw(0.0f), m_buttons(CyborInputCommand::FORWARD),
+          m_decisionTimer(0.0f), m_position(0.0f), m_failed(false) {
+    }
+
+    bool Connect() {
+        m_network.Initialize();
+        m_network.SetPlayerName("LoadBot" + std::to_string(m_index));
+        if (!m_config.key.empty()) {
+            m_network.SetCyborKey(m_config.key);
+            m_network.SetCyborEncryption(true);
+        }
+        m_failed = !m_network.ConnectToServer("127.0.0.1", m_config.port);
+        return !m_failed;
+    }
+
+    void Update(float deltaTime) {
+        if (m_failed) return;
+        m_network.Update(deltaTime);
+        m_time += deltaTime;
+
+        uint32_t lastProcessedSequence;
+        CyborMoveState serverState;
+        while (m_network.PollAuthoritativeState(lastProcessedSequence, serverState)) {
+            m_position = serverState.position;
+        }
+        if (!m_network.IsConnected()) return;
+
+        if (m_config.wander) {
+            Wander(deltaTime);
+        } else {
+            Script();
+        }
+
+        CyborInputCommand command;
+        command.sequence = ++m_sequence;
+        command.deltaTime = deltaTime;
+        command.yaw = CyborInputCommand::SnapAngle(m_yaw);
+        command.pitch = 0.0f;
+        command.buttons = m_buttons;
+        m_commands.push_back(command);
+        m_network.SendInputCommands(m_commands);
+    }
+
+    void Disconnect() { m_network.Shutdown(); }
+
+private:
+    int m_index;
+    const LoadTestConfig& m_config;
+    CyborNetworkManager m_network;
+    std::mt19937 m_random;
+    std::vector<CyborInputCommand> m_commands;
+    uint32_t m_sequence;
+    float m_time;
+    float m_yaw;
+    uint8_t m_buttons;
+    float m_decisionTimer;
+    glm::vec3 m_position; // Last authoritative position
+    bool m_failed;
+
+    // Circles at a per-client phase, with periodic sprints and jumps
+    void Script() {
+        const float phase = m_index * 0.618f;
+        m_yaw = WrapYaw((m_time + phase) * 45.0f);
+        m_buttons = CyborInputCommand::FORWARD;
+        if (std::fmod(m_time + phase, 4.0f) < 1.5f) m_buttons |= CyborInputCommand::SPRINT;
+        if (std::fmod(m_time + phase, 3.0f) < 0.05f) m_buttons |= CyborInputCommand::JUMP;
+    }
+
+    // Picks a new heading and gait every second or two, like an idle bot patrolling
+    void Wander(float deltaTime) {
+        m_decisionTimer -= deltaTime;
+        if (m_decisionTimer <= 0.0f) {
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            m_decisionTimer = 0.5f + 1.5f * unit(m_random);
+            m_yaw = WrapYaw(m_yaw + (unit(m_random) - 0.5f) * 180.0f);
+
+            const float gait = unit(m_random);
+            m_buttons = gait < 0.15f ? 0 : CyborInputCommand::FORWARD;
+            if (gait > 0.7f) m_buttons |= CyborInputCommand::SPRINT;
+            if (unit(m_random) < 0.2f) m_buttons |= unit(m_random) < 0.5f ? CyborInputCommand::LEFT : CyborInputCommand::RIGHT;
+            if (unit(m_random) < 0.1f) m_buttons |= CyborInputCommand::JUMP;
+            if (unit(m_random) < 0.05f) m_buttons |= CyborInputCommand::CROUCH;
+        }
+
+        // Head back towards the middle near the edge
+        const float distance = std::sqrt(m_position.x * m_position.x + m_position.z * m_position.z);
+        if (distance > ARENA_RADIUS) {
+            m_yaw = WrapYaw(glm::degrees(std::atan2(-m_position.z, -m_position.x)));
+            m_buttons = CyborInputCommand::FORWARD;
+        }
+    }
+};
+
+// Owns a share of the clients and ticks them at the game rate until told to stop
+void RunClients(const LoadTestConfig& config, int first, int count, std::atomic<bool>& running) {
+    std::vector<std::unique_ptr<SyntheticClient>> clients;
+    clients.reserve(count);
+    for (int i = first; i < first + count; i++) {
+        clients.emplace_back(new SyntheticClient(i, config));
+        if (!clients.back()->Connect()) {
+            std::cerr << "Synthetic client " << i << " failed to start" << std::endl;
+        }
+    }
+
+    const float deltaTime = 1.0f / config.tickRate;
+    const Clock::duration tickInterval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(deltaTime));
+    Clock::time_point nextTick = Clock::now();
+
+    while (running) {
+        for (auto& client : clients) client->Update(deltaTime);
+
+        nextTick += tickInterval;
+        const Clock::time_point now = Clock::now();
+        if (nextTick < now) nextTick = now;
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    for (auto& client : clients) client->Disconnect();
+}
+
+// A broadcast relay and the spectators watching through it, ticked together on one thread
+void RunBroadcast(const LoadTestConfig& config, std::atomic<bool>& running, BroadcastSummary& outSummary) {
+    CyborBroadcastRelay::Settings settings;
+    settings.serverPort = config.port;
+    settings.port = config.port + 1;
+    settings.maxSpectators = config.spectators;
+    settings.tickRate = config.tickRate;
+    settings.key = config.key;
+    CyborBroadcastRelay relay;
+    if (!relay.Start(settings)) {
+        std::cerr << "Broadcast relay failed to start" << std::endl;
+        return;
+    }
+
+    std::vector<std::unique_ptr<CyborNetworkManager>> spectators;
+    for (int i = 0; i < config.spectators; i++) {
+        spectators.emplace_back(new CyborNetworkManager());
+        CyborNetworkManager& spectator = *spectators.back();
+        spectator.Initialize();
+        spectator.SetPlayerName("Spectator" + std::to_string(i));
+        if (!config.key.empty()) {
+            spectator.SetCyborKey(config.key);
+            spectator.SetCyborEncryption(true);
+        }
+        if (!spectator.ConnectToServer("127.0.0.1", settings.port)) {
+            std::cerr << "Spectator " << i << " failed to start" << std::endl;
+        }
+    }
+
+    const float deltaTime = 1.0f / config.tickRate;
+    const Clock::duration tickInterval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(deltaTime));
+    Clock::time_point nextTick = Clock::now();
+    while (running) {
+        relay.Update(deltaTime);
+        for (auto& spectator : spectators) spectator->Update(deltaTime);
+
+        nextTick += tickInterval;
+        const Clock::time_point now = Clock::now();
+        if (nextTick < now) nextTick = now;
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    const CyborBroadcastRelay::Stats stats = relay.GetStats();
+    outSummary.spectators = stats.spectators;
+    outSummary.serverBandwidth = stats.serverBandwidth;
+    outSummary.spectatorBandwidth = stats.spectators > 0 ? stats.spectatorBandwidth / stats.spectators : 0.0;
+    outSummary.received = stats.received;
+    outSummary.relayed = stats.relayed;
+    std::vector<CyborSnapshotCodec::EntityState> entities;
+    float serverTime;
+    int watching = 0;
+    for (auto& spectator : spectators) {
+        if (!spectator->GetLatestWorldState(entities, serverTime)) continue;
+        outSummary.entities += entities.size();
+        watching++;
+    }
+    if (watching > 0) outSummary.entities /= watching;
+
+    for (auto& spectator : spectators) spectator->Shutdown();
+    relay.Stop();
+}
+
+bool ParseArguments(int argc, char* argv[], LoadTestConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return false;
+        }
+        const std::string value = argv[++i];
+
+        if (option == "--clients") config.clients = std::atoi(value.c_str());
+        else if (option == "--seconds") config.seconds = std::atof(value.c_str());
+        else if (option == "--tickrate") config.tickRate = std::atoi(value.c_str());
+        else if (option == "--snapshot-rate") config.snapshotRate = std::atoi(value.c_str());
+        else if (option == "--client-bandwidth") config.clientBandwidth = std::atoi(value.c_str());
+        else if (option == "--port") config.port = std::atoi(value.c_str());
+        else if (option == "--client-threads") config.clientThreads = std::atoi(value.c_str());
+        else if (option == "--key") config.key = value;
+        else if (option == "--seed") config.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option == "--spectators") config.spectators = std::atoi(value.c_str());
+        else if (option == "--broadcast-delay") config.broadcastDelay = std::atof(value.c_str());
+        else if (option == "--record") config.demoPath = value;
+        else if (option == "--mode") {
+            if (value != "script" && value != "wander") {
+                std::cerr << "Unknown mode " << value << " (script or wander)" << std::endl;
+                return false;
+            }
+            config.wander = value == "wander";
+        } else if (option == "--latency") {
+            config.link.latency = std::atof(value.c_str()) / 1000.0;
+            config.emulateLink = true;
+        } else if (option == "--jitter") {
+            config.link.jitter = std::atof(value.c_str()) / 1000.0;
+            config.emulateLink = true;
+        } else if (option == "--loss") {
+            config.link.lossRate = std::atof(value.c_str()) / 100.0;
+            config.emulateLink = true;
+        } else if (option == "--degrade") {
+            if (value != "on" && value != "off") {
+                std::cerr << "Unknown degrade setting " << value << " (on or off)" << std::endl;
+                return false;
+            }
+            config.degrade = value == "on";
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return false;
+        }
+    }
+
+    if (config.clients < 1 || config.seconds <= 0.0 || config.tickRate < 1 || config.snapshotRate < 1 ||
+        config.clientBandwidth < 0 || config.clientThreads < 1 || config.port < 1 || config.port > 65534 ||
+        config.spectators < 0 || config.broadcastDelay < 0.0 ||
+        (config.spectators > 0 && config.broadcastDelay == 0.0)) {
+        std::cerr << "Invalid load test settings" << std::endl;
+        return false;
+    }
+    config.clientThreads = std::min(config.clientThreads, config.clients);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    LoadTestConfig config;
+    if (!ParseArguments(argc, argv, config)) return -1;
+
+    std::cout << "=================================================" << std::endl;
+    std::cout << "  CYBOR'S COUNTER STRIKE v2.5 - SERVER LOAD TEST" << std::endl;
+    std::cout << "=================================================" << std::endl;
+    std::cout << config.clients << " synthetic clients (" << (config.wander ? "wander" : "script") << "), "
+              << config.tickRate << " Hz tick, " << config.snapshotRate << " Hz snapshots"
+              << (config.key.empty() ? "" : ", encrypted")
+              << (config.emulateLink ? ", emulated link" : "") << std::endl;
+    if (config.spectators > 0) {
+        std::cout << config.spectators << " spectators through a broadcast relay, " << config.broadcastDelay
+                  << " s behind" << std::endl;
+    }
+
+    LoadTestServer server(config);
+    if (!server.Start()) {
+        std::cerr << "Failed to start the load test server on port " << config.port << std::endl;
+        return -1;
+    }
+
+    // Clients are spread over a few threads; each thread owns its clients outright
+    std::atomic<bool> clientsRunning(true);
+    std::vector<std::thread> clientThreads;
+    for (int t = 0; t < config.clientThreads; t++) {
+        const int first = config.clients * t / config.clientThreads;
+        const int count = config.clients * (t + 1) / config.clientThreads - first;
+        clientThreads.emplace_back(RunClients, std::cref(config), first, count, std::ref(clientsRunning));
+    }
+    BroadcastSummary broadcast;
+    std::thread broadcastThread;
+    if (config.spectators > 0) {
+        broadcastThread = std::thread(RunBroadcast, std::cref(config), std::ref(clientsRunning), std::ref(broadcast));
+    }
+
+    // Measure only once everyone is in, so the connect storm doesn't skew the numbers
+    const Clock::time_point connectStart = Clock::now();
+    while (server.GetPlayerCount() < config.clients && Seconds(Clock::now() - connectStart) < CONNECT_TIMEOUT) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    const int players = server.GetPlayerCount();
+    std::cout << players << "/" << config.clients << " clients connected in " << std::fixed << std::setprecision(2)
+              << Seconds(Clock::now() - connectStart) << " s" << std::endl;
+    if (players == 0) {
+        clientsRunning = false;
+        for (auto& thread : clientThreads) thread.join();
+        if (broadcastThread.joinable()) broadcastThread.join();
+        server.Stop();
+        std::cerr << "No clients connected" << std::endl;
+        return -1;
+    }
+
+    const CyborUdpTransport& transport = server.GetTransport();
+    const uint64_t bytesSent = transport.GetBytesSent();
+    const uint64_t bytesReceived = transport.GetBytesReceived();
+    const uint64_t packetsSent = transport.GetPacketsSent();
+    const uint64_t packetsReceived = transport.GetPacketsReceived();
+    const Clock::time_point measureStart = Clock::now();
+    server.SetMeasuring(true);
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+
+    server.SetMeasuring(false);
+    const double elapsed = Seconds(Clock::now() - measureStart);
+    const double sentRate = (transport.GetBytesSent() - bytesSent) / elapsed;
+    const double receivedRate = (transport.GetBytesReceived() - bytesReceived) / elapsed;
+    const double packetsSentRate = (transport.GetPacketsSent() - packetsSent) / elapsed;
+    const double packetsReceivedRate = (transport.GetPacketsReceived() - packetsReceived) / elapsed;
+    const int playersAtEnd = server.GetPlayerCount();
+
+    clientsRunning = false;
+    for (auto& thread : clientThreads) thread.join();
+    if (broadcastThread.joinable()) broadcastThread.join();
+    server.Stop();
+
+    const std::vector<double>& tickTimes = server.GetTickTimes();
+    double total = 0.0;
+    for (double tickTime : tickTimes) total += tickTime;
+    const double mean = tickTimes.empty() ? 0.0 : total / tickTimes.size();
+    const double interval = 1.0 / config.tickRate;
+    const double budget = server.GetBudget();
+    const double peak = tickTimes.empty() ? 0.0 : *std::max_element(tickTimes.begin(), tickTimes.end());
+    const CyborTickScheduler::Stats& stats = server.GetStats();
+    const double statTicks = static_cast<double>(std::max<uint64_t>(stats.ticks, 1));
+    const LinkSummary& links = server.GetLinkSummary();
+
+    std::cout << std::endl << "Results over " << std::setprecision(1) << elapsed << " s, "
+              << playersAtEnd << " players at the end" << std::endl;
+    std::cout << std::setprecision(3);
+    std::cout << "  Server tick:  mean " << mean * 1000.0 << " ms, p50 " << Percentile(tickTimes, 0.5) * 1000.0
+              << " ms, p99 " << Percentile(tickTimes, 0.99) * 1000.0 << " ms, max " << peak * 1000.0
+              << " ms (budget " << budget * 1000.0 << " ms)" << std::endl;
+    std::cout << "  Tick phases:  receive " << stats.phaseTime[0] / statTicks * 1000.0 << " ms, simulate "
+              << stats.phaseTime[1] / statTicks * 1000.0 << " ms, send " << stats.phaseTime[2] / statTicks * 1000.0
+              << " ms (mean)" << std::endl;
+    std::cout << "  Tick load:    " << std::setprecision(1) << mean / interval * 100.0 << "% of the interval, "
+              << stats.overruns << "/" << stats.ticks << " ticks over budget, " << stats.droppedTicks
+              << " dropped" << std::endl;
+    std::cout << "  Degradation:  ";
+    for (int level = 0; level <= CyborTickScheduler::MAX_DEGRADATION; level++) {
+        std::cout << (level ? ", " : "") << "level " << level << " "
+                  << stats.ticksAtLevel[level] / statTicks * 100.0 << "%";
+    }
+    std::cout << (config.degrade ? "" : " (disabled)") << std::endl;
+    std::cout << "  Per client:   " << std::setprecision(2) << sentRate / players * 8.0 / 1000.0 << " kbit/s down, "
+              << receivedRate / players * 8.0 / 1000.0 << " kbit/s up, "
+              << std::setprecision(1) << packetsSentRate / players << " pkt/s down, "
+              << packetsReceivedRate / players << " pkt/s up" << std::endl;
+    std::cout << "  Links:        rtt " << std::setprecision(1) << links.rtt * 1000.0 << " ms, jitter "
+              << links.jitter * 1000.0 << " ms, loss " << links.upLoss * 100.0 << "% up, "
+              << links.downLoss * 100.0 << "% down (mean over " << links.connections << " clients)" << std::endl;
+    std::cout << "  Server total: " << std::setprecision(2) << sentRate * 8.0 / 1e6 << " Mbit/s out, "
+              << receivedRate * 8.0 / 1e6 << " Mbit/s in, " << std::setprecision(0) << packetsSentRate
+              << " pkt/s out, " << packetsReceivedRate << " pkt/s in" << std::endl;
+    if (config.spectators > 0) {
+        std::cout << "  Broadcast:    " << broadcast.spectators << " spectators, relay link "
+                  << std::setprecision(2) << broadcast.serverBandwidth * 8.0 / 1000.0 << " kbit/s, "
+                  << broadcast.spectatorBandwidth * 8.0 / 1000.0 << " kbit/s per spectator, "
+                  << std::setprecision(1) << broadcast.entities << " entities seen, "
+                  << broadcast.relayed << "/" << broadcast.received << " snapshots relayed" << std::endl;
+    }
+    if (mean > 0.0) {
+        std::cout << "  Estimate:     ~" << static_cast<int>(players * budget / mean)
+                  << " players before the mean tick fills its budget (assuming linear cost)" << std::endl;
+    }
+
+    return 0;
+}
@@ -7,6 +7,7 @@
  */
 
 #include "src/Engine/CyborEngine.h"
+#include "src/Engine/CyborTickScheduler.h"
 #include "src/Game/CyborGameManager.h"
 #include "src/Audio/CyborAudioSystem.h"
 #include "src/Network/CyborNetworkManager.h"
@@ -38,23 +39,61 @@ int main() {
         // Initialize Audio System
         auto audioSystem = std::make_unique<CyborAudioSystem>();
         audioSystem->Initialize();
+        gameManager->SetAudioSystem(audioSystem.get());
         audioSystem->PlayBackgroundMusic("assets/audio/cybor_theme.wav");
 
         // Initialize Network Manager for multiplayer
         auto networkManager = std::make_unique<CyborNetworkManager>();
         networkManager->Initialize();
+        gameManager->SetNetworkManager(networkManager.get());
 
         std::cout << "Cybor's Counter Strike initialized successfully!" << std::endl;
         std::cout << "Loading Cybor tactical systems..." << std::endl;
 
+        std::vector<CyborSnapshotCodec::EntityState> networkStates;
+
+        // A listen server's share of the frame is held to a 64 Hz tick budget
+        CyborTickScheduler serverTicks(64);
+        serverTicks.EnableReporting(true);
+
         // Main game loop
         while (cyborEngine->IsRunning()) {
             float deltaTime = cyborEngine->GetDeltaTime();
+            const bool hosting = networkManager->IsServerRunning();
 
             // Update systems
             cyborEngine->Update(deltaTime);
+            serverTicks.BeginTick();
+            serverTicks.BeginPhase(CyborTickScheduler::Phase::SIMULATE);
             gameManager->Update(deltaTime);
+            serverTicks.BeginPhase(CyborTickScheduler::Phase::RECEIVE);
             networkManager->Update(deltaTime);
+            if (CyborPlayer* player = gameManager->GetPlayer()) {
+                // Predict locally while connected, reconcile when the server answers
+                player->EnablePrediction(networkManager->IsConnected());
+                networkManager->SendInputCommands(player->GetPendingCommands());
+
+                uint32_t lastProcessedSequence;
+                CyborMoveState serverState;
+                if (networkManager->PollAuthoritativeState(lastProcessedSequence, serverState)) {
+                    player->ReconcileWithServer(lastProcessedSequence, serverState);
+                }
+            }
+            if (hosting) {
+                serverTicks.BeginPhase(CyborTickScheduler::Phase::SEND);
+                // The level changes with the map, so relevancy is told which one is current
+                networkManager->GetInterestManager().SetCollisionWorld(gameManager->GetCollisionWorld());
+                gameManager->GetNetworkEntityStates(networkStates);
+                networkManager->SendWorldSnapshot(networkStates);
+                serverTicks.EndTick();
+
+                // Shed work before the tick overruns, take it back once there is headroom
+                gameManager->SetAILevelOfDetail(serverTicks.GetDegradationLevel());
+                networkManager->SetSnapshotLevelOfDetail(serverTicks.GetDegradationLevel());
+            }
+            if (CyborPlayer* player = gameManager->GetPlayer()) {
+                audioSystem->SetListenerPosition(player->GetPosition(), player->GetForward(), glm::vec3(0.0f, 1.0f, 0.0f));
+            }
             audioSystem->Update(deltaTime);
 
             // Render frame
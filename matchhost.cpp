@@ -0,0 +1,125 @@
+/*
+ * Cybor's Counter Strike v2.5 - Multi-Match Server Host
+ * Runs many independent headless matches in one process, each on its own
+ * core (or NUMA node) and port, and prints a status line per match now and then.
+ *
+ * Usage: CyborCounterStrike_MatchHost [--matches N] [--tickrate HZ] [--port FIRST]
+ *            [--players N] [--affinity core|node|none] [--seconds S] [--seed S]
+ *            [--broadcast-delay S] [--relay ADDRESS]...
+ */
+
+#include "src/Game/CyborMatchHost.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const double STATUS_INTERVAL = 10.0;
+
+std::atomic<bool> g_stopRequested(false);
+
+void RequestStop(int) {
+    g_stopRequested = true;
+}
+
+bool ParseArguments(int argc, char* argv[], CyborMatchHost::Settings& settings, double& seconds) {
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return false;
+        }
+        const std::string value = argv[++i];
+
+        if (option == "--matches") settings.matches = std::atoi(value.c_str());
+        else if (option == "--tickrate") settings.tickRate = std::atoi(value.c_str());
+        else if (option == "--port") settings.basePort = std::atoi(value.c_str());
+        else if (option == "--players") settings.playersPerMatch = std::atoi(value.c_str());
+        else if (option == "--seconds") seconds = std::atof(value.c_str());
+        else if (option == "--broadcast-delay") settings.broadcastDelay = static_cast<float>(std::atof(value.c_str()));
+        else if (option == "--relay") settings.relayAddresses.push_back(value);
+        else if (option == "--seed") settings.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (option == "--affinity") {
+            if (value == "core") settings.affinity = CyborMatchHost::Affinity::CORE;
+            else if (value == "node") settings.affinity = CyborMatchHost::Affinity::NUMA_NODE;
+            else if (value == "none") settings.affinity = CyborMatchHost::Affinity::NONE;
+            else {
+                std::cerr << "Unknown affinity " << value << " (core, node or none)" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return false;
+        }
+    }
+
+    if (settings.matches < 1 || settings.tickRate < 1 || settings.playersPerMatch < 1 || seconds < 0.0 ||
+        settings.broadcastDelay < 0.0f ||
+        settings.basePort < 1 || settings.basePort + settings.matches - 1 > 65535) {
+        std::cerr << "Invalid match host settings" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PrintStatus(const CyborMatchHost& host) {
+    std::vector<CyborMatchHost::MatchStatus> status;
+    host.GetStatus(status);
+    for (const auto& match : status) {
+        std::cout << "  Match " << match.index << " :" << match.port;
+        if (!match.running) {
+            std::cout << "  not running" << std::endl;
+            continue;
+        }
+        std::cout << "  cpu " << match.cpu << " node " << match.node << "  " << match.players << " players, "
+                  << match.bots << " bots, " << match.overruns << "/" << match.ticks << " ticks over budget, "
+                  << "degradation " << match.degradation << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CyborMatchHost::Settings settings;
+    double seconds = 0.0; // Until interrupted
+    if (!ParseArguments(argc, argv, settings, seconds)) return -1;
+
+    std::cout << "=================================================" << std::endl;
+    std::cout << "  CYBOR'S COUNTER STRIKE v2.5 - MATCH HOST" << std::endl;
+    std::cout << "=================================================" << std::endl;
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+
+    CyborMatchHost host;
+    if (!host.Start(settings)) {
+        std::cerr << "Failed to start any match" << std::endl;
+        return -1;
+    }
+
+    const Clock::time_point start = Clock::now();
+    Clock::time_point nextStatus = start;
+    while (!g_stopRequested) {
+        const Clock::time_point now = Clock::now();
+        if (seconds > 0.0 && std::chrono::duration<double>(now - start).count() >= seconds) break;
+        if (now >= nextStatus) {
+            std::cout << "Match host status:" << std::endl;
+            PrintStatus(host);
+            nextStatus = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(STATUS_INTERVAL));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    std::cout << "Final status:" << std::endl;
+    PrintStatus(host);
+    host.Stop();
+    return 0;
+}
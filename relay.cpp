@@ -0,0 +1,119 @@
+/*
+ * Cybor's Counter Strike v2.5 - Broadcast Relay
+ * Takes one match's delayed broadcast stream from the game server and serves
+ * it to spectators, so the game server's cost doesn't grow with the audience.
+ * Spectators connect to the relay's port with an ordinary client.
+ *
+ * Usage: CyborCounterStrike_Relay [--server ADDRESS] [--server-port P] [--port P]
+ *            [--spectators N] [--tickrate HZ] [--buffer MS] [--key HEX] [--seconds S]
+ */
+
+#include "src/Network/CyborBroadcastRelay.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const double STATUS_INTERVAL = 10.0;
+
+std::atomic<bool> g_stopRequested(false);
+
+void RequestStop(int) {
+    g_stopRequested = true;
+}
+
+bool ParseArguments(int argc, char* argv[], CyborBroadcastRelay::Settings& settings, double& seconds) {
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return false;
+        }
+        const std::string value = argv[++i];
+
+        if (option == "--server") settings.serverAddress = value;
+        else if (option == "--server-port") settings.serverPort = std::atoi(value.c_str());
+        else if (option == "--port") settings.port = std::atoi(value.c_str());
+        else if (option == "--spectators") settings.maxSpectators = std::atoi(value.c_str());
+        else if (option == "--tickrate") settings.tickRate = std::atoi(value.c_str());
+        else if (option == "--buffer") settings.bufferTime = static_cast<float>(std::atof(value.c_str()) / 1000.0);
+        else if (option == "--key") settings.key = value;
+        else if (option == "--seconds") seconds = std::atof(value.c_str());
+        else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return false;
+        }
+    }
+
+    if (settings.serverPort < 1 || settings.serverPort > 65535 || settings.port < 1 || settings.port > 65535 ||
+        settings.maxSpectators < 1 || settings.tickRate < 1 || settings.bufferTime < 0.0f || seconds < 0.0) {
+        std::cerr << "Invalid relay settings" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PrintStatus(const CyborBroadcastRelay& relay) {
+    const CyborBroadcastRelay::Stats stats = relay.GetStats();
+    std::cout << "  " << (stats.connected ? "connected" : "not connected") << ", " << stats.spectators
+              << " spectators, " << stats.received << " snapshots in, " << stats.relayed << " out, "
+              << static_cast<int>(stats.buffered * 1000.0f) << " ms buffered, server link "
+              << static_cast<int>(stats.serverBandwidth * 8.0f / 1000.0f) << " kbit/s, spectators "
+              << static_cast<int>(stats.spectatorBandwidth * 8.0f / 1000.0f) << " kbit/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CyborBroadcastRelay::Settings settings;
+    double seconds = 0.0; // Until interrupted
+    if (!ParseArguments(argc, argv, settings, seconds)) return -1;
+
+    std::cout << "=================================================" << std::endl;
+    std::cout << "  CYBOR'S COUNTER STRIKE v2.5 - BROADCAST RELAY" << std::endl;
+    std::cout << "=================================================" << std::endl;
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+
+    CyborBroadcastRelay relay;
+    if (!relay.Start(settings)) {
+        std::cerr << "Failed to start the relay" << std::endl;
+        return -1;
+    }
+
+    const float deltaTime = 1.0f / settings.tickRate;
+    const Clock::duration tickInterval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(deltaTime));
+    const Clock::time_point start = Clock::now();
+    Clock::time_point nextTick = start;
+    Clock::time_point nextStatus = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(STATUS_INTERVAL));
+    while (!g_stopRequested) {
+        relay.Update(deltaTime);
+
+        const Clock::time_point now = Clock::now();
+        if (seconds > 0.0 && std::chrono::duration<double>(now - start).count() >= seconds) break;
+        if (now >= nextStatus) {
+            std::cout << "Relay status:" << std::endl;
+            PrintStatus(relay);
+            nextStatus = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(STATUS_INTERVAL));
+        }
+
+        nextTick += tickInterval;
+        if (nextTick < now) nextTick = now;
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    std::cout << "Final status:" << std::endl;
+    PrintStatus(relay);
+    relay.Stop();
+    return 0;
+}
@@ -0,0 +1,501 @@
+#include "CyborAudioMixer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const uint64_t FIXED_ONE = 1ull << 32;
+static const float FRACTION_SCALE = 1.0f / 16777216.0f; // 24 fraction bits convert to float exactly
+static const float MAX_PITCH = 8.0f;
+static const float MIN_PITCH = 1.0f / 64.0f;
+static const float AUDIBILITY_THRESHOLD = 1e-3f; // -60 dB; quieter voices are never mixed
+static const float REAL_VOICE_BIAS = 1.25f;      // Real voices keep their place against near ties, so they do not swap every block
+
+static inline float Fraction(uint64_t position) {
+    return static_cast<float>((position & 0xFFFFFFFFu) >> 8) * FRACTION_SCALE;
+}
+
+// Output frames, up to wanted, whose source frame and the one after it both lie inside the sound
+static size_t GetInteriorFrames(uint64_t position, uint64_t step, size_t soundFrames, size_t wanted) {
+    const uint64_t last = static_cast<uint64_t>(soundFrames - 1) << 32;
+    if (position >= last) return 0;
+    return static_cast<size_t>(std::min<uint64_t>(wanted, (last - position - 1) / step + 1));
+}
+
+// Linear interpolation of a mono source into stereo frames; every source pair must be in range
+static void ResampleMono(const float* source, uint64_t& position, uint64_t step, size_t count, float* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (step == FIXED_ONE && (position & 0xFFFFFFFFu) == 0) {
+        // Same rate, whole frames: a straight copy, each sample duplicated into both channels
+        const float* in = source + (position >> 32);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 samples = _mm_loadu_ps(in + i);
+            _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(samples, samples));
+            _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(samples, samples));
+        }
+        position += i * step;
+    }
+    for (; i + 4 <= count; i += 4) {
+        const uint64_t p0 = position, p1 = p0 + step, p2 = p1 + step, p3 = p2 + step;
+        const float* s0 = source + (p0 >> 32);
+        const float* s1 = source + (p1 >> 32);
+        const float* s2 = source + (p2 >> 32);
+        const float* s3 = source + (p3 >> 32);
+        const __m128 a = _mm_setr_ps(s0[0], s1[0], s2[0], s3[0]);
+        const __m128 b = _mm_setr_ps(s0[1], s1[1], s2[1], s3[1]);
+        const __m128 t = _mm_setr_ps(Fraction(p0), Fraction(p1), Fraction(p2), Fraction(p3));
+        const __m128 samples = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+        _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(samples, samples));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(samples, samples));
+        position = p3 + step;
+    }
+#endif
+    for (; i < count; i++) {
+        const float* s = source + (position >> 32);
+        const float sample = s[0] + (s[1] - s[0]) * Fraction(position);
+        out[2 * i] = sample;
+        out[2 * i + 1] = sample;
+        position += step;
+    }
+}
+
+// The same for an interleaved stereo source, two frames at a time
+static void ResampleStereo(const float* source, uint64_t& position, uint64_t step, size_t count, float* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 2 <= count; i += 2) {
+        const uint64_t p0 = position, p1 = p0 + step;
+        const float* s0 = source + 2 * (p0 >> 32);
+        const float* s1 = source + 2 * (p1 >> 32);
+        const __m128 a = _mm_setr_ps(s0[0], s0[1], s1[0], s1[1]);
+        const __m128 b = _mm_setr_ps(s0[2], s0[3], s1[2], s1[3]);
+        const float t0 = Fraction(p0), t1 = Fraction(p1);
+        const __m128 t = _mm_setr_ps(t0, t0, t1, t1);
+        _mm_storeu_ps(out + 2 * i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+        position = p1 + step;
+    }
+#endif
+    for (; i < count; i++) {
+        const float* s = source + 2 * (position >> 32);
+        const float t = Fraction(position);
+        out[2 * i] = s[0] + (s[2] - s[0]) * t;
+        out[2 * i + 1] = s[1] + (s[3] - s[1]) * t;
+        position += step;
+    }
+}
+
+// out += in * gain, each channel's gain ramping linearly from start to end over the frames
+static void MixRamped(const float* in, size_t frames, const float start[2], const float end[2], float* out) {
+    if (frames == 0) return;
+    const float deltaLeft = (end[0] - start[0]) / frames;
+    const float deltaRight = (end[1] - start[1]) / frames;
+    size_t i = 0;
+#if defined(__AVX__)
+    __m256 gain = _mm256_setr_ps(start[0] + deltaLeft, start[1] + deltaRight,
+                                 start[0] + 2 * deltaLeft, start[1] + 2 * deltaRight,
+                                 start[0] + 3 * deltaLeft, start[1] + 3 * deltaRight,
+                                 start[0] + 4 * deltaLeft, start[1] + 4 * deltaRight);
+    const __m256 gainStep = _mm256_setr_ps(4 * deltaLeft, 4 * deltaRight, 4 * deltaLeft, 4 * deltaRight,
+                                           4 * deltaLeft, 4 * deltaRight, 4 * deltaLeft, 4 * deltaRight);
+    for (; i + 4 <= frames; i += 4) {
+        const __m256 mixed = _mm256_add_ps(_mm256_loadu_ps(out + 2 * i), _mm256_mul_ps(_mm256_loadu_ps(in + 2 * i), gain));
+        _mm256_storeu_ps(out + 2 * i, mixed);
+        gain = _mm256_add_ps(gain, gainStep);
+    }
+#elif defined(__SSE2__)
+    __m128 gain = _mm_setr_ps(start[0] + deltaLeft, start[1] + deltaRight,
+                              start[0] + 2 * deltaLeft, start[1] + 2 * deltaRight);
+    const __m128 gainStep = _mm_setr_ps(2 * deltaLeft, 2 * deltaRight, 2 * deltaLeft, 2 * deltaRight);
+    for (; i + 2 <= frames; i += 2) {
+        const __m128 mixed = _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(_mm_loadu_ps(in + 2 * i), gain));
+        _mm_storeu_ps(out + 2 * i, mixed);
+        gain = _mm_add_ps(gain, gainStep);
+    }
+#endif
+    for (; i < frames; i++) {
+        out[2 * i] += in[2 * i] * (start[0] + deltaLeft * (i + 1));
+        out[2 * i + 1] += in[2 * i + 1] * (start[1] + deltaRight * (i + 1));
+    }
+}
+
+// Whole blocks only, so the vector loops need no tail
+static_assert(CyborAudioMixer::BLOCK_FRAMES * CyborAudioMixer::CHANNELS % 8 == 0, "Blocks must fill whole vectors");
+
+static void Clamp(float* samples, size_t count) {
+#if defined(__AVX__)
+    const __m256 low = _mm256_set1_ps(-1.0f);
+    const __m256 high = _mm256_set1_ps(1.0f);
+    for (size_t i = 0; i < count; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(samples + i), low), high));
+    }
+#elif defined(__SSE2__)
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    for (size_t i = 0; i < count; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), low), high));
+    }
+#else
+    for (size_t i = 0; i < count; i++) samples[i] = std::min(std::max(samples[i], -1.0f), 1.0f);
+#endif
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+CyborAudioMixer::CyborAudioMixer()
+    : m_nextVoiceId(INVALID_VOICE + 1), m_commands(COMMAND_CAPACITY), m_released(COMMAND_CAPACITY),
+      m_masterGain(1.0f), m_resampled(BLOCK_FRAMES * CHANNELS), m_block(BLOCK_FRAMES * CHANNELS),
+      m_running(false), m_blocks(0), m_voiceCounts(0), m_mixNanoseconds(0), m_mixedSinceStats(0),
+      m_maxMixNanoseconds(0), m_droppedCommands(0), m_stolenVoices(0) {
+    for (float& gain : m_busGains) gain = 1.0f;
+    m_voices.reserve(MAX_VOICES);
+    m_scores.reserve(MAX_VOICES);
+}
+
+CyborAudioMixer::~CyborAudioMixer() {
+    Stop();
+}
+
+bool CyborAudioMixer::Start(std::unique_ptr<CyborAudioSink> sink) {
+    if (IsRunning() || !sink || !sink->Open(SAMPLE_RATE, CHANNELS)) return false;
+
+    m_sink = std::move(sink);
+    m_running = true;
+    m_thread = std::thread(&CyborAudioMixer::Run, this);
+    return true;
+}
+
+void CyborAudioMixer::Stop() {
+    if (!IsRunning()) return;
+
+    m_running = false;
+    m_thread.join();
+    m_sink->Close();
+    m_sink.reset();
+
+    // Nothing refers to any sound any more; the owner may free them all
+    m_voices.clear();
+    m_releasing.clear();
+    Command command;
+    while (m_commands.TryPop(command)) {}
+    const Sound* sound;
+    while (m_released.TryPop(sound)) {}
+}
+
+CyborAudioMixer::VoiceId CyborAudioMixer::Play(const Sound* sound, Bus bus, float gain, float pan, float pitch,
+                                               bool loop, float priority) {
+    if (!sound || sound->GetFrameCount() == 0) return INVALID_VOICE;
+
+    const VoiceId voice = m_nextVoiceId++;
+    if (m_nextVoiceId == INVALID_VOICE) m_nextVoiceId++;
+    Send({ Command::Type::PLAY, bus, loop, voice, sound, gain, pan, pitch, priority });
+    return voice;
+}
+
+void CyborAudioMixer::SetVoice(VoiceId voice, float gain, float pan, float pitch) {
+    if (voice == INVALID_VOICE) return;
+    Send({ Command::Type::SET_VOICE, Bus::SFX, false, voice, nullptr, gain, pan, pitch, 0.0f });
+}
+
+void CyborAudioMixer::StopVoice(VoiceId voice) {
+    if (voice == INVALID_VOICE) return;
+    Send({ Command::Type::STOP_VOICE, Bus::SFX, false, voice, nullptr, 0.0f, 0.0f, 0.0f, 0.0f });
+}
+
+void CyborAudioMixer::StopSound(const Sound* sound) {
+    Send({ Command::Type::STOP_SOUND, Bus::SFX, false, INVALID_VOICE, sound, 0.0f, 0.0f, 0.0f, 0.0f });
+}
+
+void CyborAudioMixer::StopAll() {
+    Send({ Command::Type::STOP_ALL, Bus::SFX, false, INVALID_VOICE, nullptr, 0.0f, 0.0f, 0.0f, 0.0f });
+}
+
+void CyborAudioMixer::SetBusGain(Bus bus, float gain) {
+    Send({ Command::Type::SET_BUS_GAIN, bus, false, INVALID_VOICE, nullptr, gain, 0.0f, 0.0f, 0.0f });
+}
+
+void CyborAudioMixer::SetMasterGain(float gain) {
+    Send({ Command::Type::SET_MASTER_GAIN, Bus::SFX, false, INVALID_VOICE, nullptr, gain, 0.0f, 0.0f, 0.0f });
+}
+
+void CyborAudioMixer::ReleaseSound(const Sound* sound) {
+    Send({ Command::Type::RELEASE_SOUND, Bus::SFX, false, INVALID_VOICE, sound, 0.0f, 0.0f, 0.0f, 0.0f });
+}
+
+bool CyborAudioMixer::PollReleasedSound(const Sound*& outSound) {
+    return m_released.TryPop(outSound);
+}
+
+CyborAudioMixer::Stats CyborAudioMixer::GetStats() {
+    Stats stats;
+    stats.blocks = m_blocks.load(std::memory_order_relaxed);
+    const uint64_t voiceCounts = m_voiceCounts.load(std::memory_order_relaxed);
+    stats.voices = static_cast<int>(voiceCounts >> 32);
+    stats.realVoices = static_cast<int>(voiceCounts & 0xFFFFFFFFu);
+    const uint64_t mixed = m_mixedSinceStats.exchange(0, std::memory_order_relaxed);
+    const uint64_t nanoseconds = m_mixNanoseconds.exchange(0, std::memory_order_relaxed);
+    stats.meanMixTime = mixed > 0 ? nanoseconds * 1e-9 / mixed : 0.0;
+    stats.maxMixTime = m_maxMixNanoseconds.exchange(0, std::memory_order_relaxed) * 1e-9;
+    stats.droppedCommands = m_droppedCommands.load(std::memory_order_relaxed);
+    stats.stolenVoices = m_stolenVoices.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void CyborAudioMixer::MixBlock(float* outFrames) {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Sounds whose voices faded out last block are safe to hand back now
+    while (!m_releasing.empty() && m_released.TryPush(std::move(m_releasing.back()))) m_releasing.pop_back();
+    ApplyCommands();
+    SelectRealVoices();
+
+    std::fill(outFrames, outFrames + BLOCK_FRAMES * CHANNELS, 0.0f);
+    for (size_t i = 0; i < m_voices.size();) {
+        Voice& voice = m_voices[i];
+        float target[CHANNELS] = { 0.0f, 0.0f };
+        if (voice.real) GetTargetGains(voice, target);
+        if (!voice.started) {
+            // Starts at full gain; a ramp up from silence would soften every attack
+            voice.currentGain[0] = target[0];
+            voice.currentGain[1] = target[1];
+            voice.started = true;
+        }
+
+        size_t frames;
+        if (voice.real || voice.currentGain[0] != 0.0f || voice.currentGain[1] != 0.0f) {
+            // Mixed, or fading out over this block after going virtual or being stopped
+            frames = RenderVoice(voice, BLOCK_FRAMES);
+            MixRamped(m_resampled.data(), frames, voice.currentGain, target, outFrames);
+            voice.currentGain[0] = target[0];
+            voice.currentGain[1] = target[1];
+        } else {
+            frames = AdvanceVoice(voice, BLOCK_FRAMES);
+        }
+
+        if (voice.stopping || frames < BLOCK_FRAMES) {
+            voice = m_voices.back();
+            m_voices.pop_back();
+        } else {
+            i++;
+        }
+    }
+    Clamp(outFrames, BLOCK_FRAMES * CHANNELS);
+
+    // Both counts from the voices still playing after the block
+    uint64_t realVoices = 0;
+    for (const Voice& voice : m_voices) realVoices += voice.real;
+
+    const uint64_t nanoseconds = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    m_blocks.fetch_add(1, std::memory_order_relaxed);
+    m_voiceCounts.store(static_cast<uint64_t>(m_voices.size()) << 32 | realVoices, std::memory_order_relaxed);
+    m_mixNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    m_mixedSinceStats.fetch_add(1, std::memory_order_relaxed);
+    if (nanoseconds > m_maxMixNanoseconds.load(std::memory_order_relaxed)) {
+        m_maxMixNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+void CyborAudioMixer::Run() {
+    while (m_running.load(std::memory_order_relaxed)) {
+        MixBlock(m_block.data());
+        m_sink->Write(m_block.data(), BLOCK_FRAMES);
+    }
+}
+
+void CyborAudioMixer::Send(const Command& command) {
+    Command copy = command;
+    if (!m_commands.TryPush(std::move(copy))) {
+        if (m_droppedCommands.fetch_add(1, std::memory_order_relaxed) == 0) {
+            std::cerr << "Audio command queue is full; dropping commands" << std::endl;
+        }
+    }
+}
+
+void CyborAudioMixer::ApplyCommands() {
+    Command command;
+    while (m_commands.TryPop(command)) {
+        switch (command.type) {
+            case Command::Type::PLAY:
+                StartVoice(command);
+                break;
+
+            case Command::Type::SET_VOICE:
+                if (Voice* voice = FindVoice(command.voice)) {
+                    voice->gain = command.gain;
+                    voice->pan = command.pan;
+                    const float pitch = std::min(std::max(command.pitch, MIN_PITCH), MAX_PITCH);
+                    voice->step = static_cast<uint64_t>(
+                        static_cast<double>(pitch) * voice->sound->sampleRate / SAMPLE_RATE * FIXED_ONE);
+                }
+                break;
+
+            case Command::Type::STOP_VOICE:
+                if (Voice* voice = FindVoice(command.voice)) voice->stopping = true;
+                break;
+
+            case Command::Type::STOP_SOUND:
+                for (Voice& voice : m_voices) {
+                    if (voice.sound == command.sound) voice.stopping = true;
+                }
+                break;
+
+            case Command::Type::STOP_ALL:
+                for (Voice& voice : m_voices) voice.stopping = true;
+                break;
+
+            case Command::Type::SET_BUS_GAIN:
+                m_busGains[static_cast<int>(command.bus)] = command.gain;
+                break;
+
+            case Command::Type::SET_MASTER_GAIN:
+                m_masterGain = command.gain;
+                break;
+
+            case Command::Type::RELEASE_SOUND:
+                for (Voice& voice : m_voices) {
+                    if (voice.sound == command.sound) voice.stopping = true;
+                }
+                m_releasing.push_back(command.sound);
+                break;
+        }
+    }
+}
+
+void CyborAudioMixer::StartVoice(const Command& command) {
+    if (m_voices.size() >= static_cast<size_t>(MAX_VOICES)) {
+        // The least audible voice makes room; it would be the least missed
+        auto weakest = std::min_element(m_voices.begin(), m_voices.end(), [this](const Voice& a, const Voice& b) {
+            return GetScore(a) < GetScore(b);
+        });
+        *weakest = m_voices.back();
+        m_voices.pop_back();
+        m_stolenVoices.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Voice voice;
+    voice.id = command.voice;
+    voice.sound = command.sound;
+    voice.bus = command.bus;
+    voice.loop = command.loop;
+    voice.stopping = false;
+    voice.real = false;
+    voice.started = false;
+    voice.position = 0;
+    const float pitch = std::min(std::max(command.pitch, MIN_PITCH), MAX_PITCH);
+    voice.step = static_cast<uint64_t>(static_cast<double>(pitch) * command.sound->sampleRate / SAMPLE_RATE * FIXED_ONE);
+    voice.gain = command.gain;
+    voice.pan = command.pan;
+    voice.priority = command.priority;
+    voice.currentGain[0] = 0.0f;
+    voice.currentGain[1] = 0.0f;
+    m_voices.push_back(voice);
+}
+
+CyborAudioMixer::Voice* CyborAudioMixer::FindVoice(VoiceId id) {
+    for (Voice& voice : m_voices) {
+        if (voice.id == id) return &voice;
+    }
+    return nullptr;
+}
+
+// How much the voice would be missed: its loudness, distance attenuation included, weighed by priority
+float CyborAudioMixer::GetScore(const Voice& voice) const {
+    if (voice.stopping) return -1.0f;
+    return voice.gain * m_busGains[static_cast<int>(voice.bus)] * m_masterGain * voice.priority;
+}
+
+void CyborAudioMixer::SelectRealVoices() {
+    m_scores.clear();
+    for (uint32_t i = 0; i < m_voices.size(); i++) {
+        m_voices[i].real = false;
+        const float score = GetScore(m_voices[i]);
+        if (score < AUDIBILITY_THRESHOLD) continue;
+        const bool wasReal = m_voices[i].currentGain[0] != 0.0f || m_voices[i].currentGain[1] != 0.0f;
+        m_scores.emplace_back(wasReal ? score * REAL_VOICE_BIAS : score, i);
+    }
+
+    if (m_scores.size() > static_cast<size_t>(MAX_REAL_VOICES)) {
+        std::nth_element(m_scores.begin(), m_scores.begin() + MAX_REAL_VOICES, m_scores.end(),
+                         [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+                             return a.first > b.first;
+                         });
+        m_scores.resize(MAX_REAL_VOICES);
+    }
+    for (const auto& score : m_scores) m_voices[score.second].real = true;
+}
+
+void CyborAudioMixer::GetTargetGains(const Voice& voice, float outGains[CHANNELS]) const {
+    const float gain = voice.gain * m_busGains[static_cast<int>(voice.bus)] * m_masterGain;
+    const float pan = std::min(std::max(voice.pan, -1.0f), 1.0f);
+    if (voice.sound->channels == 1) {
+        // Constant power, so a sound keeps its loudness as it moves across
+        const float angle = (pan + 1.0f) * 0.785398163f;
+        outGains[0] = gain * std::cos(angle);
+        outGains[1] = gain * std::sin(angle);
+    } else {
+        // Stereo sources keep their image; pan only turns one side down
+        outGains[0] = gain * std::min(1.0f, 1.0f - pan);
+        outGains[1] = gain * std::min(1.0f, 1.0f + pan);
+    }
+}
+
+size_t CyborAudioMixer::RenderVoice(Voice& voice, size_t frames) {
+    const Sound& sound = *voice.sound;
+    const float* samples = sound.samples.data();
+    const size_t soundFrames = sound.GetFrameCount();
+    const uint64_t end = static_cast<uint64_t>(soundFrames) << 32;
+    float* out = m_resampled.data();
+
+    size_t produced = 0;
+    while (produced < frames) {
+        if (voice.position >= end) {
+            if (!voice.loop) break;
+            voice.position %= end;
+        }
+
+        // The interior of the sound goes through the kernels
+        const size_t run = GetInteriorFrames(voice.position, voice.step, soundFrames, frames - produced);
+        if (run > 0) {
+            if (sound.channels == 1) ResampleMono(samples, voice.position, voice.step, run, out + produced * CHANNELS);
+            else ResampleStereo(samples, voice.position, voice.step, run, out + produced * CHANNELS);
+            produced += run;
+            continue;
+        }
+
+        // The last source frame leads back to the first when looping, into silence otherwise
+        const size_t index = static_cast<size_t>(voice.position >> 32);
+        const bool hasNext = index + 1 < soundFrames || voice.loop;
+        const size_t next = index + 1 < soundFrames ? index + 1 : 0;
+        const float t = Fraction(voice.position);
+        for (int channel = 0; channel < CHANNELS; channel++) {
+            const int sourceChannel = std::min(channel, sound.channels - 1);
+            const float a = samples[index * sound.channels + sourceChannel];
+            const float b = hasNext ? samples[next * sound.channels + sourceChannel] : 0.0f;
+            out[produced * CHANNELS + channel] = a + (b - a) * t;
+        }
+        produced++;
+        voice.position += voice.step;
+    }
+    return produced;
+}
+
+// Moves a virtual voice on as if it had been rendered; fewer frames than asked means it has ended
+size_t CyborAudioMixer::AdvanceVoice(Voice& voice, size_t frames) {
+    const uint64_t end = static_cast<uint64_t>(voice.sound->GetFrameCount()) << 32;
+    if (voice.loop) {
+        voice.position = (voice.position + voice.step * frames) % end;
+        return frames;
+    }
+    if (voice.position >= end) return 0;
+    const size_t remaining = static_cast<size_t>((end - voice.position - 1) / voice.step + 1);
+    const size_t advanced = std::min(frames, remaining);
+    voice.position += voice.step * advanced;
+    return advanced;
+}
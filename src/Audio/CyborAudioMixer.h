@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "CyborAudioSink.h"
+#include "../Engine/CyborSpscQueue.h"
+
+/*
+ * CyborAudioMixer - Software mixer on its own audio thread
+ * The game thread sends commands (play, adjust, stop) through a lock-free
+ * queue and never waits on the audio thread. The audio thread applies them
+ * between blocks, resamples every playing voice to the output rate and
+ * mixes it into a stereo float block with SIMD kernels, then hands the
+ * block to the sink. Gain changes ramp across a block, so nothing clicks.
+ *
+ * Only the most audible voices are mixed. Every block each voice is scored
+ * by its gain (distance attenuation included) times its priority, and the
+ * top MAX_REAL_VOICES are real; the rest are virtual, keeping their place
+ * in the sound without being mixed, and come back if they rise to the top.
+ * Mixing cost is bounded however many sounds the game starts.
+ */
+class CyborAudioMixer {
+public:
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int CHANNELS = 2;
+    static constexpr size_t BLOCK_FRAMES = 256;  // 5.3 ms at 48 kHz
+    static constexpr int MAX_VOICES = 256;       // Real and virtual; past this the lowest scored is stolen
+    static constexpr int MAX_REAL_VOICES = 32;   // Mixed each block
+    static constexpr size_t COMMAND_CAPACITY = 1024;
+
+    enum class Bus : uint8_t {
+        SFX,
+        MUSIC,
+        COUNT
+    };
+
+    // Decoded samples, interleaved when stereo. Immutable once a voice plays it; the owner
+    // may free it only after the mixer hands it back through PollReleasedSound.
+    struct Sound {
+        std::vector<float> samples;
+        int channels = 1;
+        int sampleRate = SAMPLE_RATE;
+        size_t GetFrameCount() const { return samples.size() / channels; }
+    };
+
+    using VoiceId = uint32_t;
+    static constexpr VoiceId INVALID_VOICE = 0;
+
+    struct Stats {
+        uint64_t blocks = 0;
+        int voices = 0;           // Playing at the last block, real and virtual
+        int realVoices = 0;       // Of those, mixed
+        double meanMixTime = 0.0; // Seconds per block, since the last GetStats
+        double maxMixTime = 0.0;
+        uint64_t droppedCommands = 0;
+        uint64_t stolenVoices = 0;
+    };
+
+public:
+    CyborAudioMixer();
+    ~CyborAudioMixer();
+
+    // Opens the sink and starts the audio thread
+    bool Start(std::unique_ptr<CyborAudioSink> sink);
+    void Stop();
+    bool IsRunning() const { return m_thread.joinable(); }
+    const char* GetSinkName() const { return m_sink ? m_sink->GetName() : "none"; }
+
+    // Game thread. Gains are linear; pan runs from -1 (left) to 1 (right); pitch scales the playback rate.
+    // Priority weighs the voice's audibility when choosing which voices to mix.
+    VoiceId Play(const Sound* sound, Bus bus, float gain, float pan = 0.0f, float pitch = 1.0f, bool loop = false,
+                 float priority = 1.0f);
+    void SetVoice(VoiceId voice, float gain, float pan, float pitch = 1.0f);
+    void StopVoice(VoiceId voice);
+    void StopSound(const Sound* sound); // Every voice playing it
+    void StopAll();
+    void SetBusGain(Bus bus, float gain);
+    void SetMasterGain(float gain);
+    // Stops the sound's voices; it comes back through PollReleasedSound once none can touch it
+    void ReleaseSound(const Sound* sound);
+    bool PollReleasedSound(const Sound*& outSound);
+
+    // Any thread; resets the mix time figures
+    Stats GetStats();
+
+    // Audio thread, or any thread while stopped: applies pending commands and mixes one block
+    void MixBlock(float* outFrames);
+
+private:
+    struct Command {
+        enum class Type : uint8_t {
+            PLAY,
+            SET_VOICE,
+            STOP_VOICE,
+            STOP_SOUND,
+            STOP_ALL,
+            SET_BUS_GAIN,
+            SET_MASTER_GAIN,
+            RELEASE_SOUND
+        };
+
+        Type type;
+        Bus bus;
+        bool loop;
+        VoiceId voice;
+        const Sound* sound;
+        float gain;
+        float pan;
+        float pitch;
+        float priority;
+    };
+
+    struct Voice {
+        VoiceId id;
+        const Sound* sound;
+        Bus bus;
+        bool loop;
+        bool stopping;     // Fading out over the next block, then free
+        bool real;         // Mixed this block
+        bool started;      // Has been through a block; a new voice starts at full gain rather than ramping in
+        uint64_t position; // Source frames, 32.32 fixed point
+        uint64_t step;
+        float gain;
+        float pan;
+        float priority;
+        float currentGain[CHANNELS]; // Where the last block's ramp ended; zero once virtual
+    };
+
+    // Game thread
+    VoiceId m_nextVoiceId;
+
+    CyborSpscQueue<Command> m_commands;      // Game thread to audio thread
+    CyborSpscQueue<const Sound*> m_released; // Back again
+
+    // Audio thread
+    std::vector<Voice> m_voices; // Playing, unordered
+    std::vector<const Sound*> m_releasing; // Voices fading out this block, handed back after it
+    float m_busGains[static_cast<int>(Bus::COUNT)];
+    float m_masterGain;
+    std::vector<float> m_resampled; // One voice's block at the output rate, stereo
+    std::vector<float> m_block;
+    std::vector<std::pair<float, uint32_t>> m_scores; // Voice score and index, for choosing the real ones
+    std::unique_ptr<CyborAudioSink> m_sink;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    // Stats, read from any thread
+    std::atomic<uint64_t> m_blocks;
+    std::atomic<uint64_t> m_voiceCounts; // Playing in the high half, mixed in the low; stored together so they agree
+    std::atomic<uint64_t> m_mixNanoseconds;
+    std::atomic<uint64_t> m_mixedSinceStats;
+    std::atomic<uint64_t> m_maxMixNanoseconds;
+    std::atomic<uint64_t> m_droppedCommands;
+    std::atomic<uint64_t> m_stolenVoices;
+
+    // Private methods
+    void Run();
+    void Send(const Command& command);
+    void ApplyCommands();
+    void StartVoice(const Command& command);
+    Voice* FindVoice(VoiceId id);
+    float GetScore(const Voice& voice) const;
+    void SelectRealVoices();
+    void GetTargetGains(const Voice& voice, float outGains[CHANNELS]) const;
+    size_t RenderVoice(Voice& voice, size_t frames);
+    size_t AdvanceVoice(Voice& voice, size_t frames);
+};
@@ -0,0 +1,229 @@
+#include "CyborAudioSink.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+// Mixer output is already clamped to [-1, 1]
+static void ConvertToPcm16(const float* samples, size_t count, int16_t* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(samples + i), scale));
+        const __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(samples + i + 4), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(low, high));
+    }
+#endif
+    for (; i < count; i++) {
+        const float sample = std::min(std::max(samples[i], -1.0f), 1.0f);
+        out[i] = static_cast<int16_t>(sample * 32767.0f + (sample >= 0.0f ? 0.5f : -0.5f));
+    }
+}
+
+static void PutLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static void PutLe32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+CyborNullAudioSink::CyborNullAudioSink(bool realTime)
+    : m_realTime(realTime), m_sampleRate(0), m_framesWritten(0) {
+}
+
+bool CyborNullAudioSink::Open(int sampleRate, int) {
+    m_sampleRate = sampleRate;
+    m_framesWritten = 0;
+    m_start = std::chrono::steady_clock::now();
+    return true;
+}
+
+void CyborNullAudioSink::Write(const float*, size_t frameCount) {
+    m_framesWritten += frameCount;
+    if (!m_realTime) return;
+
+    // Keep pace with the clock the way a device would, a block ahead at most
+    const auto due = m_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(m_framesWritten - frameCount) / m_sampleRate));
+    std::this_thread::sleep_until(due);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static const size_t WAV_HEADER_SIZE = 44;
+
+CyborWavFileSink::CyborWavFileSink(const std::string& path, bool realTime)
+    : m_path(path), m_file(nullptr), m_pacing(realTime), m_channels(0), m_dataBytes(0) {
+}
+
+CyborWavFileSink::~CyborWavFileSink() {
+    Close();
+}
+
+bool CyborWavFileSink::Open(int sampleRate, int channels) {
+    m_file = std::fopen(m_path.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Cannot create audio output file " << m_path << std::endl;
+        return false;
+    }
+
+    uint8_t header[WAV_HEADER_SIZE] = {};
+    std::memcpy(header, "RIFF", 4);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    PutLe32(header + 16, 16);
+    PutLe16(header + 20, 1); // PCM
+    PutLe16(header + 22, static_cast<uint16_t>(channels));
+    PutLe32(header + 24, static_cast<uint32_t>(sampleRate));
+    PutLe32(header + 28, static_cast<uint32_t>(sampleRate * channels * 2));
+    PutLe16(header + 32, static_cast<uint16_t>(channels * 2));
+    PutLe16(header + 34, 16);
+    std::memcpy(header + 36, "data", 4);
+    std::fwrite(header, 1, sizeof(header), m_file);
+
+    m_channels = channels;
+    m_dataBytes = 0;
+    return m_pacing.Open(sampleRate, channels);
+}
+
+void CyborWavFileSink::Write(const float* frames, size_t frameCount) {
+    if (!m_file) return;
+
+    const size_t samples = frameCount * m_channels;
+    m_pcm.resize(samples);
+    ConvertToPcm16(frames, samples, m_pcm.data());
+    m_dataBytes += std::fwrite(m_pcm.data(), sizeof(int16_t), samples, m_file) * sizeof(int16_t);
+    m_pacing.Write(frames, frameCount);
+}
+
+void CyborWavFileSink::Close() {
+    if (!m_file) return;
+
+    // A WAV file can't describe more than 4 GiB of samples
+    const uint32_t dataBytes = static_cast<uint32_t>(std::min<uint64_t>(m_dataBytes, 0xFFFFFFFFu - WAV_HEADER_SIZE));
+    uint8_t size[4];
+    PutLe32(size, dataBytes + WAV_HEADER_SIZE - 8);
+    std::fseek(m_file, 4, SEEK_SET);
+    std::fwrite(size, 1, sizeof(size), m_file);
+    PutLe32(size, dataBytes);
+    std::fseek(m_file, 40, SEEK_SET);
+    std::fwrite(size, 1, sizeof(size), m_file);
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+// A few blocks queued on the device: enough to ride out scheduling hiccups, little enough to stay responsive
+static const int DEVICE_BUFFERS = 4;
+
+struct CyborDeviceAudioSink::Device {
+    HWAVEOUT handle = nullptr;
+    HANDLE done = nullptr; // Signalled by the driver as each buffer finishes
+    WAVEHDR headers[DEVICE_BUFFERS] = {};
+    std::vector<int16_t> buffers[DEVICE_BUFFERS];
+    int next = 0;
+    int channels = 0;
+};
+
+CyborDeviceAudioSink::CyborDeviceAudioSink() {
+}
+
+CyborDeviceAudioSink::~CyborDeviceAudioSink() {
+    Close();
+}
+
+bool CyborDeviceAudioSink::Open(int sampleRate, int channels) {
+    auto device = std::make_unique<Device>();
+    device->channels = channels;
+    device->done = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    WAVEFORMATEX format = {};
+    format.wFormatTag = WAVE_FORMAT_PCM;
+    format.nChannels = static_cast<WORD>(channels);
+    format.nSamplesPerSec = static_cast<DWORD>(sampleRate);
+    format.wBitsPerSample = 16;
+    format.nBlockAlign = static_cast<WORD>(channels * 2);
+    format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+    if (!device->done || waveOutOpen(&device->handle, WAVE_MAPPER, &format, reinterpret_cast<DWORD_PTR>(device->done),
+                                     0, CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+        if (device->done) CloseHandle(device->done);
+        std::cerr << "Cannot open the sound device" << std::endl;
+        return false;
+    }
+    m_device = std::move(device);
+    return true;
+}
+
+void CyborDeviceAudioSink::Write(const float* frames, size_t frameCount) {
+    if (!m_device) return;
+    Device& device = *m_device;
+
+    // Wait for the oldest buffer to come back from the driver
+    WAVEHDR& header = device.headers[device.next];
+    if (header.dwFlags & WHDR_PREPARED) {
+        while (!(header.dwFlags & WHDR_DONE)) WaitForSingleObject(device.done, INFINITE);
+        waveOutUnprepareHeader(device.handle, &header, sizeof(header));
+    }
+
+    std::vector<int16_t>& buffer = device.buffers[device.next];
+    buffer.resize(frameCount * device.channels);
+    ConvertToPcm16(frames, buffer.size(), buffer.data());
+    header = WAVEHDR();
+    header.lpData = reinterpret_cast<LPSTR>(buffer.data());
+    header.dwBufferLength = static_cast<DWORD>(buffer.size() * sizeof(int16_t));
+    waveOutPrepareHeader(device.handle, &header, sizeof(header));
+    waveOutWrite(device.handle, &header, sizeof(header));
+    device.next = (device.next + 1) % DEVICE_BUFFERS;
+}
+
+void CyborDeviceAudioSink::Close() {
+    if (!m_device) return;
+    waveOutReset(m_device->handle);
+    for (WAVEHDR& header : m_device->headers) {
+        if (header.dwFlags & WHDR_PREPARED) waveOutUnprepareHeader(m_device->handle, &header, sizeof(header));
+    }
+    waveOutClose(m_device->handle);
+    CloseHandle(m_device->done);
+    m_device.reset();
+}
+
+#else
+
+struct CyborDeviceAudioSink::Device {
+};
+
+CyborDeviceAudioSink::CyborDeviceAudioSink() {
+}
+
+CyborDeviceAudioSink::~CyborDeviceAudioSink() {
+}
+
+bool CyborDeviceAudioSink::Open(int, int) {
+    std::cerr << "No sound device backend on this platform" << std::endl;
+    return false;
+}
+
+void CyborDeviceAudioSink::Write(const float*, size_t) {
+}
+
+void CyborDeviceAudioSink::Close() {
+}
+
+#endif
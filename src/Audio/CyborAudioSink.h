@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * CyborAudioSink - Where the mixer's output goes
+ * The mixer thread hands over one block of interleaved float frames at a
+ * time. Write may block, and it is how the mixer is paced: a device sink
+ * returns as the hardware drains, the headless sinks sleep to real time
+ * unless told to run as fast as they can.
+ */
+class CyborAudioSink {
+public:
+    virtual ~CyborAudioSink() = default;
+
+    virtual bool Open(int sampleRate, int channels) = 0;
+    virtual void Write(const float* frames, size_t frameCount) = 0;
+    virtual void Close() = 0;
+    virtual const char* GetName() const = 0;
+};
+
+/*
+ * CyborNullAudioSink - Discards the output, for servers and headless runs
+ */
+class CyborNullAudioSink : public CyborAudioSink {
+public:
+    explicit CyborNullAudioSink(bool realTime = true);
+
+    bool Open(int sampleRate, int channels) override;
+    void Write(const float* frames, size_t frameCount) override;
+    void Close() override {}
+    const char* GetName() const override { return "null"; }
+
+private:
+    bool m_realTime;
+    int m_sampleRate;
+    uint64_t m_framesWritten;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/*
+ * CyborWavFileSink - Writes the output to a 16-bit PCM WAV file
+ * The header's sizes are filled in on Close, so a file cut short by a crash
+ * still holds every sample written, just with sizes that need repairing.
+ */
+class CyborWavFileSink : public CyborAudioSink {
+public:
+    explicit CyborWavFileSink(const std::string& path, bool realTime = true);
+    ~CyborWavFileSink() override;
+
+    bool Open(int sampleRate, int channels) override;
+    void Write(const float* frames, size_t frameCount) override;
+    void Close() override;
+    const char* GetName() const override { return "wav"; }
+
+private:
+    std::string m_path;
+    std::FILE* m_file;
+    CyborNullAudioSink m_pacing;
+    int m_channels;
+    uint64_t m_dataBytes;
+    std::vector<int16_t> m_pcm;
+};
+
+/*
+ * CyborDeviceAudioSink - Plays the output on the default sound device
+ * Only the Windows build has a device backend (waveOut); elsewhere Open
+ * fails and the audio system falls back to the null sink.
+ */
+class CyborDeviceAudioSink : public CyborAudioSink {
+public:
+    CyborDeviceAudioSink();
+    ~CyborDeviceAudioSink() override;
+
+    bool Open(int sampleRate, int channels) override;
+    void Write(const float* frames, size_t frameCount) override;
+    void Close() override;
+    const char* GetName() const override { return "device"; }
+
+private:
+    struct Device;
+    std::unique_ptr<Device> m_device;
+};
@@ -1,81 +1,352 @@
 #include "CyborAudioSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
+// Game sounds looked for under here as <name>.wav, with a synthesized stand-in when missing
+static const char* const DEFAULT_SOUND_DIRECTORY = "assets/audio/";
+static const char* const DEFAULT_SOUNDS[] = { "weapon_fire", "bullet_impact", "cybor_elimination" };
+
+// Music, interface sounds and effects are not placed in the world; they keep their voices ahead of any firefight
+static const float NON_POSITIONAL_PRIORITY = 10.0f;
+
+static const uint16_t WAV_FORMAT_PCM = 1;
+static const uint16_t WAV_FORMAT_FLOAT = 3;
+static const uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+static uint16_t GetLe16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static uint32_t GetLe32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+// Decodes a whole WAV file into float samples
+static bool LoadWavFile(const std::string& filename, CyborAudioMixer::Sound& outSound) {
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file) return false;
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + read);
+    std::fclose(file);
+
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    uint16_t format = 0;
+    int channels = 0;
+    int sampleRate = 0;
+    int bits = 0;
+    const uint8_t* samples = nullptr;
+    size_t sampleBytes = 0;
+    for (size_t offset = 12; offset + 8 <= data.size();) {
+        const uint8_t* header = data.data() + offset;
+        const size_t size = std::min<size_t>(GetLe32(header + 4), data.size() - offset - 8);
+        if (std::memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+            format = GetLe16(header + 8);
+            channels = GetLe16(header + 10);
+            sampleRate = static_cast<int>(GetLe32(header + 12));
+            bits = GetLe16(header + 22);
+            if (format == WAV_FORMAT_EXTENSIBLE && size >= 26) format = GetLe16(header + 32);
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            samples = header + 8;
+            sampleBytes = size;
+        }
+        offset += 8 + size + (size & 1); // Chunks are padded to even sizes
+    }
+
+    const bool supported = (format == WAV_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) ||
+                           (format == WAV_FORMAT_FLOAT && bits == 32);
+    if (!samples || !supported || channels < 1 || channels > 2 || sampleRate <= 0) {
+        std::cerr << filename << ": only 8 to 32-bit PCM or float WAV, mono or stereo, is supported" << std::endl;
+        return false;
+    }
+
+    const size_t bytesPerSample = bits / 8;
+    const size_t count = sampleBytes / bytesPerSample / channels * channels;
+    outSound.samples.resize(count);
+    outSound.channels = channels;
+    outSound.sampleRate = sampleRate;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* sample = samples + i * bytesPerSample;
+        float value;
+        if (format == WAV_FORMAT_FLOAT) {
+            std::memcpy(&value, sample, sizeof(value));
+        } else if (bits == 8) {
+            value = (sample[0] - 128) / 128.0f;
+        } else if (bits == 16) {
+            value = static_cast<int16_t>(GetLe16(sample)) / 32768.0f;
+        } else if (bits == 24) {
+            const int32_t wide = static_cast<int32_t>((sample[0] << 8) | (sample[1] << 16) | (static_cast<uint32_t>(sample[2]) << 24));
+            value = (wide >> 8) / 8388608.0f;
+        } else {
+            value = static_cast<int32_t>(GetLe32(sample)) / 2147483648.0f;
+        }
+        outSound.samples[i] = value;
+    }
+    return true;
+}
+
+// Placeholders until the game ships its own sounds: noise bursts for shots and impacts, a falling tone otherwise
+static void SynthesizeSound(const std::string& name, CyborAudioMixer::Sound& outSound) {
+    const int sampleRate = CyborAudioMixer::SAMPLE_RATE;
+    outSound.channels = 1;
+    outSound.sampleRate = sampleRate;
+
+    if (name == "bullet_impact" || name == "weapon_fire") {
+        // A shot is longer, with a low thump under the crack
+        const bool shot = name == "weapon_fire";
+        outSound.samples.resize(shot ? sampleRate / 4 : sampleRate / 10);
+        uint32_t noise = 0x2545F491u;
+        for (size_t i = 0; i < outSound.samples.size(); i++) {
+            noise ^= noise << 13;
+            noise ^= noise >> 17;
+            noise ^= noise << 5;
+            const float t = static_cast<float>(i) / sampleRate;
+            const float envelope = std::exp(-t / (shot ? 0.04f : 0.015f));
+            float sample = (static_cast<int32_t>(noise) / 2147483648.0f) * envelope;
+            if (shot) sample = sample * 0.5f + std::sin(6.28318531f * 90.0f * t) * std::exp(-t / 0.08f) * 0.4f;
+            outSound.samples[i] = sample * 0.8f;
+        }
+    } else {
+        outSound.samples.resize(sampleRate * 2 / 5);
+        float phase = 0.0f;
+        for (size_t i = 0; i < outSound.samples.size(); i++) {
+            const float t = static_cast<float>(i) / sampleRate;
+            const float frequency = 880.0f - 1500.0f * t;
+            phase += 6.28318531f * frequency / sampleRate;
+            const float envelope = std::min(1.0f, t * 200.0f) * std::exp(-t * 6.0f);
+            outSound.samples[i] = std::sin(phase) * envelope * 0.6f;
+        }
+    }
+}
+
 CyborAudioSystem::CyborAudioSystem()
-    : m_initialized(false), m_masterVolume(1.0f), m_musicVolume(0.7f), m_sfxVolume(0.8f),
-      m_currentMusic(""), m_backgroundMusicEnabled(true) {
+    : m_initialized(false), m_musicVoice(CyborAudioMixer::INVALID_VOICE), m_currentMusic(""),
+      m_backgroundMusicEnabled(true), m_masterVolume(1.0f), m_sfxVolume(0.8f), m_musicVolume(0.7f),
+      m_listenerPosition(0.0f), m_listenerForward(0.0f, 0.0f, -1.0f), m_listenerUp(0.0f, 1.0f, 0.0f),
+      m_cyborAudioEnabled(true), m_cyborAudioIntensity(1.0f) {
 }
 
 CyborAudioSystem::~CyborAudioSystem() {
     Shutdown();
 }
 
-bool CyborAudioSystem::Initialize() {
-    // Initialize audio system
-    // In a real implementation, this would initialize OpenAL, FMOD, or similar
+bool CyborAudioSystem::Initialize(std::unique_ptr<CyborAudioSink> sink) {
+    if (m_initialized) return true;
     std::cout << "Initializing Cybor Audio System..." << std::endl;
-    
+
+    bool started;
+    if (sink) {
+        started = m_mixer.Start(std::move(sink));
+    } else {
+        started = m_mixer.Start(std::make_unique<CyborDeviceAudioSink>());
+        if (!started) {
+            std::cout << "No sound device; Cybor audio will mix silently" << std::endl;
+            started = m_mixer.Start(std::make_unique<CyborNullAudioSink>());
+        }
+    }
+    if (!started) {
+        std::cerr << "Failed to start the Cybor audio mixer" << std::endl;
+        return false;
+    }
+
+    m_mixer.SetMasterGain(m_masterVolume);
+    m_mixer.SetBusGain(CyborAudioMixer::Bus::SFX, m_sfxVolume);
+    m_mixer.SetBusGain(CyborAudioMixer::Bus::MUSIC, m_musicVolume);
     m_initialized = true;
-    std::cout << "Cybor Audio System initialized successfully!" << std::endl;
+    LoadDefaultSounds();
+
+    std::cout << "Cybor Audio System initialized successfully! (" << CyborAudioMixer::SAMPLE_RATE << " Hz stereo, "
+              << m_mixer.GetSinkName() << " output)" << std::endl;
     return true;
 }
 
 void CyborAudioSystem::Update(float deltaTime) {
     if (!m_initialized) return;
-    
-    // Update audio sources, fade effects, etc.
-    // This would handle audio updates in a real implementation
+
+    // Unloaded sounds are freed once the mixer has let go of them
+    const Sound* released;
+    while (m_mixer.PollReleasedSound(released)) {
+        auto it = std::find_if(m_retiredSounds.begin(), m_retiredSounds.end(),
+            [released](const std::unique_ptr<Sound>& sound) { return sound.get() == released; });
+        if (it != m_retiredSounds.end()) m_retiredSounds.erase(it);
+    }
 }
 
-void CyborAudioSystem::PlaySound(const std::string& soundName, float volume) {
+bool CyborAudioSystem::LoadSound(const std::string& name, const std::string& filename) {
+    auto sound = std::make_unique<Sound>();
+    if (!LoadWavFile(filename, *sound)) {
+        std::cerr << "Failed to load sound " << name << " from " << filename << std::endl;
+        return false;
+    }
+
+    UnloadSound(name);
+    m_sounds[name] = std::move(sound);
+    return true;
+}
+
+void CyborAudioSystem::UnloadSound(const std::string& name) {
+    auto it = m_sounds.find(name);
+    if (it == m_sounds.end()) return;
+    RetireSound(std::move(it->second));
+    m_sounds.erase(it);
+}
+
+void CyborAudioSystem::UnloadAllSounds() {
+    for (auto& entry : m_sounds) RetireSound(std::move(entry.second));
+    m_sounds.clear();
+}
+
+void CyborAudioSystem::PlaySound(const std::string& name, float volume, bool loop) {
     if (!m_initialized) return;
-    
-    float finalVolume = volume * m_sfxVolume * m_masterVolume;
-    std::cout << "Playing sound: " << soundName << " (Volume: " << finalVolume << ")" << std::endl;
+
+    auto it = m_sounds.find(name);
+    if (it == m_sounds.end()) return;
+    m_mixer.Play(it->second.get(), CyborAudioMixer::Bus::SFX, volume, 0.0f, 1.0f, loop, NON_POSITIONAL_PRIORITY);
 }
 
-void CyborAudioSystem::PlayBackgroundMusic(const std::string& musicFile) {
+void CyborAudioSystem::PlayBackgroundMusic(const std::string& filename, float volume) {
     if (!m_initialized || !m_backgroundMusicEnabled) return;
-    
-    m_currentMusic = musicFile;
-    float finalVolume = m_musicVolume * m_masterVolume;
-    std::cout << "Playing background music: " << musicFile << " (Volume: " << finalVolume << ")" << std::endl;
+
+    auto music = std::make_unique<Sound>();
+    if (!LoadWavFile(filename, *music)) {
+        std::cerr << "Cannot play background music " << filename << std::endl;
+        return;
+    }
+
+    StopMusic();
+    m_music = std::move(music);
+    m_musicVoice = m_mixer.Play(m_music.get(), CyborAudioMixer::Bus::MUSIC, volume, 0.0f, 1.0f, true,
+                                NON_POSITIONAL_PRIORITY);
+    m_currentMusic = filename;
+    std::cout << "Playing background music: " << filename << std::endl;
 }
 
 void CyborAudioSystem::StopMusic() {
-    if (!m_initialized) return;
-    
+    if (!m_music) return;
+
+    m_mixer.StopVoice(m_musicVoice);
+    RetireSound(std::move(m_music));
+    m_musicVoice = CyborAudioMixer::INVALID_VOICE;
     m_currentMusic = "";
-    std::cout << "Stopped background music" << std::endl;
+}
+
+void CyborAudioSystem::EnableBackgroundMusic(bool enable) {
+    m_backgroundMusicEnabled = enable;
+    if (!enable) {
+        StopMusic();
+    }
+    std::cout << "Background music " << (enable ? "enabled" : "disabled") << std::endl;
+}
+
+void CyborAudioSystem::StopSound(const std::string& name) {
+    auto it = m_sounds.find(name);
+    if (m_initialized && it != m_sounds.end()) m_mixer.StopSound(it->second.get());
+}
+
+void CyborAudioSystem::StopAllSounds() {
+    if (!m_initialized) return;
+    m_mixer.StopAll();
+    m_musicVoice = CyborAudioMixer::INVALID_VOICE;
+}
+
+void CyborAudioSystem::PlaySound3D(const std::string& name, const glm::vec3& position, float volume, float maxDistance,
+                                   float priority) {
+    if (!m_initialized) return;
+
+    auto it = m_sounds.find(name);
+    if (it == m_sounds.end()) return;
+    const float gain = volume * CalculateVolumeByDistance(position, maxDistance);
+    if (gain <= 0.0f) return;
+    // Distant sounds still get a voice; the mixer only mixes the most audible of them
+    m_mixer.Play(it->second.get(), CyborAudioMixer::Bus::SFX, gain, CalculatePan(position), 1.0f, false, priority);
+}
+
+void CyborAudioSystem::SetListenerPosition(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up) {
+    m_listenerPosition = position;
+    m_listenerForward = forward;
+    m_listenerUp = up;
 }
 
 void CyborAudioSystem::SetMasterVolume(float volume) {
     m_masterVolume = std::clamp(volume, 0.0f, 1.0f);
-    std::cout << "Master volume set to: " << m_masterVolume << std::endl;
+    if (m_initialized) m_mixer.SetMasterGain(m_masterVolume);
 }
 
 void CyborAudioSystem::SetMusicVolume(float volume) {
     m_musicVolume = std::clamp(volume, 0.0f, 1.0f);
-    std::cout << "Music volume set to: " << m_musicVolume << std::endl;
+    if (m_initialized) m_mixer.SetBusGain(CyborAudioMixer::Bus::MUSIC, m_musicVolume);
 }
 
 void CyborAudioSystem::SetSFXVolume(float volume) {
     m_sfxVolume = std::clamp(volume, 0.0f, 1.0f);
-    std::cout << "SFX volume set to: " << m_sfxVolume << std::endl;
+    if (m_initialized) m_mixer.SetBusGain(CyborAudioMixer::Bus::SFX, m_sfxVolume);
 }
 
-void CyborAudioSystem::EnableBackgroundMusic(bool enable) {
-    m_backgroundMusicEnabled = enable;
-    if (!enable) {
-        StopMusic();
-    }
-    std::cout << "Background music " << (enable ? "enabled" : "disabled") << std::endl;
+void CyborAudioSystem::PlayCyborEffect(const std::string& effectName) {
+    if (!m_initialized || !m_cyborAudioEnabled) return;
+
+    auto it = m_sounds.find(effectName);
+    if (it == m_sounds.end()) return;
+    // Stronger Cybor effects play louder and a little higher
+    const float intensity = std::clamp(m_cyborAudioIntensity, 0.0f, 2.0f);
+    m_mixer.Play(it->second.get(), CyborAudioMixer::Bus::SFX, intensity, 0.0f, 1.0f + 0.1f * intensity, false,
+                 NON_POSITIONAL_PRIORITY);
 }
 
 void CyborAudioSystem::Shutdown() {
     if (m_initialized) {
-        StopMusic();
+        m_mixer.Stop();
         m_initialized = false;
         std::cout << "Cybor Audio System shut down" << std::endl;
     }
-} 
\ No newline at end of file
+
+    // The mixer has stopped; no voice can touch a sound now
+    m_sounds.clear();
+    m_retiredSounds.clear();
+    m_music.reset();
+    m_musicVoice = CyborAudioMixer::INVALID_VOICE;
+    m_currentMusic = "";
+}
+
+void CyborAudioSystem::LoadDefaultSounds() {
+    for (const char* name : DEFAULT_SOUNDS) {
+        if (m_sounds.count(name)) continue;
+        auto sound = std::make_unique<Sound>();
+        if (!LoadWavFile(std::string(DEFAULT_SOUND_DIRECTORY) + name + ".wav", *sound)) SynthesizeSound(name, *sound);
+        m_sounds[name] = std::move(sound);
+    }
+}
+
+void CyborAudioSystem::RetireSound(std::unique_ptr<Sound> sound) {
+    if (!sound) return;
+    if (!m_mixer.IsRunning()) return; // Nothing plays it; freed right here
+
+    m_mixer.ReleaseSound(sound.get());
+    m_retiredSounds.push_back(std::move(sound));
+}
+
+float CyborAudioSystem::CalculateVolumeByDistance(const glm::vec3& sourcePos, float maxDistance) {
+    // Inverse distance beyond a metre, faded out to nothing at the maximum distance
+    const float distance = glm::length(sourcePos - m_listenerPosition);
+    if (distance >= maxDistance) return 0.0f;
+    const float attenuation = 1.0f / std::max(distance, 1.0f);
+    const float fade = 1.0f - distance / maxDistance;
+    return attenuation * fade;
+}
+
+float CyborAudioSystem::CalculatePan(const glm::vec3& sourcePos) const {
+    const glm::vec3 offset = sourcePos - m_listenerPosition;
+    const glm::vec3 right = glm::cross(m_listenerForward, m_listenerUp);
+    const float length = glm::length(offset);
+    const float rightLength = glm::length(right);
+    if (length < 1e-4f || rightLength < 1e-4f) return 0.0f;
+    return glm::dot(offset / length, right / rightLength);
+}
@@ -1,23 +1,30 @@
 #pragma once
 
+#include <glm/glm.hpp>
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
+#include "CyborAudioMixer.h"
 
 /*
  * CyborAudioSystem - Advanced 3D audio system
- * Handles weapon sounds, ambient audio, and Cybor sound effects
+ * Handles weapon sounds, ambient audio, and Cybor sound effects. Sounds are
+ * decoded up front and played by the software mixer on its own thread;
+ * everything here runs on the game thread and never waits for the mixer.
  */
 class CyborAudioSystem {
 public:
     CyborAudioSystem();
     ~CyborAudioSystem();
 
-    bool Initialize();
+    // Plays into the sink, such as a WAV file for headless runs; by default on the
+    // sound device, or silently when there is none
+    bool Initialize(std::unique_ptr<CyborAudioSink> sink = nullptr);
     void Update(float deltaTime);
     void Shutdown();
 
-    // Sound loading and management
+    // Sound loading and management; WAV files, 8 to 32-bit PCM or float, mono or stereo
     bool LoadSound(const std::string& name, const std::string& filename);
     void UnloadSound(const std::string& name);
     void UnloadAllSounds();
@@ -25,13 +32,16 @@ public:
     // 2D Sound playback
     void PlaySound(const std::string& name, float volume = 1.0f, bool loop = false);
     void PlayBackgroundMusic(const std::string& filename, float volume = 0.5f);
+    void StopMusic();
+    void EnableBackgroundMusic(bool enable);
     void StopSound(const std::string& name);
     void StopAllSounds();
 
-    // 3D Positional audio
-    void PlaySound3D(const std::string& name, const glm::vec3& position, 
-                     float volume = 1.0f, float maxDistance = 100.0f);
-    void SetListenerPosition(const glm::vec3& position, const glm::vec3& forward, 
+    // 3D Positional audio. Priority weighs the sound against others when there are more
+    // playing than the mixer mixes; the least audible are kept but not heard.
+    void PlaySound3D(const std::string& name, const glm::vec3& position,
+                     float volume = 1.0f, float maxDistance = 100.0f, float priority = 1.0f);
+    void SetListenerPosition(const glm::vec3& position, const glm::vec3& forward,
                            const glm::vec3& up);
 
     // Volume controls
@@ -44,17 +54,22 @@ public:
     void SetCyborAudioIntensity(float intensity) { m_cyborAudioIntensity = intensity; }
     void PlayCyborEffect(const std::string& effectName);
 
+    CyborAudioMixer::Stats GetMixerStats() { return m_mixer.GetStats(); }
+    const char* GetOutputName() const { return m_mixer.GetSinkName(); }
+
 private:
-    struct AudioSource {
-        // Audio implementation would use OpenAL or similar
-        std::string filename;
-        bool is3D;
-        bool isLooping;
-        float volume;
-        glm::vec3 position;
-    };
+    using Sound = CyborAudioMixer::Sound;
+
+    bool m_initialized;
+    CyborAudioMixer m_mixer;
+    std::unordered_map<std::string, std::unique_ptr<Sound>> m_sounds;
+    std::vector<std::unique_ptr<Sound>> m_retiredSounds; // Unloaded, until the mixer lets go of them
 
-    std::unordered_map<std::string, std::unique_ptr<AudioSource>> m_sounds;
+    // Background music
+    std::unique_ptr<Sound> m_music;
+    CyborAudioMixer::VoiceId m_musicVoice;
+    std::string m_currentMusic;
+    bool m_backgroundMusicEnabled;
 
     // Volume settings
     float m_masterVolume;
@@ -71,7 +86,8 @@ private:
     float m_cyborAudioIntensity;
 
     // Private methods
-    void InitializeAudioDevice();
     void LoadDefaultSounds();
+    void RetireSound(std::unique_ptr<Sound> sound);
     float CalculateVolumeByDistance(const glm::vec3& sourcePos, float maxDistance);
+    float CalculatePan(const glm::vec3& sourcePos) const;
 };
@@ -4,7 +4,7 @@
 
 CyborEngine::CyborEngine() 
     : m_window(nullptr), m_windowWidth(0), m_windowHeight(0),
-      m_deltaTime(0.0f), m_fps(0.0f), 
+      m_deltaTime(0.0f), m_fps(0.0f), m_fpsTimer(0.0f), m_frameCount(0),
       m_cyborModeEnabled(false), m_cyborIntensity(1.0f) {
     m_lastTime = std::chrono::high_resolution_clock::now();
     m_lastMousePos = glm::vec2(0.0f);
@@ -165,16 +165,13 @@ void CyborEngine::SetProjectionMatrix(const glm::mat4& projection) {
 }
 
 void CyborEngine::UpdateFPS() {
-    static float fpsTimer = 0.0f;
-    static int frameCount = 0;
+    m_frameCount++;
+    m_fpsTimer += m_deltaTime;
 
-    frameCount++;
-    fpsTimer += m_deltaTime;
-
-    if (fpsTimer >= 1.0f) {
-        m_fps = frameCount / fpsTimer;
-        frameCount = 0;
-        fpsTimer = 0.0f;
+    if (m_fpsTimer >= 1.0f) {
+        m_fps = m_frameCount / m_fpsTimer;
+        m_frameCount = 0;
+        m_fpsTimer = 0.0f;
 
         // Update window title with FPS
         std::string title = m_windowTitle + " - FPS: " + std::to_string((int)m_fps);
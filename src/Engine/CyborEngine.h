@@ -57,6 +57,8 @@ private:
     std::chrono::high_resolution_clock::time_point m_lastTime;
     float m_deltaTime;
     float m_fps;
+    float m_fpsTimer;
+    int m_frameCount;
 
     // Matrices
     glm::mat4 m_viewMatrix;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/*
+ * CyborSpscQueue - Bounded lock-free queue for one producer and one consumer thread
+ * Each side owns one index and only reads the other's when its cached copy
+ * says the ring looks full or empty, so the two threads rarely share a
+ * cache line. Neither side ever waits for the other.
+ */
+template <typename T>
+class CyborSpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit CyborSpscQueue(size_t capacity)
+        : m_mask(RoundUp(capacity) - 1), m_slots(new T[m_mask + 1]),
+          m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {
+    }
+
+    CyborSpscQueue(const CyborSpscQueue&) = delete;
+    CyborSpscQueue& operator=(const CyborSpscQueue&) = delete;
+
+    // Producer thread only; false when full
+    bool TryPush(T&& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only; false when empty
+    bool TryPop(T& outValue) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) return false;
+        }
+        outValue = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate from any thread
+    size_t Size() const { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    const size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    // Consumer side
+    alignas(CACHE_LINE) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+
+    // Producer side
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+
+    static size_t RoundUp(size_t value) {
+        size_t power = 1;
+        while (power < value) power <<= 1;
+        return power;
+    }
+};
@@ -0,0 +1,141 @@
+#include "CyborTickScheduler.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+// Ticks a late server may run back to back before it gives up on them
+static const int MAX_CATCH_UP_TICKS = 4;
+// Weight of the newest tick in the smoothed load
+static const double LOAD_SMOOTHING = 0.1;
+// Hysteresis: shed work quickly, take it back only once there is real headroom
+static const double RECOVER_LOAD_RATIO = 0.5;
+static const double RAISE_HOLD_SECONDS = 0.125;
+static const double LOWER_HOLD_SECONDS = 1.0;
+
+static const char* const PHASE_NAMES[CyborTickScheduler::PHASE_COUNT] = { "receive", "simulate", "send" };
+
+CyborTickScheduler::CyborTickScheduler(int tickRate)
+    : m_budgetFraction(0.9), m_degradationEnabled(true), m_reporting(false), m_started(false),
+      m_currentPhase(-1), m_load(0.0), m_level(0), m_ticksAtLevel(0) {
+    SetTickRate(tickRate);
+    ResetStats();
+    m_lastTick = TickTiming{ { 0.0, 0.0, 0.0 }, 0.0 };
+}
+
+CyborTickScheduler::~CyborTickScheduler() {
+}
+
+void CyborTickScheduler::SetTickRate(int tickRate) {
+    m_tickRate = std::max(1, tickRate);
+    m_interval = 1.0 / m_tickRate;
+    m_started = false;
+}
+
+void CyborTickScheduler::EnableDegradation(bool enable) {
+    m_degradationEnabled = enable;
+    if (!enable) {
+        m_level = 0;
+        m_ticksAtLevel = 0;
+    }
+}
+
+void CyborTickScheduler::WaitForNextTick() {
+    const Clock::time_point now = Clock::now();
+    const Clock::duration interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_interval));
+    if (!m_started) {
+        m_nextTick = now;
+        m_started = true;
+        return;
+    }
+
+    // The timeline is absolute, so time spent working never pushes later ticks back
+    m_nextTick += interval;
+    if (now - m_nextTick > interval * MAX_CATCH_UP_TICKS) {
+        m_stats.droppedTicks += static_cast<uint64_t>((now - m_nextTick) / interval);
+        m_nextTick = now;
+    }
+    if (m_nextTick > now) std::this_thread::sleep_until(m_nextTick);
+}
+
+void CyborTickScheduler::BeginTick() {
+    m_tickStart = Clock::now();
+    m_phaseStart = m_tickStart;
+    m_currentPhase = -1;
+    m_currentTick = TickTiming{ { 0.0, 0.0, 0.0 }, 0.0 };
+}
+
+void CyborTickScheduler::BeginPhase(Phase phase) {
+    const Clock::time_point now = Clock::now();
+    EndPhase(now);
+    m_currentPhase = static_cast<int>(phase);
+    m_phaseStart = now;
+}
+
+void CyborTickScheduler::EndTick() {
+    const Clock::time_point now = Clock::now();
+    EndPhase(now);
+    m_currentTick.totalTime = Seconds(now - m_tickStart);
+    m_lastTick = m_currentTick;
+
+    const double tickTime = m_currentTick.totalTime;
+    const bool overrun = tickTime > GetBudget();
+    m_stats.ticks++;
+    if (overrun) m_stats.overruns++;
+    for (int i = 0; i < PHASE_COUNT; i++) m_stats.phaseTime[i] += m_currentTick.phaseTime[i];
+    m_stats.totalTime += tickTime;
+    m_stats.maxTickTime = std::max(m_stats.maxTickTime, tickTime);
+    m_stats.ticksAtLevel[m_level]++;
+
+    UpdateDegradation(tickTime);
+
+    if (overrun) {
+        if (m_windowOverruns == 0 || tickTime > m_windowWorst.totalTime) m_windowWorst = m_currentTick;
+        m_windowOverruns++;
+    }
+    if (++m_windowTicks >= m_tickRate) {
+        if (m_reporting && m_windowOverruns > 0) Report();
+        m_windowTicks = 0;
+        m_windowOverruns = 0;
+    }
+}
+
+void CyborTickScheduler::ResetStats() {
+    m_stats = Stats{};
+    m_windowTicks = 0;
+    m_windowOverruns = 0;
+}
+
+void CyborTickScheduler::EndPhase(Clock::time_point now) {
+    if (m_currentPhase < 0) return;
+    m_currentTick.phaseTime[m_currentPhase] += Seconds(now - m_phaseStart);
+    m_currentPhase = -1;
+}
+
+void CyborTickScheduler::UpdateDegradation(double tickTime) {
+    m_load += (tickTime / m_interval - m_load) * LOAD_SMOOTHING;
+    m_ticksAtLevel++;
+    if (!m_degradationEnabled) return;
+
+    const int level = m_level;
+    if (m_load > m_budgetFraction && m_level < MAX_DEGRADATION && m_ticksAtLevel >= RAISE_HOLD_SECONDS * m_tickRate) {
+        m_level++;
+    } else if (m_load < m_budgetFraction * RECOVER_LOAD_RATIO && m_level > 0 &&
+               m_ticksAtLevel >= LOWER_HOLD_SECONDS * m_tickRate) {
+        m_level--;
+    }
+    if (m_level != level) m_ticksAtLevel = 0;
+}
+
+void CyborTickScheduler::Report() {
+    std::cout << "Server tick over budget " << m_windowOverruns << "/" << m_windowTicks
+              << " ticks in the last second: worst " << m_windowWorst.totalTime * 1000.0 << " ms of "
+              << GetBudget() * 1000.0 << " ms (";
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        std::cout << (i ? ", " : "") << PHASE_NAMES[i] << " " << m_windowWorst.phaseTime[i] * 1000.0 << " ms";
+    }
+    std::cout << "), degradation level " << m_level << std::endl;
+}
+
+double CyborTickScheduler::Seconds(Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/*
+ * CyborTickScheduler - Fixed-rate server tick with a per-tick time budget
+ * Ticks are scheduled on an absolute timeline so the rate never drifts; a
+ * late tick runs straight away and one hopelessly behind is dropped rather
+ * than bursting. Each tick is timed per phase, and a smoothed load figure
+ * drives a degradation level the server uses to shed work before it overruns.
+ */
+class CyborTickScheduler {
+public:
+    enum class Phase {
+        RECEIVE,
+        SIMULATE,
+        SEND
+    };
+    static constexpr int PHASE_COUNT = 3;
+
+    // 0 runs everything at full detail; each level sheds more work
+    static constexpr int MAX_DEGRADATION = 3;
+
+    struct TickTiming {
+        double phaseTime[PHASE_COUNT]; // Seconds
+        double totalTime;
+    };
+
+    struct Stats {
+        uint64_t ticks;
+        uint64_t overruns;     // Ticks whose work went over the budget
+        uint64_t droppedTicks; // Ticks skipped because the server fell too far behind
+        double phaseTime[PHASE_COUNT];
+        double totalTime;
+        double maxTickTime;
+        uint64_t ticksAtLevel[MAX_DEGRADATION + 1];
+    };
+
+public:
+    explicit CyborTickScheduler(int tickRate = 64);
+    ~CyborTickScheduler();
+
+    // Configuration; 64 and 128 Hz are the usual rates
+    void SetTickRate(int tickRate);
+    int GetTickRate() const { return m_tickRate; }
+    float GetTickInterval() const { return static_cast<float>(m_interval); }
+    // Share of the tick interval the work may take, the rest is slack for the OS
+    void SetBudget(double fraction) { m_budgetFraction = fraction; }
+    double GetBudget() const { return m_interval * m_budgetFraction; }
+    // Degradation off keeps the level at 0 but still measures and reports
+    void EnableDegradation(bool enable);
+    // Prints a line for every second that had overruns
+    void EnableReporting(bool enable) { m_reporting = enable; }
+
+    // Sleeps until the next tick is due; returns at once the first time
+    void WaitForNextTick();
+
+    // Timing of one tick: BeginTick, then any phases in any order, then EndTick
+    void BeginTick();
+    void BeginPhase(Phase phase);
+    void EndTick();
+
+    // Results
+    int GetDegradationLevel() const { return m_level; }
+    double GetLoad() const { return m_load; } // Smoothed fraction of the interval in use
+    const TickTiming& GetLastTick() const { return m_lastTick; }
+    const Stats& GetStats() const { return m_stats; }
+    void ResetStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int m_tickRate;
+    double m_interval;
+    double m_budgetFraction;
+    bool m_degradationEnabled;
+    bool m_reporting;
+
+    // Schedule
+    bool m_started;
+    Clock::time_point m_nextTick;
+
+    // Current tick
+    Clock::time_point m_tickStart;
+    Clock::time_point m_phaseStart;
+    int m_currentPhase; // -1 between phases
+    TickTiming m_currentTick;
+    TickTiming m_lastTick;
+
+    // Degradation
+    double m_load;
+    int m_level;
+    int m_ticksAtLevel; // Since the level last changed
+
+    // Overruns in the current one-second report window
+    int m_windowTicks;
+    int m_windowOverruns;
+    TickTiming m_windowWorst;
+
+    Stats m_stats;
+
+    void EndPhase(Clock::time_point now);
+    void UpdateDegradation(double tickTime);
+    void Report();
+    static double Seconds(Clock::duration duration);
+};
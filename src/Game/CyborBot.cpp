@@ -1,15 +1,16 @@
 #include "CyborBot.h"
+#include "CyborDamageSystem.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <random>
 
 CyborBot::CyborBot(const std::string& name, Team team, BotDifficulty difficulty)
-    : m_name(name), m_team(team), m_difficulty(difficulty), m_currentState(BotState::IDLE),
+    : m_entityId(0), m_name(name), m_team(team), m_difficulty(difficulty), m_currentState(BotState::IDLE),
       m_position(0.0f), m_velocity(0.0f), m_forward(0.0f, 0.0f, -1.0f),
       m_right(1.0f, 0.0f, 0.0f), m_up(0.0f, 1.0f, 0.0f), m_target(0.0f),
       m_yaw(-90.0f), m_pitch(0.0f),
-      m_health(100.0f), m_maxHealth(100.0f), m_armor(100.0f),
+      m_health(100.0f), m_maxHealth(100.0f), m_armor(100.0f), m_elapsedTime(0.0f), m_skippedTime(0.0f), m_renderTimer(0.0f),
       m_viewDistance(50.0f), m_fieldOfView(90.0f), m_reactionTime(0.5f), m_accuracy(0.7f), m_movementSpeed(3.0f),
       m_currentWaypointIndex(0), m_hasPath(false),
       m_stateTimer(0.0f), m_lastShotTime(0.0f), m_lastSeenPlayerTime(0.0f), m_playerVisible(false),
@@ -77,7 +78,11 @@ bool CyborBot::Initialize(const glm::vec3& spawnPosition) {
 void CyborBot::Update(float deltaTime, const glm::vec3& playerPosition) {
     if (!IsAlive()) return;
 
+    deltaTime += m_skippedTime;
+    m_skippedTime = 0.0f;
+
     m_stateTimer += deltaTime;
+    m_elapsedTime += deltaTime;
     
     // Update AI
     UpdateAI(deltaTime, playerPosition);
@@ -86,7 +91,7 @@ void CyborBot::Update(float deltaTime, const glm::vec3& playerPosition) {
     UpdateMovement(deltaTime);
     
     // Update combat
-    UpdateCombat(deltaTime);
+    UpdateCombat();
     
     // Update vision
     UpdateVision(playerPosition);
@@ -162,9 +167,10 @@ void CyborBot::UpdateMovement(float deltaTime) {
     }
 }
 
-void CyborBot::UpdateCombat(float deltaTime) {
-    if (m_currentWeapon) {
-        m_currentWeapon->Update(deltaTime);
+void CyborBot::UpdateCombat() {
+    // Weapon state advances on its own timestamps; only react once the magazine is empty
+    if (m_currentWeapon && !m_currentWeapon->HasAmmo(m_elapsedTime)) {
+        Reload();
     }
 }
 
@@ -210,10 +216,11 @@ void CyborBot::UpdatePatrolBehavior(float deltaTime) {
 void CyborBot::UpdateSearchBehavior(float deltaTime) {
     // Search around last known player position
     if (!m_hasPath) {
+        std::uniform_int_distribution<int> offset(-10, 9);
         glm::vec3 searchPoint = m_lastKnownPlayerPosition + glm::vec3(
-            (rand() % 20) - 10.0f,
+            static_cast<float>(offset(m_random)),
             0.0f,
-            (rand() % 20) - 10.0f
+            static_cast<float>(offset(m_random))
         );
         m_destination = searchPoint;
         m_hasPath = true;
@@ -279,7 +286,7 @@ void CyborBot::UpdateDefendBehavior(float deltaTime) {
 }
 
 void CyborBot::Shoot(const glm::vec3& target) {
-    if (m_currentWeapon && m_currentWeapon->CanShoot()) {
+    if (m_currentWeapon && m_currentWeapon->CanShoot(m_elapsedTime)) {
         glm::vec3 direction = glm::normalize(target - m_position);
         
         // Apply accuracy
@@ -287,37 +294,40 @@ void CyborBot::Shoot(const glm::vec3& target) {
             direction = CalculateSpread(direction);
         }
         
-        if (m_currentWeapon->Fire(m_position, direction)) {
-            std::cout << m_name << " fired at target!" << std::endl;
+        CyborWeapon::ShotInfo shot;
+        if (m_currentWeapon->Fire(m_position, direction, m_elapsedTime, &shot)) {
+            m_pendingShots.push_back(shot);
         }
     }
 }
 
+void CyborBot::Reload() {
+    if (m_currentWeapon) {
+        m_currentWeapon->Reload(m_elapsedTime);
+    }
+}
+
 void CyborBot::TakeDamage(float damage, const glm::vec3& hitDirection) {
     if (!IsAlive()) return;
-    
-    // Armor absorbs damage first
-    float damageToHealth = damage;
-    if (m_armor > 0.0f) {
-        float armorAbsorption = std::min(m_armor, damage * 0.5f);
-        m_armor -= armorAbsorption;
-        damageToHealth -= armorAbsorption;
-    }
-    
-    // Apply remaining damage to health
-    if (damageToHealth > 0.0f) {
-        m_health -= damageToHealth;
-    }
-    
-    std::cout << m_name << " took " << damage << " damage. Health: " << m_health << std::endl;
-    
+
+    float health = m_health;
+    float armor = m_armor;
+    CyborDamageSystem::AbsorbDamage(health, armor, damage);
+    ApplyDamageResult(health, armor);
+}
+
+void CyborBot::ApplyDamageResult(float health, float armor) {
+    bool wasAlive = IsAlive();
+    m_health = health;
+    m_armor = armor;
+
     // React to damage
     if (m_health < 50.0f) {
         m_currentState = BotState::RETREATING;
         m_stateTimer = 0.0f;
     }
-    
-    if (!IsAlive()) {
+
+    if (wasAlive && !IsAlive()) {
         std::cout << m_name << " was eliminated!" << std::endl;
     }
 }
@@ -441,16 +451,13 @@ glm::vec3 CyborBot::FindCoverPosition() {
 
 glm::vec3 CyborBot::CalculateSpread(const glm::vec3& direction) {
     // Apply accuracy-based spread
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    
     float spreadAngle = (1.0f - m_accuracy) * 0.05f;
     std::uniform_real_distribution<float> dist(-spreadAngle, spreadAngle);
     
     glm::vec3 spreadDirection = direction;
-    spreadDirection.x += dist(gen);
-    spreadDirection.y += dist(gen);
-    spreadDirection.z += dist(gen);
+    spreadDirection.x += dist(m_random);
+    spreadDirection.y += dist(m_random);
+    spreadDirection.z += dist(m_random);
     
     return glm::normalize(spreadDirection);
 }
@@ -458,12 +465,11 @@ glm::vec3 CyborBot::CalculateSpread(const glm::vec3& direction) {
 void CyborBot::Render() {
     // Bot rendering would go here
     // For now, we'll just output position info periodically
-    static float renderTimer = 0.0f;
-    renderTimer += 0.016f;
+    m_renderTimer += 0.016f;
     
-    if (renderTimer > 2.0f) {
+    if (m_renderTimer > 2.0f) {
         std::cout << m_name << " at (" << m_position.x << ", " << m_position.y << ", " << m_position.z 
                   << ") State: " << (int)m_currentState << " Health: " << m_health << std::endl;
-        renderTimer = 0.0f;
+        m_renderTimer = 0.0f;
     }
 } 
\ No newline at end of file
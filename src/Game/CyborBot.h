@@ -1,9 +1,11 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
+#include <random>
 #include "CyborWeapon.h"
 
 /*
@@ -42,6 +44,8 @@ public:
 
     bool Initialize(const glm::vec3& spawnPosition);
     void Update(float deltaTime, const glm::vec3& playerPosition);
+    // Level of detail: a bot skipped this tick catches up on the time in its next Update
+    void SkipUpdate(float deltaTime) { m_skippedTime += deltaTime; }
     void Render();
 
     // AI Behavior
@@ -65,14 +69,27 @@ public:
     void Reload();
     void SwitchWeapon();
     void TakeDamage(float damage, const glm::vec3& hitDirection = glm::vec3(0));
+    void ApplyDamageResult(float health, float armor);
+
+    // Shots fired since the last call, drained by the game manager for hit registration
+    std::vector<CyborWeapon::ShotInfo>& GetPendingShots() { return m_pendingShots; }
 
     // Getters
+    void SetEntityId(uint32_t id) { m_entityId = id; }
+    // Each bot draws from its own generator; nothing is shared between matches
+    void SeedRandom(uint32_t seed) { m_random.seed(seed); }
+    uint32_t GetEntityId() const { return m_entityId; }
+    const std::string& GetName() const { return m_name; }
     glm::vec3 GetPosition() const { return m_position; }
     glm::vec3 GetForward() const { return m_forward; }
+    float GetYaw() const { return glm::degrees(m_yaw); }
+    float GetPitch() const { return glm::degrees(m_pitch); }
+    std::shared_ptr<CyborWeapon> GetCurrentWeapon() const { return m_currentWeapon; }
     Team GetTeam() const { return m_team; }
     BotDifficulty GetDifficulty() const { return m_difficulty; }
     BotState GetState() const { return m_currentState; }
     float GetHealth() const { return m_health; }
+    float GetArmor() const { return m_armor; }
     bool IsAlive() const { return m_health > 0.0f; }
     bool IsPlayerVisible() const { return m_playerVisible; }
 
@@ -83,6 +100,7 @@ public:
 
 private:
     // Basic properties
+    uint32_t m_entityId;
     std::string m_name;
     Team m_team;
     BotDifficulty m_difficulty;
@@ -105,6 +123,11 @@ private:
     float m_armor;
     std::shared_ptr<CyborWeapon> m_currentWeapon;
     std::vector<std::shared_ptr<CyborWeapon>> m_weapons;
+    std::vector<CyborWeapon::ShotInfo> m_pendingShots;
+    float m_elapsedTime; // Owner clock for timestamp-based weapon state
+    float m_skippedTime;
+    float m_renderTimer;
+    std::mt19937 m_random;
 
     // AI properties
     float m_viewDistance;
@@ -139,7 +162,7 @@ private:
     // Private AI methods
     void UpdateAI(float deltaTime, const glm::vec3& playerPosition);
     void UpdateMovement(float deltaTime);
-    void UpdateCombat(float deltaTime);
+    void UpdateCombat();
     void UpdateVision(const glm::vec3& playerPosition);
 
     // State-specific behaviors
@@ -155,7 +178,9 @@ private:
     glm::vec3 GetDirectionToPlayer(const glm::vec3& playerPosition);
     bool IsAtDestination(float threshold = 1.0f);
     void RotateTowards(const glm::vec3& target, float deltaTime);
+    void UpdateOrientation();
     glm::vec3 FindCoverPosition();
+    glm::vec3 CalculateSpread(const glm::vec3& direction);
 
     // Cybor-specific AI
     void PredictPlayerMovement(const glm::vec3& playerPosition, const glm::vec3& playerVelocity);
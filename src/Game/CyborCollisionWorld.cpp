@@ -0,0 +1,251 @@
+#include "CyborCollisionWorld.h"
+#include <algorithm>
+#include <cmath>
+
+// Leaves hold at most this many surfaces
+static const uint32_t BVH_LEAF_SIZE = 4;
+// Traversal stack size. Build stops splitting at this depth, so a traversal never holds more.
+static const int BVH_MAX_DEPTH = 64;
+
+CyborCollisionWorld::CyborCollisionWorld() {
+}
+
+CyborCollisionWorld::~CyborCollisionWorld() {
+}
+
+void CyborCollisionWorld::Clear() {
+    m_surfaces.clear();
+    m_surfaceOrder.clear();
+    m_nodes.clear();
+}
+
+void CyborCollisionWorld::AddSurface(const glm::vec3& boundsMin, const glm::vec3& boundsMax, SurfaceMaterial material) {
+    m_surfaces.push_back({ glm::min(boundsMin, boundsMax), glm::max(boundsMin, boundsMax), material });
+}
+
+void CyborCollisionWorld::Build() {
+    m_nodes.clear();
+    m_surfaceOrder.resize(m_surfaces.size());
+    for (uint32_t i = 0; i < m_surfaceOrder.size(); i++) {
+        m_surfaceOrder[i] = i;
+    }
+    if (m_surfaces.empty()) return;
+
+    // A binary tree over n leaves never needs more than 2n - 1 nodes
+    m_nodes.reserve(m_surfaces.size() * 2);
+    m_nodes.push_back(BVHNode());
+    BuildNode(0, 0, static_cast<uint32_t>(m_surfaces.size()), 0);
+}
+
+void CyborCollisionWorld::BuildNode(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth) {
+    glm::vec3 boundsMin(1e30f);
+    glm::vec3 boundsMax(-1e30f);
+    glm::vec3 centroidMin(1e30f);
+    glm::vec3 centroidMax(-1e30f);
+    for (uint32_t i = first; i < first + count; i++) {
+        const Surface& surface = m_surfaces[m_surfaceOrder[i]];
+        boundsMin = glm::min(boundsMin, surface.boundsMin);
+        boundsMax = glm::max(boundsMax, surface.boundsMax);
+        glm::vec3 centroid = (surface.boundsMin + surface.boundsMax) * 0.5f;
+        centroidMin = glm::min(centroidMin, centroid);
+        centroidMax = glm::max(centroidMax, centroid);
+    }
+
+    m_nodes[nodeIndex].boundsMin = boundsMin;
+    m_nodes[nodeIndex].boundsMax = boundsMax;
+
+    // Median splits keep the tree about log2(n) deep; the depth cap is a backstop. A stack holds
+    // at most one sibling per level above the node being visited, plus that node's two children.
+    if (count <= BVH_LEAF_SIZE || depth + 2 >= BVH_MAX_DEPTH) {
+        m_nodes[nodeIndex].first = first;
+        m_nodes[nodeIndex].count = count;
+        return;
+    }
+
+    // Median split along the widest centroid axis
+    glm::vec3 extent = centroidMax - centroidMin;
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    uint32_t half = count / 2;
+    std::nth_element(m_surfaceOrder.begin() + first, m_surfaceOrder.begin() + first + half,
+                     m_surfaceOrder.begin() + first + count,
+        [this, axis](uint32_t a, uint32_t b) {
+            return m_surfaces[a].boundsMin[axis] + m_surfaces[a].boundsMax[axis] <
+                   m_surfaces[b].boundsMin[axis] + m_surfaces[b].boundsMax[axis];
+        });
+
+    uint32_t leftChild = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(BVHNode());
+    m_nodes.push_back(BVHNode());
+    m_nodes[nodeIndex].first = leftChild;
+    m_nodes[nodeIndex].count = 0;
+
+    BuildNode(leftChild, first, half, depth + 1);
+    BuildNode(leftChild + 1, first + half, count - half, depth + 1);
+}
+
+size_t CyborCollisionWorld::TraceAll(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                                     const EntityHitbox* entities, size_t entityCount,
+                                     std::vector<TraceHit>& outHits) const {
+    outHits.clear();
+
+    glm::vec3 inverseDirection(
+        direction.x != 0.0f ? 1.0f / direction.x : 1e30f,
+        direction.y != 0.0f ? 1.0f / direction.y : 1e30f,
+        direction.z != 0.0f ? 1.0f / direction.z : 1e30f
+    );
+
+    // Single traversal, collecting every surface instead of stopping at the closest
+    if (!m_nodes.empty()) {
+        uint32_t stack[BVH_MAX_DEPTH];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const BVHNode& node = m_nodes[stack[--stackSize]];
+            float enter, exit;
+            if (!IntersectBox(node.boundsMin, node.boundsMax, origin, inverseDirection, maxDistance, enter, exit)) {
+                continue;
+            }
+
+            if (node.count == 0) {
+                stack[stackSize++] = node.first;
+                stack[stackSize++] = node.first + 1;
+                continue;
+            }
+
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                const Surface& surface = m_surfaces[m_surfaceOrder[i]];
+                if (IntersectBox(surface.boundsMin, surface.boundsMax, origin, inverseDirection, maxDistance, enter, exit)) {
+                    float start = std::max(enter, 0.0f);
+                    outHits.push_back({ start, exit - start, origin + direction * start, NO_ENTITY, surface.material });
+                }
+            }
+        }
+    }
+
+    // Entity hit spheres in the same query
+    for (size_t i = 0; i < entityCount; i++) {
+        glm::vec3 toCenter = entities[i].center - origin;
+        float projection = glm::dot(toCenter, direction);
+        float distanceSq = glm::dot(toCenter, toCenter) - projection * projection;
+        float radiusSq = entities[i].radius * entities[i].radius;
+        if (distanceSq > radiusSq) continue;
+
+        float halfChord = std::sqrt(radiusSq - distanceSq);
+        float enter = std::max(projection - halfChord, 0.0f);
+        float exit = projection + halfChord;
+        if (exit < 0.0f || enter > maxDistance) continue;
+
+        outHits.push_back({ enter, exit - enter, origin + direction * enter, entities[i].entityId, SurfaceMaterial::FLESH });
+    }
+
+    std::sort(outHits.begin(), outHits.end(),
+        [](const TraceHit& a, const TraceHit& b) { return a.distance < b.distance; });
+    return outHits.size();
+}
+
+void CyborCollisionWorld::TestOcclusion(const glm::vec3& origin, const glm::vec3* targets, size_t count,
+                                        uint8_t* outBlocked) const {
+    struct PacketEntry {
+        uint32_t node;
+        uint64_t mask;
+    };
+
+    // Rays travel in packets of 64 that share one traversal; each node is only
+    // tested against the rays that reached it and are still unblocked
+    for (size_t base = 0; base < count; base += 64) {
+        const size_t packetSize = std::min<size_t>(64, count - base);
+        uint64_t pending = packetSize == 64 ? ~0ull : ((1ull << packetSize) - 1);
+
+        glm::vec3 inverseDirection[64];
+        for (size_t i = 0; i < packetSize; i++) {
+            // Unnormalized direction, the target sits at t = 1
+            glm::vec3 direction = targets[base + i] - origin;
+            inverseDirection[i] = glm::vec3(
+                direction.x != 0.0f ? 1.0f / direction.x : 1e30f,
+                direction.y != 0.0f ? 1.0f / direction.y : 1e30f,
+                direction.z != 0.0f ? 1.0f / direction.z : 1e30f
+            );
+            outBlocked[base + i] = 0;
+        }
+        if (m_nodes.empty()) continue;
+
+        PacketEntry stack[BVH_MAX_DEPTH];
+        int stackSize = 0;
+        stack[stackSize++] = { 0, pending };
+
+        while (stackSize > 0 && pending != 0) {
+            PacketEntry entry = stack[--stackSize];
+            uint64_t mask = entry.mask & pending;
+            if (mask == 0) continue;
+
+            const BVHNode& node = m_nodes[entry.node];
+            uint64_t hitMask = 0;
+            float enter, exit;
+            for (size_t i = 0; i < packetSize; i++) {
+                uint64_t bit = 1ull << i;
+                if ((mask & bit) &&
+                    IntersectBox(node.boundsMin, node.boundsMax, origin, inverseDirection[i], 1.0f, enter, exit)) {
+                    hitMask |= bit;
+                }
+            }
+            if (hitMask == 0) continue;
+
+            if (node.count == 0) {
+                stack[stackSize++] = { node.first, hitMask };
+                stack[stackSize++] = { node.first + 1, hitMask };
+                continue;
+            }
+
+            for (uint32_t s = node.first; s < node.first + node.count; s++) {
+                const Surface& surface = m_surfaces[m_surfaceOrder[s]];
+                for (size_t i = 0; i < packetSize; i++) {
+                    uint64_t bit = 1ull << i;
+                    if ((hitMask & pending & bit) &&
+                        IntersectBox(surface.boundsMin, surface.boundsMax, origin, inverseDirection[i], 1.0f, enter, exit)) {
+                        pending &= ~bit;
+                        outBlocked[base + i] = 1;
+                    }
+                }
+            }
+        }
+    }
+}
+
+float CyborCollisionWorld::GetMaterialResistance(SurfaceMaterial material) {
+    switch (material) {
+        case SurfaceMaterial::CONCRETE:    return 1.5f;
+        case SurfaceMaterial::METAL:       return 2.0f;
+        case SurfaceMaterial::WOOD:        return 0.5f;
+        case SurfaceMaterial::GLASS:       return 0.2f;
+        case SurfaceMaterial::CYBOR_ALLOY: return 3.0f;
+        case SurfaceMaterial::FLESH:       return 0.4f;
+    }
+    return 1.0f;
+}
+
+bool CyborCollisionWorld::IntersectBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                                       const glm::vec3& origin, const glm::vec3& inverseDirection,
+                                       float maxDistance, float& outEnter, float& outExit) {
+    float tx1 = (boundsMin.x - origin.x) * inverseDirection.x;
+    float tx2 = (boundsMax.x - origin.x) * inverseDirection.x;
+    float enter = std::min(tx1, tx2);
+    float exit = std::max(tx1, tx2);
+
+    float ty1 = (boundsMin.y - origin.y) * inverseDirection.y;
+    float ty2 = (boundsMax.y - origin.y) * inverseDirection.y;
+    enter = std::max(enter, std::min(ty1, ty2));
+    exit = std::min(exit, std::max(ty1, ty2));
+
+    float tz1 = (boundsMin.z - origin.z) * inverseDirection.z;
+    float tz2 = (boundsMax.z - origin.z) * inverseDirection.z;
+    enter = std::max(enter, std::min(tz1, tz2));
+    exit = std::min(exit, std::max(tz1, tz2));
+
+    outEnter = enter;
+    outExit = exit;
+    return exit >= std::max(enter, 0.0f) && enter <= maxDistance;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+/*
+ * CyborCollisionWorld - Static level collision with a bounding volume hierarchy
+ * Answers all-hits ray queries for bullet penetration: every surface and entity
+ * along the ray, in order, from a single traversal
+ */
+class CyborCollisionWorld {
+public:
+    enum class SurfaceMaterial : uint8_t {
+        CONCRETE,
+        METAL,
+        WOOD,
+        GLASS,
+        CYBOR_ALLOY,
+        FLESH
+    };
+
+    struct EntityHitbox {
+        uint32_t entityId;
+        glm::vec3 center;
+        float radius;
+    };
+
+    struct TraceHit {
+        float distance;   // Where the ray enters
+        float thickness;  // Distance travelled inside before exiting
+        glm::vec3 point;
+        uint32_t entityId; // NO_ENTITY for level surfaces
+        SurfaceMaterial material;
+
+        bool IsEntity() const { return entityId != NO_ENTITY; }
+    };
+
+    static constexpr uint32_t NO_ENTITY = 0xFFFFFFFFu;
+
+public:
+    CyborCollisionWorld();
+    ~CyborCollisionWorld();
+
+    // Level geometry, rebuilt when a map loads
+    void Clear();
+    void AddSurface(const glm::vec3& boundsMin, const glm::vec3& boundsMax, SurfaceMaterial material);
+    void Build();
+    size_t GetSurfaceCount() const { return m_surfaces.size(); }
+
+    // All surfaces and entities hit within maxDistance, sorted front to back
+    size_t TraceAll(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                    const EntityHitbox* entities, size_t entityCount,
+                    std::vector<TraceHit>& outHits) const;
+
+    // Batched line-of-sight from one origin to many targets; outBlocked[i] is set
+    // to 1 when level geometry lies between origin and targets[i]
+    void TestOcclusion(const glm::vec3& origin, const glm::vec3* targets, size_t count,
+                       uint8_t* outBlocked) const;
+
+    // Damage lost per unit of thickness, relative to a weapon's penetration power
+    static float GetMaterialResistance(SurfaceMaterial material);
+
+private:
+    struct Surface {
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        SurfaceMaterial material;
+    };
+
+    // Interior nodes have count == 0 and children at first and first + 1
+    struct BVHNode {
+        glm::vec3 boundsMin;
+        uint32_t first;
+        glm::vec3 boundsMax;
+        uint32_t count;
+    };
+
+    std::vector<Surface> m_surfaces;
+    std::vector<uint32_t> m_surfaceOrder;
+    std::vector<BVHNode> m_nodes;
+
+    // Private methods
+    void BuildNode(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth);
+    static bool IntersectBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                             const glm::vec3& origin, const glm::vec3& inverseDirection,
+                             float maxDistance, float& outEnter, float& outExit);
+};
@@ -0,0 +1,118 @@
+#include "CyborDamageSystem.h"
+#include <algorithm>
+
+CyborDamageSystem::CyborDamageSystem()
+    : m_nextSequence(0) {
+    m_events.reserve(256);
+}
+
+CyborDamageSystem::~CyborDamageSystem() {
+}
+
+void CyborDamageSystem::QueueDamage(uint32_t targetId, uint32_t attackerId, float damage,
+                                    const glm::vec3& hitDirection, CyborWeapon::WeaponType weaponType) {
+    if (damage <= 0.0f || targetId == INVALID_ENTITY) return;
+
+    m_events.push_back({ targetId, attackerId, damage, hitDirection, weaponType, m_nextSequence++ });
+}
+
+const std::vector<uint32_t>& CyborDamageSystem::BeginResolve() {
+    m_targetIds.clear();
+    m_firstEvent.clear();
+    m_eventCount.clear();
+    m_totalDamage.clear();
+
+    // Group by target, keeping submission order inside each target
+    std::sort(m_events.begin(), m_events.end(),
+        [](const DamageEvent& a, const DamageEvent& b) {
+            return a.targetId != b.targetId ? a.targetId < b.targetId : a.sequence < b.sequence;
+        });
+
+    // Collapse each run into one entry per target
+    for (size_t i = 0; i < m_events.size(); ) {
+        size_t runEnd = i;
+        float total = 0.0f;
+        while (runEnd < m_events.size() && m_events[runEnd].targetId == m_events[i].targetId) {
+            total += m_events[runEnd].damage;
+            runEnd++;
+        }
+
+        m_targetIds.push_back(m_events[i].targetId);
+        m_firstEvent.push_back(static_cast<uint32_t>(i));
+        m_eventCount.push_back(static_cast<uint32_t>(runEnd - i));
+        m_totalDamage.push_back(total);
+        i = runEnd;
+    }
+
+    m_health.assign(m_targetIds.size(), 0.0f);
+    m_armor.assign(m_targetIds.size(), 0.0f);
+    return m_targetIds;
+}
+
+void CyborDamageSystem::ApplyDamage() {
+    const size_t count = m_targetIds.size();
+    m_healthBefore.assign(m_health.begin(), m_health.end());
+    m_armorBefore.assign(m_armor.begin(), m_armor.end());
+
+    float* health = m_health.data();
+    float* armor = m_armor.data();
+    const float* total = m_totalDamage.data();
+
+    // Armor soaks a fixed share of every hit until it runs out, so absorbing the
+    // summed damage once is identical to absorbing each hit in turn. The loop is
+    // branch-free and vectorizes; targets that were already dead take nothing.
+    for (size_t i = 0; i < count; i++) {
+        float damage = health[i] > 0.0f ? total[i] : 0.0f;
+        float absorbed = std::min(armor[i], damage * ARMOR_ABSORPTION);
+        armor[i] -= absorbed;
+        health[i] -= damage - absorbed;
+    }
+
+    // Bookkeeping pass, cold compared to the math above
+    m_hits.clear();
+    m_kills.clear();
+    for (size_t i = 0; i < count; i++) {
+        if (m_healthBefore[i] <= 0.0f) continue;
+
+        const DamageEvent& last = m_events[m_firstEvent[i] + m_eventCount[i] - 1];
+        m_hits.push_back({ m_targetIds[i], last.attackerId, m_totalDamage[i] });
+
+        if (health[i] <= 0.0f) {
+            ResolveKiller(i);
+        }
+    }
+}
+
+void CyborDamageSystem::ResolveKiller(size_t targetIndex) {
+    // Replay this target's hits in order to credit the one that crossed zero
+    float health = m_healthBefore[targetIndex];
+    float armor = m_armorBefore[targetIndex];
+
+    const uint32_t first = m_firstEvent[targetIndex];
+    const uint32_t last = first + m_eventCount[targetIndex];
+    for (uint32_t e = first; e < last; e++) {
+        const DamageEvent& event = m_events[e];
+        AbsorbDamage(health, armor, event.damage);
+
+        if (health <= 0.0f || e + 1 == last) {
+            m_kills.push_back({ event.targetId, event.attackerId, event.weaponType, event.hitDirection });
+            return;
+        }
+    }
+}
+
+void CyborDamageSystem::EndResolve() {
+    m_events.clear();
+    m_hits.clear();
+    m_kills.clear();
+    m_nextSequence = 0;
+}
+
+float CyborDamageSystem::AbsorbDamage(float& health, float& armor, float damage) {
+    float armorAbsorption = std::min(armor, damage * ARMOR_ABSORPTION);
+    armor -= armorAbsorption;
+
+    float damageToHealth = damage - armorAbsorption;
+    health -= damageToHealth;
+    return damageToHealth;
+}
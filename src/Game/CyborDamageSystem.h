@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "CyborWeapon.h"
+
+/*
+ * CyborDamageSystem - Per-tick damage event pipeline
+ * Hits from players, bots and explosions are queued as events and resolved
+ * once per tick in a single pass sorted by target id
+ */
+class CyborDamageSystem {
+public:
+    static constexpr uint32_t INVALID_ENTITY = 0xFFFFFFFFu;
+
+    struct DamageEvent {
+        uint32_t targetId;
+        uint32_t attackerId;
+        float damage;
+        glm::vec3 hitDirection;
+        CyborWeapon::WeaponType weaponType;
+        uint32_t sequence; // Submission order within the tick
+    };
+
+    // One entry per damaged target, for hit markers and impact audio
+    struct HitEvent {
+        uint32_t targetId;
+        uint32_t attackerId; // Attacker of the last hit this tick
+        float damage;
+    };
+
+    struct KillEvent {
+        uint32_t victimId;
+        uint32_t killerId;
+        CyborWeapon::WeaponType weaponType;
+        glm::vec3 hitDirection;
+    };
+
+public:
+    CyborDamageSystem();
+    ~CyborDamageSystem();
+
+    // Event collection
+    void QueueDamage(uint32_t targetId, uint32_t attackerId, float damage,
+                     const glm::vec3& hitDirection, CyborWeapon::WeaponType weaponType);
+    bool HasPendingDamage() const { return !m_events.empty(); }
+    size_t GetPendingCount() const { return m_events.size(); }
+
+    // Resolution, driven by the game manager once per tick:
+    //   1. BeginResolve() sorts the events and returns the ascending target ids
+    //   2. the caller fills GetHealth()/GetArmor() for every returned id
+    //   3. ApplyDamage() runs the armor/health math over the whole batch
+    //   4. the caller writes health/armor back and consumes GetHits()/GetKills()
+    //   5. EndResolve() clears the tick
+    const std::vector<uint32_t>& BeginResolve();
+    float* GetHealth() { return m_health.data(); }
+    float* GetArmor() { return m_armor.data(); }
+    void ApplyDamage();
+    const std::vector<HitEvent>& GetHits() const { return m_hits; }
+    const std::vector<KillEvent>& GetKills() const { return m_kills; }
+    void EndResolve();
+
+    // Shared armor math for a single hit, returns the damage dealt to health
+    static float AbsorbDamage(float& health, float& armor, float damage);
+
+    // Fraction of incoming damage that armor can soak up
+    static constexpr float ARMOR_ABSORPTION = 0.5f;
+
+private:
+    std::vector<DamageEvent> m_events;
+    uint32_t m_nextSequence;
+
+    // Per-target batch, parallel arrays indexed like m_targetIds
+    std::vector<uint32_t> m_targetIds;
+    std::vector<uint32_t> m_firstEvent;
+    std::vector<uint32_t> m_eventCount;
+    std::vector<float> m_totalDamage;
+    std::vector<float> m_health;
+    std::vector<float> m_armor;
+    std::vector<float> m_healthBefore;
+    std::vector<float> m_armorBefore;
+
+    // Output of the tick
+    std::vector<HitEvent> m_hits;
+    std::vector<KillEvent> m_kills;
+
+    // Private methods
+    void ResolveKiller(size_t targetIndex);
+};
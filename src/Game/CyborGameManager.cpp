@@ -1,13 +1,37 @@
 #include "CyborGameManager.h"
+#include "../Audio/CyborAudioSystem.h"
+#include "../Network/CyborNetworkManager.h"
 #include <iostream>
 #include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+// Hit sphere used for player and bot hit registration
+static const float ENTITY_HIT_RADIUS = 0.75f;
+
+// Seconds between a grenade leaving the hand and detonating
+static const float GRENADE_FUSE_TIME = 1.5f;
+
+// Bots closer than this to the player always think every tick
+static const float AI_DETAIL_DISTANCE = 24.0f;
+
+// Sound priorities; the mixer keeps the most audible sounds, weighed by these, when a firefight starts more
+static const float GUNFIRE_SOUND_PRIORITY = 1.0f;
+static const float IMPACT_SOUND_PRIORITY = 0.5f;
+static const float ELIMINATION_SOUND_PRIORITY = 2.0f;
+static const float GUNFIRE_AUDIBLE_DISTANCE = 150.0f;
+static const float HIT_AUDIBLE_DISTANCE = 100.0f;
 
 CyborGameManager::CyborGameManager(CyborEngine* engine) 
-    : m_engine(engine), m_gameState(GameState::MENU),
+    : m_engine(engine), m_gameState(GameState::MENU), m_initialized(false),
+      m_audioSystem(nullptr), m_networkManager(nullptr), m_aiDetailLevel(0), m_botTick(0),
+      m_nextEntityId(PLAYER_ENTITY_ID + 1), m_remoteRenderTimer(0.0f),
       m_currentMission(0), m_totalMissions(5),
       m_playerScore(0), m_enemiesKilled(0), m_matchTime(0.0f), m_roundTime(0.0f),
-      m_playerTeam(Team::CYBOR_COUNTER_TERRORISTS),
+      m_playerTeam(Team::CYBOR_COUNTER_TERRORISTS), m_hudUpdateTimer(0.0f),
       m_cyborTacticalMode(false), m_cyborAIIntelligence(1.0f) {
+    // No level until a map loads
+    m_collisionWorld = std::make_shared<const CyborCollisionWorld>();
 }
 
 CyborGameManager::~CyborGameManager() {
@@ -30,6 +54,7 @@ bool CyborGameManager::Initialize() {
     // Set initial game state
     m_gameState = GameState::MENU;
 
+    m_initialized = true;
     std::cout << "Cybor Game Manager initialized successfully!" << std::endl;
     return true;
 }
@@ -51,10 +76,13 @@ void CyborGameManager::InitializeCampaign() {
 }
 
 void CyborGameManager::Update(float deltaTime) {
+    ProcessGameEvents();
+    UpdateRemotePlayers();
+
     switch (m_gameState) {
         case GameState::MENU:
             // Handle menu input
-            if (m_engine->IsKeyPressed(GLFW_KEY_ENTER)) {
+            if (IsKeyPressed(GLFW_KEY_ENTER)) {
                 StartCampaign();
             }
             break;
@@ -69,13 +97,13 @@ void CyborGameManager::Update(float deltaTime) {
             break;
 
         case GameState::PAUSED:
-            if (m_engine->IsKeyPressed(GLFW_KEY_P)) {
+            if (IsKeyPressed(GLFW_KEY_P)) {
                 SetGameState(GameState::PLAYING);
             }
             break;
 
         case GameState::GAME_OVER:
-            if (m_engine->IsKeyPressed(GLFW_KEY_R)) {
+            if (IsKeyPressed(GLFW_KEY_R)) {
                 RestartMatch();
             }
             break;
@@ -96,7 +124,7 @@ void CyborGameManager::ProcessGameLogic(float deltaTime) {
     m_roundTime += deltaTime;
 
     // Handle pause
-    if (m_engine->IsKeyPressed(GLFW_KEY_P)) {
+    if (IsKeyPressed(GLFW_KEY_P)) {
         SetGameState(GameState::PAUSED);
         return;
     }
@@ -104,17 +132,24 @@ void CyborGameManager::ProcessGameLogic(float deltaTime) {
     // Update player
     if (m_player) {
         m_player->Update(deltaTime, m_engine);
-
-        // Check if player died
-        if (!m_player->IsAlive()) {
-            EndMatch(Team::CYBOR_TERRORISTS);
-            return;
-        }
     }
 
     // Update bots
     UpdateBots(deltaTime);
 
+    // Register this tick's shots and apply the resulting damage in one pass
+    RecordHitboxHistory();
+    UpdateSpatialGrid();
+    ProcessShots();
+    ProcessExplosions();
+    ResolveDamage();
+
+    // Check if player died
+    if (m_player && !m_player->IsAlive()) {
+        EndMatch(Team::CYBOR_TERRORISTS);
+        return;
+    }
+
     // Update current map
     if (m_currentMap) {
         // Map-specific logic would go here
@@ -128,9 +163,21 @@ void CyborGameManager::ProcessGameLogic(float deltaTime) {
 }
 
 void CyborGameManager::UpdateBots(float deltaTime) {
+    // Far bots take turns, staggered by entity id so each tick does a similar share
+    const uint32_t thinkMask = (1u << m_aiDetailLevel) - 1;
+    const float nearDistanceSq = AI_DETAIL_DISTANCE * AI_DETAIL_DISTANCE;
+    m_botTick++;
+
     for (auto& bot : m_bots) {
         if (bot && bot->IsAlive()) {
             glm::vec3 playerPos = m_player ? m_player->GetPosition() : glm::vec3(0);
+            if (((bot->GetEntityId() + m_botTick) & thinkMask) != 0) {
+                const glm::vec3 offset = bot->GetPosition() - playerPos;
+                if (glm::dot(offset, offset) > nearDistanceSq) {
+                    bot->SkipUpdate(deltaTime);
+                    continue;
+                }
+            }
             bot->Update(deltaTime, playerPos);
 
             // Check if bot can see and should attack player
@@ -150,6 +197,469 @@ void CyborGameManager::UpdateBots(float deltaTime) {
     );
 }
 
+void CyborGameManager::QueueDamage(uint32_t targetId, uint32_t attackerId, float damage,
+                                   const glm::vec3& hitDirection, CyborWeapon::WeaponType weaponType) {
+    m_damageSystem.QueueDamage(targetId, attackerId, damage, hitDirection, weaponType);
+}
+
+void CyborGameManager::QueueRemoteShot(const CyborWeapon::ShotInfo& shot, uint32_t shooterId,
+                                      CyborBot::Team shooterTeam, float viewTime) {
+    m_remoteShots.push_back({ shot, shooterId, shooterTeam, viewTime });
+}
+
+void CyborGameManager::RecordHitboxHistory() {
+    CyborBot::Team playerTeam = (m_playerTeam == Team::CYBOR_TERRORISTS) ?
+        CyborBot::Team::TERRORIST : CyborBot::Team::COUNTER_TERRORIST;
+
+    // Player first, then bots in their (ascending) id order
+    m_lagCompensation.BeginTick(m_matchTime);
+    if (m_player && m_player->IsAlive()) {
+        m_lagCompensation.AddEntity(PLAYER_ENTITY_ID, m_player->GetPosition(), (uint8_t)playerTeam);
+    }
+    for (const auto& bot : m_bots) {
+        if (bot->IsAlive()) {
+            m_lagCompensation.AddEntity(bot->GetEntityId(), bot->GetPosition(), (uint8_t)bot->GetTeam());
+        }
+    }
+    m_lagCompensation.EndTick();
+}
+
+void CyborGameManager::UpdateSpatialGrid() {
+    CyborBot::Team playerTeam = (m_playerTeam == Team::CYBOR_TERRORISTS) ?
+        CyborBot::Team::TERRORIST : CyborBot::Team::COUNTER_TERRORIST;
+
+    m_spatialGrid.Clear();
+    if (m_player && m_player->IsAlive()) {
+        m_spatialGrid.Insert(PLAYER_ENTITY_ID, m_player->GetPosition(), (uint8_t)playerTeam);
+    }
+    for (const auto& bot : m_bots) {
+        if (bot->IsAlive()) {
+            m_spatialGrid.Insert(bot->GetEntityId(), bot->GetPosition(), (uint8_t)bot->GetTeam());
+        }
+    }
+    m_spatialGrid.Build();
+}
+
+void CyborGameManager::ProcessShots() {
+    CyborBot::Team playerTeam = (m_playerTeam == Team::CYBOR_TERRORISTS) ?
+        CyborBot::Team::TERRORIST : CyborBot::Team::COUNTER_TERRORIST;
+
+    for (const auto& remote : m_remoteShots) {
+        TraceShot(remote.shot, remote.shooterId, remote.shooterTeam, remote.viewTime);
+    }
+    m_remoteShots.clear();
+
+    // Connected, the server registers the player's shots too
+    const bool connected = m_networkManager && m_networkManager->IsConnected();
+    if (m_player) {
+        auto& shots = m_player->GetPendingShots();
+        for (const auto& shot : shots) {
+            if (connected) m_networkManager->SendWeaponFire(shot.origin, shot.direction);
+            TraceShot(shot, PLAYER_ENTITY_ID, playerTeam, m_matchTime);
+        }
+        shots.clear();
+    }
+
+    for (auto& bot : m_bots) {
+        auto& shots = bot->GetPendingShots();
+        for (const auto& shot : shots) {
+            TraceShot(shot, bot->GetEntityId(), bot->GetTeam(), m_matchTime);
+        }
+        shots.clear();
+    }
+}
+
+void CyborGameManager::TraceShot(const CyborWeapon::ShotInfo& shot, uint32_t shooterId,
+                                 CyborBot::Team shooterTeam, float viewTime) {
+    CyborBot::Team playerTeam = (m_playerTeam == Team::CYBOR_TERRORISTS) ?
+        CyborBot::Team::TERRORIST : CyborBot::Team::COUNTER_TERRORIST;
+
+    // Thrown explosives travel instead of hitting instantly
+    if (shot.blastRadius > 0.0f) {
+        ThrowGrenade(shot, shooterId, shooterTeam);
+        return;
+    }
+
+    // Every shot is heard; with many bots firing most of these stay virtual
+    if (m_audioSystem) {
+        m_audioSystem->PlaySound3D("weapon_fire", shot.origin, 1.0f, GUNFIRE_AUDIBLE_DISTANCE, GUNFIRE_SOUND_PRIORITY);
+    }
+
+    // Opposing entities only (no friendly fire), rewound to the shooter's view
+    // time when the shooter is lagged
+    m_traceEntities.clear();
+    if (viewTime < m_lagCompensation.GetNewestTime()) {
+        m_lagCompensation.RewindAlongRay(viewTime, shot.origin, shot.direction, shot.range,
+                                         ENTITY_HIT_RADIUS, m_rewoundHitboxes);
+        for (const auto& hitbox : m_rewoundHitboxes) {
+            if (hitbox.entityId == shooterId || hitbox.team == (uint8_t)shooterTeam) continue;
+            m_traceEntities.push_back({ hitbox.entityId, hitbox.center, ENTITY_HIT_RADIUS });
+        }
+    } else {
+        if (m_player && m_player->IsAlive() && shooterId != PLAYER_ENTITY_ID && shooterTeam != playerTeam) {
+            m_traceEntities.push_back({ PLAYER_ENTITY_ID, m_player->GetPosition(), ENTITY_HIT_RADIUS });
+        }
+        for (const auto& bot : m_bots) {
+            if (!bot->IsAlive() || bot->GetEntityId() == shooterId || bot->GetTeam() == shooterTeam) continue;
+            m_traceEntities.push_back({ bot->GetEntityId(), bot->GetPosition(), ENTITY_HIT_RADIUS });
+        }
+    }
+
+    m_collisionWorld->TraceAll(shot.origin, shot.direction, shot.range,
+                              m_traceEntities.data(), m_traceEntities.size(), m_traceHits);
+
+    // Walk the hits front to back: every surface or body drains penetration
+    // power by resistance * thickness, and damage falls off with it
+    float power = shot.penetrationPower;
+    float damage = shot.damage;
+    for (const auto& hit : m_traceHits) {
+        if (hit.IsEntity()) {
+            QueueDamage(hit.entityId, shooterId, damage, shot.direction, shot.weaponType);
+        }
+
+        float cost = CyborCollisionWorld::GetMaterialResistance(hit.material) * hit.thickness;
+        if (cost >= power) break;
+
+        damage *= (power - cost) / power;
+        power -= cost;
+    }
+}
+
+void CyborGameManager::ThrowGrenade(const CyborWeapon::ShotInfo& shot, uint32_t throwerId, CyborBot::Team throwerTeam) {
+    // Lands just short of the first surface in the throw direction, or at full range
+    float distance = shot.range;
+    m_collisionWorld->TraceAll(shot.origin, shot.direction, shot.range, nullptr, 0, m_traceHits);
+    if (!m_traceHits.empty()) {
+        distance = std::max(0.0f, m_traceHits.front().distance - 0.2f);
+    }
+
+    Explosion explosion = { shot.origin + shot.direction * distance, shot.blastRadius, shot.damage,
+                            throwerId, throwerTeam, shot.weaponType };
+    m_thrownGrenades.push_back({ explosion, m_matchTime + GRENADE_FUSE_TIME });
+}
+
+void CyborGameManager::QueueExplosion(const glm::vec3& center, float radius, float damage, uint32_t attackerId,
+                                      CyborBot::Team attackerTeam, CyborWeapon::WeaponType weaponType) {
+    m_explosions.push_back({ center, radius, damage, attackerId, attackerTeam, weaponType });
+}
+
+void CyborGameManager::ProcessExplosions() {
+    // Detonate grenades whose fuse ran out
+    for (size_t i = 0; i < m_thrownGrenades.size(); ) {
+        if (m_thrownGrenades[i].detonateTime <= m_matchTime) {
+            m_explosions.push_back(m_thrownGrenades[i].explosion);
+            m_thrownGrenades[i] = m_thrownGrenades.back();
+            m_thrownGrenades.pop_back();
+        } else {
+            i++;
+        }
+    }
+
+    for (const auto& explosion : m_explosions) {
+        // Candidates from the grid: the thrower and the opposing side
+        m_blastCandidates.clear();
+        m_spatialGrid.QueryRadius(explosion.center, explosion.radius, m_blastCandidates);
+        m_blastCandidates.erase(
+            std::remove_if(m_blastCandidates.begin(), m_blastCandidates.end(),
+                [&explosion](const CyborSpatialGrid::Entry& entry) {
+                    return entry.entityId != explosion.attackerId && entry.tag == (uint8_t)explosion.attackerTeam;
+                }),
+            m_blastCandidates.end()
+        );
+        if (m_blastCandidates.empty()) continue;
+
+        // One batched line-of-sight query from the blast center
+        m_blastTargets.clear();
+        for (const auto& candidate : m_blastCandidates) {
+            m_blastTargets.push_back(candidate.position);
+        }
+        m_blastOccluded.resize(m_blastTargets.size());
+        m_collisionWorld->TestOcclusion(explosion.center, m_blastTargets.data(), m_blastTargets.size(),
+                                       m_blastOccluded.data());
+
+        for (size_t i = 0; i < m_blastCandidates.size(); i++) {
+            if (m_blastOccluded[i]) continue;
+
+            glm::vec3 offset = m_blastCandidates[i].position - explosion.center;
+            float distance = glm::length(offset);
+            float damage = explosion.damage * (1.0f - distance / explosion.radius);
+            glm::vec3 direction = distance > 0.0f ? offset / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+
+            QueueDamage(m_blastCandidates[i].entityId, explosion.attackerId, damage, direction, explosion.weaponType);
+        }
+    }
+    m_explosions.clear();
+}
+
+std::shared_ptr<const CyborCollisionWorld> CyborGameManager::LoadMapGeometry(const std::string& mapName) {
+    using Material = CyborCollisionWorld::SurfaceMaterial;
+
+    // One copy per map for the whole process, kept while any match plays on it
+    static std::mutex cacheMutex;
+    static std::unordered_map<std::string, std::weak_ptr<const CyborCollisionWorld>> cache;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::weak_ptr<const CyborCollisionWorld>& cached = cache[mapName];
+    if (std::shared_ptr<const CyborCollisionWorld> world = cached.lock()) return world;
+
+    // Blockout collision shared by the campaign maps: perimeter walls and central cover
+    auto collisionWorld = std::make_shared<CyborCollisionWorld>();
+    collisionWorld->AddSurface(glm::vec3(-41.0f, 0.0f, -41.0f), glm::vec3(41.0f, 6.0f, -40.0f), Material::CONCRETE);
+    collisionWorld->AddSurface(glm::vec3(-41.0f, 0.0f, 40.0f), glm::vec3(41.0f, 6.0f, 41.0f), Material::CONCRETE);
+    collisionWorld->AddSurface(glm::vec3(-41.0f, 0.0f, -40.0f), glm::vec3(-40.0f, 6.0f, 40.0f), Material::CONCRETE);
+    collisionWorld->AddSurface(glm::vec3(40.0f, 0.0f, -40.0f), glm::vec3(41.0f, 6.0f, 40.0f), Material::CONCRETE);
+
+    collisionWorld->AddSurface(glm::vec3(4.0f, 0.0f, 4.0f), glm::vec3(5.5f, 1.5f, 5.5f), Material::WOOD);
+    collisionWorld->AddSurface(glm::vec3(-6.0f, 0.0f, 3.0f), glm::vec3(-4.5f, 1.5f, 4.5f), Material::WOOD);
+    collisionWorld->AddSurface(glm::vec3(-3.0f, 0.0f, -8.0f), glm::vec3(3.0f, 2.6f, -5.5f), Material::METAL);
+    collisionWorld->AddSurface(glm::vec3(12.0f, 0.0f, -2.0f), glm::vec3(12.3f, 3.0f, 2.0f), Material::CONCRETE);
+    collisionWorld->AddSurface(glm::vec3(12.0f, 3.0f, -2.0f), glm::vec3(12.1f, 4.0f, 2.0f), Material::GLASS);
+    collisionWorld->AddSurface(glm::vec3(-15.0f, 0.0f, -15.0f), glm::vec3(-13.0f, 3.0f, -13.0f), Material::CYBOR_ALLOY);
+    collisionWorld->Build();
+
+    cached = collisionWorld;
+    return collisionWorld;
+}
+
+void CyborGameManager::ResolveDamage() {
+    if (!m_damageSystem.HasPendingDamage()) return;
+
+    const std::vector<uint32_t>& targetIds = m_damageSystem.BeginResolve();
+    float* health = m_damageSystem.GetHealth();
+    float* armor = m_damageSystem.GetArmor();
+
+    // Bots get increasing ids at spawn and removal keeps their order, so
+    // matching them to the sorted target ids is a single merge
+    m_damageTargets.assign(targetIds.size(), nullptr);
+    size_t botIndex = 0;
+    for (size_t i = 0; i < targetIds.size(); i++) {
+        if (targetIds[i] == PLAYER_ENTITY_ID) {
+            if (m_player) {
+                health[i] = m_player->GetHealth();
+                armor[i] = m_player->GetArmor();
+            }
+            continue;
+        }
+
+        while (botIndex < m_bots.size() && m_bots[botIndex]->GetEntityId() < targetIds[i]) {
+            botIndex++;
+        }
+        if (botIndex < m_bots.size() && m_bots[botIndex]->GetEntityId() == targetIds[i]) {
+            m_damageTargets[i] = m_bots[botIndex].get();
+            health[i] = m_damageTargets[i]->GetHealth();
+            armor[i] = m_damageTargets[i]->GetArmor();
+        }
+    }
+
+    m_damageSystem.ApplyDamage();
+
+    for (size_t i = 0; i < targetIds.size(); i++) {
+        if (m_damageTargets[i]) {
+            m_damageTargets[i]->ApplyDamageResult(health[i], armor[i]);
+        } else if (targetIds[i] == PLAYER_ENTITY_ID && m_player) {
+            m_player->ApplyDamageResult(health[i], armor[i]);
+        }
+    }
+
+    // Kill bookkeeping; every connected client hears about each kill
+    const bool hosting = m_networkManager && m_networkManager->IsServerRunning();
+    for (const auto& kill : m_damageSystem.GetKills()) {
+        if (kill.killerId == PLAYER_ENTITY_ID && kill.victimId != PLAYER_ENTITY_ID && m_player) {
+            m_enemiesKilled++;
+            m_playerScore += 100;
+            m_player->AddKill(300);
+        }
+        if (hosting) {
+            m_networkManager->SendGameEvent({ CyborNetworkManager::GameEvent::Type::KILL, kill.victimId, kill.killerId,
+                                              static_cast<int32_t>(kill.weaponType), "" });
+        }
+    }
+
+    // Impact and elimination audio
+    if (m_audioSystem) {
+        glm::vec3 position;
+        for (const auto& hit : m_damageSystem.GetHits()) {
+            if (GetEntityPosition(hit.targetId, position)) {
+                m_audioSystem->PlaySound3D("bullet_impact", position, 1.0f, HIT_AUDIBLE_DISTANCE, IMPACT_SOUND_PRIORITY);
+            }
+        }
+        for (const auto& kill : m_damageSystem.GetKills()) {
+            if (GetEntityPosition(kill.victimId, position)) {
+                m_audioSystem->PlaySound3D("cybor_elimination", position, 1.0f, HIT_AUDIBLE_DISTANCE,
+                                           ELIMINATION_SOUND_PRIORITY);
+            }
+        }
+    }
+
+    m_damageSystem.EndResolve();
+}
+
+// The server's kills and round ends, in the order it resolved them
+void CyborGameManager::ProcessGameEvents() {
+    if (!m_networkManager || !m_networkManager->IsConnected()) return;
+
+    CyborNetworkManager::GameEvent event;
+    while (m_networkManager->PollGameEvent(event)) {
+        switch (event.type) {
+            case CyborNetworkManager::GameEvent::Type::KILL:
+                std::cout << "[Kill] Entity " << event.instigatorId << " eliminated entity " << event.subjectId
+                          << " (weapon " << event.value << ")" << std::endl;
+                break;
+
+            case CyborNetworkManager::GameEvent::Type::ROUND_END:
+                std::cout << "[Round] Over, winner: "
+                          << (static_cast<Team>(event.value) == Team::CYBOR_TERRORISTS ? "CYBOR TERRORISTS"
+                                                                                       : "CYBOR COUNTER-TERRORISTS")
+                          << std::endl;
+                break;
+
+            default:
+                // Joins and departures are announced by the network manager itself
+                break;
+        }
+    }
+}
+
+// Runs whatever each peer sent since the last tick and answers with the result, which the
+// peer reconciles its prediction against. The result is also where the peer views the world from.
+void CyborGameManager::UpdateRemotePlayers() {
+    if (!m_networkManager || !m_networkManager->IsServerRunning()) {
+        m_remotePlayers.clear();
+        return;
+    }
+
+    // Peers that left take their player with them
+    const CyborNetworkManager::PlayerRoster roster = m_networkManager->GetConnectedPlayers();
+    m_remotePlayers.erase(
+        std::remove_if(m_remotePlayers.begin(), m_remotePlayers.end(),
+            [&roster](const RemotePlayer& remote) {
+                return std::none_of(roster->begin(), roster->end(),
+                    [&remote](const CyborNetworkManager::PlayerInfo& info) { return info.peerId == remote.peerId; });
+            }),
+        m_remotePlayers.end()
+    );
+
+    // Peers join the host's side
+    const CyborBot::Team playerTeam = (m_playerTeam == Team::CYBOR_TERRORISTS) ?
+        CyborBot::Team::TERRORIST : CyborBot::Team::COUNTER_TERRORIST;
+
+    for (const auto& info : *roster) {
+        auto it = std::find_if(m_remotePlayers.begin(), m_remotePlayers.end(),
+            [&info](const RemotePlayer& remote) { return remote.peerId == info.peerId; });
+        if (it == m_remotePlayers.end()) {
+            RemotePlayer remote;
+            remote.peerId = info.peerId;
+            remote.entityId = m_nextEntityId++;
+            remote.team = playerTeam;
+            remote.lastSequence = 0;
+            remote.player = std::make_unique<CyborPlayer>();
+            remote.player->Initialize(glm::vec3(0.0f, 1.8f, 0.0f));
+            remote.player->PickupWeapon(CyborWeapons::CreateM4A1());
+            m_remotePlayers.push_back(std::move(remote));
+            it = m_remotePlayers.end() - 1;
+        }
+        RemotePlayer& remote = *it;
+
+        std::vector<CyborInputCommand>& commands = m_networkManager->GetClientCommands(info.peerId);
+        for (const auto& command : commands) {
+            remote.player->SimulateCommand(command);
+            remote.lastSequence = command.sequence;
+        }
+        if (!commands.empty()) {
+            m_networkManager->SendPlayerState(info.peerId, remote.lastSequence, remote.player->GetMoveState());
+            commands.clear();
+        }
+
+        // Snapshots carry what this peer's player can see; its position is where its camera is
+        m_networkManager->SetClientViewer(info.peerId, remote.entityId, remote.player->GetPosition(),
+                                          static_cast<uint8_t>(remote.team));
+    }
+
+    // Shots fire from the server's player and weapon, which pace them and spend the ammo, and
+    // register against the world as the shooter saw it
+    CyborNetworkManager::RemoteShot received;
+    while (m_networkManager->PollRemoteShot(received)) {
+        if (m_gameState != GameState::PLAYING) continue;
+        auto it = std::find_if(m_remotePlayers.begin(), m_remotePlayers.end(),
+            [&received](const RemotePlayer& remote) { return remote.peerId == received.peerId; });
+        if (it == m_remotePlayers.end() || !it->player->IsAlive()) continue;
+
+        auto weapon = it->player->GetCurrentWeapon();
+        if (!weapon) continue;
+        if (!weapon->HasAmmo(m_matchTime)) weapon->Reload(m_matchTime);
+        CyborWeapon::ShotInfo shot;
+        if (weapon->Fire(it->player->GetPosition(), received.direction, m_matchTime, &shot)) {
+            QueueRemoteShot(shot, it->entityId, it->team, m_matchTime - received.viewAge);
+        }
+    }
+}
+
+void CyborGameManager::GetNetworkEntityStates(std::vector<CyborSnapshotCodec::EntityState>& outStates) const {
+    outStates.clear();
+
+    if (m_player) {
+        CyborSnapshotCodec::EntityState state;
+        state.entityId = PLAYER_ENTITY_ID;
+        state.position = m_player->GetPosition();
+        state.yaw = m_player->GetYaw();
+        state.pitch = m_player->GetPitch();
+        state.health = m_player->GetHealth();
+        state.armor = m_player->GetArmor();
+        auto weapon = m_player->GetCurrentWeapon();
+        state.weaponType = weapon ? static_cast<uint8_t>(weapon->GetType()) : 0;
+        state.team = static_cast<uint8_t>((m_playerTeam == Team::CYBOR_TERRORISTS) ?
+            CyborBot::Team::TERRORIST : CyborBot::Team::COUNTER_TERRORIST);
+        state.alive = m_player->IsAlive();
+        outStates.push_back(state);
+    }
+
+    for (const auto& remote : m_remotePlayers) {
+        const CyborPlayer& player = *remote.player;
+        CyborSnapshotCodec::EntityState state;
+        state.entityId = remote.entityId;
+        state.position = player.GetPosition();
+        state.yaw = player.GetYaw();
+        state.pitch = player.GetPitch();
+        state.health = player.GetHealth();
+        state.armor = player.GetArmor();
+        auto weapon = player.GetCurrentWeapon();
+        state.weaponType = weapon ? static_cast<uint8_t>(weapon->GetType()) : 0;
+        state.team = static_cast<uint8_t>(remote.team);
+        state.alive = player.IsAlive();
+        outStates.push_back(state);
+    }
+
+    for (const auto& bot : m_bots) {
+        CyborSnapshotCodec::EntityState state;
+        state.entityId = bot->GetEntityId();
+        state.position = bot->GetPosition();
+        state.yaw = bot->GetYaw();
+        state.pitch = bot->GetPitch();
+        state.health = bot->GetHealth();
+        state.armor = bot->GetArmor();
+        auto weapon = bot->GetCurrentWeapon();
+        state.weaponType = weapon ? static_cast<uint8_t>(weapon->GetType()) : 0;
+        state.team = static_cast<uint8_t>(bot->GetTeam());
+        state.alive = bot->IsAlive();
+        outStates.push_back(state);
+    }
+}
+
+bool CyborGameManager::GetEntityPosition(uint32_t entityId, glm::vec3& outPosition) const {
+    if (entityId == PLAYER_ENTITY_ID) {
+        if (!m_player) return false;
+        outPosition = m_player->GetPosition();
+        return true;
+    }
+
+    for (const auto& bot : m_bots) {
+        if (bot->GetEntityId() == entityId) {
+            outPosition = bot->GetPosition();
+            return true;
+        }
+    }
+    return false;
+}
+
 void CyborGameManager::CheckWinConditions() {
     // Count alive enemy bots
     int aliveEnemies = 0;
@@ -172,13 +682,13 @@ void CyborGameManager::CheckWinConditions() {
 
 void CyborGameManager::HandlePlayerInput(float deltaTime) {
     // Enable/disable Cybor tactical mode
-    if (m_engine->IsKeyPressed(GLFW_KEY_T)) {
+    if (IsKeyPressed(GLFW_KEY_T)) {
         EnableCyborTacticalMode(!m_cyborTacticalMode);
         std::cout << "Cybor Tactical Mode: " << (m_cyborTacticalMode ? "ENABLED" : "DISABLED") << std::endl;
     }
 
     // Debug: Spawn enemy bot
-    if (m_engine->IsKeyPressed(GLFW_KEY_B)) {
+    if (IsKeyPressed(GLFW_KEY_B)) {
         glm::vec3 spawnPos = m_player->GetPosition() + glm::vec3(10.0f, 0.0f, 0.0f);
         SpawnBot(Team::CYBOR_TERRORISTS, spawnPos);
     }
@@ -211,17 +721,22 @@ void CyborGameManager::StartMatch(const std::string& mapName) {
     // Reset match statistics
     m_matchTime = 0.0f;
     m_roundTime = 0.0f;
+    m_lagCompensation.Clear();
+    m_thrownGrenades.clear();
+    m_explosions.clear();
 
     // Clear existing bots
     m_bots.clear();
+    m_collisionWorld = LoadMapGeometry(mapName);
 
     // Spawn bots based on mission
     int botCount = 3 + m_currentMission; // Increase difficulty
     for (int i = 0; i < botCount; i++) {
+        std::uniform_int_distribution<int> offset(-10, 9);
         glm::vec3 spawnPos(
-            (rand() % 20) - 10.0f,  // Random X: -10 to 10
-            1.8f,                   // Y: Standard height
-            (rand() % 20) - 10.0f   // Random Z: -10 to 10
+            static_cast<float>(offset(m_random)), // Random X: -10 to 10
+            1.8f,                                 // Y: Standard height
+            static_cast<float>(offset(m_random))  // Random Z: -10 to 10
         );
         SpawnBot(Team::CYBOR_TERRORISTS, spawnPos);
     }
@@ -253,6 +768,11 @@ void CyborGameManager::StartMatch(const std::string& mapName) {
 }
 
 void CyborGameManager::EndMatch(Team winningTeam) {
+    if (m_networkManager && m_networkManager->IsServerRunning()) {
+        m_networkManager->SendGameEvent({ CyborNetworkManager::GameEvent::Type::ROUND_END, 0, 0,
+                                          static_cast<int32_t>(winningTeam), "" });
+    }
+
     std::cout << "Match ended! Winner: ";
 
     if (winningTeam == m_playerTeam) {
@@ -301,6 +821,8 @@ void CyborGameManager::SpawnBot(Team team, const glm::vec3& position) {
     if (m_currentMission >= 4) difficulty = CyborBot::BotDifficulty::EXPERT;
 
     auto bot = std::make_unique<CyborBot>(botName, botTeam, difficulty);
+    bot->SetEntityId(m_nextEntityId++);
+    bot->SeedRandom(m_random());
     if (bot->Initialize(position)) {
         if (m_cyborTacticalMode) {
             bot->EnableCyborAI(true);
@@ -337,6 +859,9 @@ void CyborGameManager::Render() {
         }
     }
 
+    // Render the server's entities while connected
+    RenderRemoteEntities();
+
     // Render map
     if (m_currentMap) {
         // Map rendering would go here
@@ -346,6 +871,27 @@ void CyborGameManager::Render() {
     RenderHUD();
 }
 
+void CyborGameManager::RenderRemoteEntities() {
+    // Sampled between snapshots slightly in the past, never straight from the latest one,
+    // so remote players move smoothly at any snapshot rate
+    if (!m_networkManager || !m_networkManager->IsConnected() ||
+        !m_networkManager->GetInterpolatedWorldState(m_remoteEntities)) {
+        return;
+    }
+
+    // Remote entity rendering would go here
+    // For now, we'll just output their positions periodically
+    m_remoteRenderTimer += 0.016f;
+    if (m_remoteRenderTimer > 2.0f) {
+        for (const auto& entity : m_remoteEntities) {
+            if (!entity.alive) continue;
+            std::cout << "Remote entity " << entity.entityId << " at (" << entity.position.x << ", "
+                      << entity.position.y << ", " << entity.position.z << ") Health: " << entity.health << std::endl;
+        }
+        m_remoteRenderTimer = 0.0f;
+    }
+}
+
 void CyborGameManager::RenderHUD() {
     // This would integrate with a UI system to display:
     // - Health and armor
@@ -356,10 +902,9 @@ void CyborGameManager::RenderHUD() {
     // - Cybor mode status
 
     // For now, we'll just output to console periodically
-    static float hudUpdateTimer = 0.0f;
-    hudUpdateTimer += 0.016f; // Assume 60 FPS
+    m_hudUpdateTimer += 0.016f; // Assume 60 FPS
 
-    if (hudUpdateTimer >= 5.0f) { // Update every 5 seconds
+    if (m_hudUpdateTimer >= 5.0f) { // Update every 5 seconds
         if (m_gameState == GameState::PLAYING && m_player) {
             std::cout << "\n=== CYBOR HUD ===" << std::endl;
             std::cout << "Health: " << (int)m_player->GetHealth() << "/100" << std::endl;
@@ -373,15 +918,19 @@ void CyborGameManager::RenderHUD() {
             }
             std::cout << "=================" << std::endl;
         }
-        hudUpdateTimer = 0.0f;
+        m_hudUpdateTimer = 0.0f;
     }
 }
 
 void CyborGameManager::Shutdown() {
+    if (!m_initialized) return;
+
     std::cout << "Shutting down Cybor Game Manager..." << std::endl;
 
     m_bots.clear();
+    m_remotePlayers.clear();
     m_player.reset();
     m_currentMap.reset();
     m_gameMode.reset();
+    m_initialized = false;
 }
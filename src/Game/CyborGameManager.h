@@ -6,10 +6,20 @@
 #include "CyborMap.h"
 #include "CyborBot.h"
 #include "CyborGameMode.h"
+#include "CyborDamageSystem.h"
+#include "CyborCollisionWorld.h"
+#include "CyborSpatialGrid.h"
+#include "../Network/CyborLagCompensation.h"
+#include "../Network/CyborSnapshot.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <random>
 #include <string>
 
+class CyborAudioSystem;
+class CyborNetworkManager;
+
 /*
  * CyborGameManager - Central game logic and state management
  * Handles campaign progression, bot AI, and tactical gameplay
@@ -32,6 +42,7 @@ public:
     };
 
 public:
+    // Without an engine the match runs headless, e.g. as a shard of a match host
     CyborGameManager(CyborEngine* engine);
     ~CyborGameManager();
 
@@ -58,15 +69,42 @@ public:
     void SpawnBot(Team team, const glm::vec3& position);
     void UpdateBots(float deltaTime);
     size_t GetBotCount() const { return m_bots.size(); }
+    // Server under load: at level n, bots far from the player think only every 2^n-th tick
+    void SetAILevelOfDetail(int level) { m_aiDetailLevel = level; }
 
     // Player management
     CyborPlayer* GetPlayer() { return m_player.get(); }
+    // Level collision of the current map; it changes when a map loads
+    const CyborCollisionWorld* GetCollisionWorld() const { return m_collisionWorld.get(); }
+
+    // Combat
+    void QueueDamage(uint32_t targetId, uint32_t attackerId, float damage,
+                     const glm::vec3& hitDirection, CyborWeapon::WeaponType weaponType);
+    void SetAudioSystem(CyborAudioSystem* audioSystem) { m_audioSystem = audioSystem; }
+    // Kills and round ends go out as reliable game events while hosting; connected, the server's are shown
+    void SetNetworkManager(CyborNetworkManager* networkManager) { m_networkManager = networkManager; }
+
+    // Area damage with linear falloff, blocked by level geometry
+    void QueueExplosion(const glm::vec3& center, float radius, float damage, uint32_t attackerId,
+                        CyborBot::Team attackerTeam, CyborWeapon::WeaponType weaponType);
+
+    // Shot from a networked shooter, registered against the world as it was at viewTime
+    void QueueRemoteShot(const CyborWeapon::ShotInfo& shot, uint32_t shooterId,
+                         CyborBot::Team shooterTeam, float viewTime);
+
+    // Replicated state of the player and every bot, for world snapshots
+    void GetNetworkEntityStates(std::vector<CyborSnapshotCodec::EntityState>& outStates) const;
+
+    static constexpr uint32_t PLAYER_ENTITY_ID = 0;
 
     // Game statistics
     int GetPlayerScore() const { return m_playerScore; }
     int GetEnemiesKilled() const { return m_enemiesKilled; }
     float GetMatchTime() const { return m_matchTime; }
 
+    // Spawns and bot decisions draw from the match's own generator
+    void SetRandomSeed(uint32_t seed) { m_random.seed(seed); }
+
     // Cybor tactical features
     void EnableCyborTacticalMode(bool enable) { m_cyborTacticalMode = enable; }
     void UpdateCyborIntelligence(float deltaTime);
@@ -74,12 +112,72 @@ public:
 private:
     CyborEngine* m_engine;
     GameState m_gameState;
+    bool m_initialized;
 
     // Game objects
     std::unique_ptr<CyborPlayer> m_player;
     std::unique_ptr<CyborMap> m_currentMap;
     std::vector<std::unique_ptr<CyborBot>> m_bots;
     std::unique_ptr<CyborGameMode> m_gameMode;
+    CyborAudioSystem* m_audioSystem;
+    CyborNetworkManager* m_networkManager;
+    int m_aiDetailLevel;
+    uint32_t m_botTick;
+
+    // Combat
+    CyborDamageSystem m_damageSystem;
+    std::vector<CyborBot*> m_damageTargets;
+    uint32_t m_nextEntityId;
+
+    // Lag compensation
+    struct RemoteShot {
+        CyborWeapon::ShotInfo shot;
+        uint32_t shooterId;
+        CyborBot::Team shooterTeam;
+        float viewTime;
+    };
+    CyborLagCompensation m_lagCompensation;
+    std::vector<CyborLagCompensation::RewoundHitbox> m_rewoundHitboxes;
+    std::vector<RemoteShot> m_remoteShots;
+
+    // Server: one player per connected peer, moved only by the commands that peer sends
+    struct RemotePlayer {
+        uint32_t peerId;
+        uint32_t entityId;
+        CyborBot::Team team;
+        uint32_t lastSequence;
+        std::unique_ptr<CyborPlayer> player;
+    };
+    std::vector<RemotePlayer> m_remotePlayers;
+
+    // Client: the server's entities, interpolated between snapshots each frame for rendering
+    std::vector<CyborSnapshotCodec::EntityState> m_remoteEntities;
+    float m_remoteRenderTimer;
+
+    // Bullet traces; level collision is read-only and shared by every match on the map
+    std::shared_ptr<const CyborCollisionWorld> m_collisionWorld;
+    std::vector<CyborCollisionWorld::EntityHitbox> m_traceEntities;
+    std::vector<CyborCollisionWorld::TraceHit> m_traceHits;
+
+    // Explosions
+    struct Explosion {
+        glm::vec3 center;
+        float radius;
+        float damage;
+        uint32_t attackerId;
+        CyborBot::Team attackerTeam;
+        CyborWeapon::WeaponType weaponType;
+    };
+    struct ThrownGrenade {
+        Explosion explosion;
+        float detonateTime;
+    };
+    CyborSpatialGrid m_spatialGrid;
+    std::vector<Explosion> m_explosions;
+    std::vector<ThrownGrenade> m_thrownGrenades;
+    std::vector<CyborSpatialGrid::Entry> m_blastCandidates;
+    std::vector<glm::vec3> m_blastTargets;
+    std::vector<uint8_t> m_blastOccluded;
 
     // Campaign system
     int m_currentMission;
@@ -93,6 +191,8 @@ private:
     float m_matchTime;
     float m_roundTime;
     Team m_playerTeam;
+    std::mt19937 m_random;
+    float m_hudUpdateTimer;
 
     // Cybor enhancements
     bool m_cyborTacticalMode;
@@ -103,6 +203,19 @@ private:
     void ProcessGameLogic(float deltaTime);
     void CheckWinConditions();
     void HandlePlayerInput(float deltaTime);
+    void RecordHitboxHistory();
+    void UpdateSpatialGrid();
+    void ProcessShots();
+    void ThrowGrenade(const CyborWeapon::ShotInfo& shot, uint32_t throwerId, CyborBot::Team throwerTeam);
+    void ProcessExplosions();
+    void TraceShot(const CyborWeapon::ShotInfo& shot, uint32_t shooterId, CyborBot::Team shooterTeam, float viewTime);
+    static std::shared_ptr<const CyborCollisionWorld> LoadMapGeometry(const std::string& mapName);
+    bool IsKeyPressed(int key) const { return m_engine && m_engine->IsKeyPressed(key); }
+    void ResolveDamage();
+    void ProcessGameEvents();
+    void UpdateRemotePlayers();
+    bool GetEntityPosition(uint32_t entityId, glm::vec3& outPosition) const;
     void UpdateUI();
     void RenderHUD();
+    void RenderRemoteEntities();
 };
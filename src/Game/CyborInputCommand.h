@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+
+/*
+ * CyborInputCommand - One tick of player movement input
+ * Recorded by the client, replayed for prediction and simulated by the server
+ * through the same movement code
+ */
+struct CyborInputCommand {
+    enum Buttons : uint8_t {
+        FORWARD = 1 << 0,
+        BACK    = 1 << 1,
+        LEFT    = 1 << 2,
+        RIGHT   = 1 << 3,
+        SPRINT  = 1 << 4,
+        JUMP    = 1 << 5,
+        CROUCH  = 1 << 6
+    };
+
+    uint32_t sequence;
+    float deltaTime;
+    float yaw;   // Degrees, snapped with SnapAngle so both ends simulate identical values
+    float pitch;
+    uint8_t buttons;
+
+    // 1/64 degree keeps +-360 inside an int16 on the wire
+    static constexpr float ANGLE_STEPS_PER_DEGREE = 64.0f;
+    static float SnapAngle(float degrees) { return std::round(degrees * ANGLE_STEPS_PER_DEGREE) / ANGLE_STEPS_PER_DEGREE; }
+};
+
+// Movement state the server is authoritative over
+struct CyborMoveState {
+    glm::vec3 position;
+    glm::vec3 velocity;
+    bool isOnGround;
+    bool isCrouching;
+};
@@ -0,0 +1,248 @@
+#include "CyborMatchHost.h"
+#include "CyborGameManager.h"
+#include "../Engine/CyborTickScheduler.h"
+#include "../Network/CyborNetworkManager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct CyborMatchHost::Shard {
+    enum State { STARTING, RUNNING, FAILED };
+
+    int index;
+    int port;
+    int cpu;
+    int node;
+    std::vector<int> cpus; // Where the thread may run; empty for anywhere
+    uint32_t seed;
+    std::thread thread;
+    std::atomic<bool> stopping;
+
+    // Published by the shard's thread every tick
+    std::atomic<int> state;
+    std::atomic<int> players;
+    std::atomic<int> bots;
+    std::atomic<int> degradation;
+    std::atomic<uint64_t> ticks;
+    std::atomic<uint64_t> overruns;
+};
+
+CyborMatchHost::CyborMatchHost() {
+}
+
+CyborMatchHost::~CyborMatchHost() {
+    Stop();
+}
+
+bool CyborMatchHost::Start(const Settings& settings) {
+    Stop();
+    m_settings = settings;
+
+    const std::vector<int> allowedCpus = GetAllowedCpus();
+    const std::vector<std::vector<int>> nodes = GetNumaNodes();
+
+    for (int i = 0; i < settings.matches; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        shard->port = settings.basePort + i;
+        shard->cpu = -1;
+        shard->node = -1;
+        shard->seed = settings.seed * 1000003u + static_cast<uint32_t>(i);
+
+        if (settings.affinity == Affinity::CORE && !allowedCpus.empty()) {
+            shard->cpu = allowedCpus[i % allowedCpus.size()];
+            shard->cpus.push_back(shard->cpu);
+            for (size_t n = 0; n < nodes.size(); n++) {
+                if (std::find(nodes[n].begin(), nodes[n].end(), shard->cpu) != nodes[n].end()) shard->node = static_cast<int>(n);
+            }
+        } else if (settings.affinity == Affinity::NUMA_NODE && !nodes.empty()) {
+            shard->node = i % static_cast<int>(nodes.size());
+            shard->cpus = nodes[shard->node];
+        }
+
+        shard->stopping = false;
+        shard->state = Shard::STARTING;
+        shard->players = 0;
+        shard->bots = 0;
+        shard->degradation = 0;
+        shard->ticks = 0;
+        shard->overruns = 0;
+        shard->thread = std::thread(&CyborMatchHost::RunShard, this, std::ref(*shard));
+        m_shards.push_back(std::move(shard));
+    }
+
+    // Each shard sets itself up on its own thread; wait until all have answered
+    int running = 0;
+    for (auto& shard : m_shards) {
+        while (shard->state == Shard::STARTING) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (shard->state == Shard::RUNNING) running++;
+    }
+
+    std::cout << "Cybor Match Host running " << running << "/" << settings.matches << " matches at "
+              << settings.tickRate << " Hz on ports " << settings.basePort << "-"
+              << settings.basePort + settings.matches - 1 << std::endl;
+    if (running == 0) {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+void CyborMatchHost::Stop() {
+    for (auto& shard : m_shards) shard->stopping = true;
+    for (auto& shard : m_shards) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+    m_shards.clear();
+}
+
+void CyborMatchHost::GetStatus(std::vector<MatchStatus>& outStatus) const {
+    outStatus.clear();
+    for (const auto& shard : m_shards) {
+        MatchStatus status;
+        status.index = shard->index;
+        status.port = shard->port;
+        status.cpu = shard->cpu;
+        status.node = shard->node;
+        status.running = shard->state == Shard::RUNNING;
+        status.players = shard->players;
+        status.bots = shard->bots;
+        status.ticks = shard->ticks;
+        status.overruns = shard->overruns;
+        status.degradation = shard->degradation;
+        outStatus.push_back(status);
+    }
+}
+
+void CyborMatchHost::RunShard(Shard& shard) {
+    if (!shard.cpus.empty() && !PinCurrentThread(shard.cpus)) {
+        std::cerr << "Match " << shard.index << ": could not set its CPU affinity, running unpinned" << std::endl;
+    }
+
+    // Everything the match owns is created here, after pinning, so first touch puts it on the local
+    // node. Threads it starts (the network transport's) inherit the affinity.
+    auto game = std::make_unique<CyborGameManager>(nullptr);
+    auto network = std::make_unique<CyborNetworkManager>();
+    CyborTickScheduler scheduler(m_settings.tickRate);
+    std::vector<CyborSnapshotCodec::EntityState> states;
+
+    game->SetRandomSeed(shard.seed);
+    game->SetNetworkManager(network.get());
+    network->Initialize();
+    network->SetBroadcastDelay(m_settings.broadcastDelay);
+    for (const std::string& address : m_settings.relayAddresses) network->AllowBroadcastRelay(address);
+    // One more peer than players, for a broadcast relay
+    if (!game->Initialize() || !network->StartServer(shard.port, m_settings.playersPerMatch + 1)) {
+        std::cerr << "Match " << shard.index << ": failed to start on port " << shard.port << std::endl;
+        network->Shutdown();
+        shard.state = Shard::FAILED;
+        return;
+    }
+    game->StartCampaign();
+    shard.state = Shard::RUNNING;
+
+    while (!shard.stopping) {
+        scheduler.WaitForNextTick();
+        const float deltaTime = scheduler.GetTickInterval();
+
+        scheduler.BeginTick();
+        scheduler.BeginPhase(CyborTickScheduler::Phase::RECEIVE);
+        network->Update(deltaTime);
+
+        scheduler.BeginPhase(CyborTickScheduler::Phase::SIMULATE);
+        game->Update(deltaTime);
+        // Nobody is at a keyboard to start the next round
+        if (game->GetGameState() == CyborGameManager::GameState::GAME_OVER) {
+            game->RestartMatch();
+        } else if (game->GetGameState() == CyborGameManager::GameState::CAMPAIGN_COMPLETE) {
+            game->StartCampaign();
+        }
+
+        scheduler.BeginPhase(CyborTickScheduler::Phase::SEND);
+        network->GetInterestManager().SetCollisionWorld(game->GetCollisionWorld());
+        game->GetNetworkEntityStates(states);
+        network->SendWorldSnapshot(states);
+        scheduler.EndTick();
+
+        game->SetAILevelOfDetail(scheduler.GetDegradationLevel());
+        network->SetSnapshotLevelOfDetail(scheduler.GetDegradationLevel());
+
+        shard.players = network->GetPlayerCount();
+        shard.bots = static_cast<int>(game->GetBotCount());
+        shard.degradation = scheduler.GetDegradationLevel();
+        shard.ticks = scheduler.GetStats().ticks;
+        shard.overruns = scheduler.GetStats().overruns;
+    }
+
+    network->Shutdown();
+    game->Shutdown();
+}
+
+std::vector<int> CyborMatchHost::GetAllowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        const int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::vector<std::vector<int>> CyborMatchHost::GetNumaNodes() {
+    const std::vector<int> allowedCpus = GetAllowedCpus();
+    std::vector<std::vector<int>> nodes;
+
+    // sysfs lists each node's CPUs as ranges, e.g. "0-7,16-23"
+    for (int node = 0;; node++) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) break;
+
+        std::vector<int> cpus;
+        std::string range;
+        while (std::getline(file, range, ',')) {
+            int first = 0;
+            int last = 0;
+            char dash = 0;
+            std::istringstream stream(range);
+            if (!(stream >> first)) continue;
+            last = (stream >> dash >> last) ? last : first;
+            for (int cpu = first; cpu <= last; cpu++) {
+                if (std::find(allowedCpus.begin(), allowedCpus.end(), cpu) != allowedCpus.end()) cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) nodes.push_back(cpus);
+    }
+
+    if (nodes.empty()) nodes.push_back(allowedCpus);
+    return nodes;
+}
+
+bool CyborMatchHost::PinCurrentThread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
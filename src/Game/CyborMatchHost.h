@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * CyborMatchHost - Many independent matches in one server process
+ * Every match is a shard with its own game manager, network endpoint and
+ * tick scheduler, running on its own thread pinned to a core or NUMA node.
+ * A shard builds all of its state on that thread, so its memory lands on
+ * the local node. Shards share nothing mutable; read-only assets such as
+ * level collision are loaded once per map and shared between them. Each
+ * match plays the campaign and starts over whenever it ends.
+ */
+class CyborMatchHost {
+public:
+    enum class Affinity {
+        NONE,
+        CORE,      // Shard i on the i-th allowed CPU, wrapping around
+        NUMA_NODE  // Shards spread round-robin over nodes, free to move within one
+    };
+
+    struct Settings {
+        int matches = 8;
+        int tickRate = 64;
+        int basePort = 27015;    // Match i listens on basePort + i
+        int playersPerMatch = 16;
+        Affinity affinity = Affinity::CORE;
+        float broadcastDelay = 0.0f; // Seconds a match's spectator relay runs behind the game
+        std::vector<std::string> relayAddresses; // Hosts allowed to connect as a relay; needs a delay
+        uint32_t seed = 1;
+    };
+
+    struct MatchStatus {
+        int index;
+        int port;
+        int cpu;           // Pinned CPU, or -1
+        int node;          // NUMA node it was placed on, or -1
+        bool running;
+        int players;
+        int bots;
+        uint64_t ticks;
+        uint64_t overruns;
+        int degradation;
+    };
+
+public:
+    CyborMatchHost();
+    ~CyborMatchHost();
+
+    // Starts every shard; false when none could be started
+    bool Start(const Settings& settings);
+    void Stop();
+    bool IsRunning() const { return !m_shards.empty(); }
+
+    // Any thread
+    void GetStatus(std::vector<MatchStatus>& outStatus) const;
+
+    // CPUs this process may run on, and the ones on each NUMA node (one node when unknown)
+    static std::vector<int> GetAllowedCpus();
+    static std::vector<std::vector<int>> GetNumaNodes();
+
+private:
+    struct Shard;
+
+    Settings m_settings;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    void RunShard(Shard& shard);
+    static bool PinCurrentThread(const std::vector<int>& cpus);
+};
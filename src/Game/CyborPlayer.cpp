@@ -1,4 +1,5 @@
 #include "CyborPlayer.h"
+#include "CyborDamageSystem.h"
 #include <iostream>
 #include <algorithm>
 
@@ -11,7 +12,9 @@ CyborPlayer::CyborPlayer()
       m_movementState(MovementState::IDLE), m_stanceState(StanceState::STANDING),
       m_walkSpeed(2.5f), m_runSpeed(5.0f), m_crouchSpeed(1.5f), m_jumpHeight(2.0f),
       m_mouseSensitivity(0.002f), m_isOnGround(true), m_isCrouching(false),
-      m_currentWeaponIndex(0), m_shootCooldown(0.0f),
+      m_currentWeaponIndex(0), m_shootCooldown(0.0f), m_elapsedTime(0.0f),
+      m_commandBuffer(), m_nextCommandSequence(0), m_lastProcessedSequence(0),
+      m_predictionEnabled(false), m_predictionError(0.0f),
       m_gravity(-9.81f), m_groundNormal(0.0f, 1.0f, 0.0f),
       m_cyborModeEnabled(false), m_cyborEnhancementLevel(1.0f),
       m_cyborSpeedMultiplier(1.0f), m_cyborHealthRegenRate(0.0f) {
@@ -40,10 +43,9 @@ bool CyborPlayer::Initialize(const glm::vec3& spawnPosition) {
 void CyborPlayer::Update(float deltaTime, CyborEngine* engine) {
     if (!IsAlive()) return;
 
+    m_elapsedTime += deltaTime;
+
     ProcessInput(engine, deltaTime);
-    ProcessMovement(deltaTime, engine);
-    UpdatePhysics(deltaTime);
-    UpdateOrientation();
 
     // Update shoot cooldown
     if (m_shootCooldown > 0.0f) {
@@ -59,24 +61,78 @@ void CyborPlayer::Update(float deltaTime, CyborEngine* engine) {
 void CyborPlayer::ProcessInput(CyborEngine* engine, float deltaTime) {
     if (!engine) return;
 
+    // Mouse look first so the command carries this tick's view angles
+    glm::vec2 mouseDelta = engine->GetMouseDelta();
+    ProcessMouseLook(mouseDelta, m_mouseSensitivity);
+
+    // Movement is captured as a command and simulated like the server would
+    CyborInputCommand command;
+    command.sequence = m_nextCommandSequence++;
+    command.deltaTime = deltaTime;
+    command.yaw = CyborInputCommand::SnapAngle(m_yaw);
+    command.pitch = CyborInputCommand::SnapAngle(m_pitch);
+    command.buttons = 0;
+    if (engine->IsKeyPressed(GLFW_KEY_W)) command.buttons |= CyborInputCommand::FORWARD;
+    if (engine->IsKeyPressed(GLFW_KEY_S)) command.buttons |= CyborInputCommand::BACK;
+    if (engine->IsKeyPressed(GLFW_KEY_A)) command.buttons |= CyborInputCommand::LEFT;
+    if (engine->IsKeyPressed(GLFW_KEY_D)) command.buttons |= CyborInputCommand::RIGHT;
+    if (engine->IsKeyPressed(GLFW_KEY_LEFT_SHIFT)) command.buttons |= CyborInputCommand::SPRINT;
+    if (engine->IsKeyPressed(GLFW_KEY_SPACE)) command.buttons |= CyborInputCommand::JUMP;
+    if (engine->IsKeyPressed(GLFW_KEY_LEFT_CONTROL)) command.buttons |= CyborInputCommand::CROUCH;
+
+    m_commandBuffer[command.sequence % COMMAND_BUFFER_SIZE] = command;
+    if (m_predictionEnabled) {
+        m_pendingCommands.push_back(command);
+    }
+    SimulateCommand(command);
+
+    // Shooting
+    if (engine->IsMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT) && m_shootCooldown <= 0.0f) {
+        Shoot();
+    }
+
+    // Reload
+    if (engine->IsKeyPressed(GLFW_KEY_R)) {
+        Reload();
+    }
+
+    // Weapon switching
+    if (engine->IsKeyPressed(GLFW_KEY_1)) SwitchWeapon(0);
+    if (engine->IsKeyPressed(GLFW_KEY_2)) SwitchWeapon(1);
+    if (engine->IsKeyPressed(GLFW_KEY_3)) SwitchWeapon(2);
+
+    // Cybor mode toggle
+    if (engine->IsKeyPressed(GLFW_KEY_C)) {
+        EnableCyborMode(!m_cyborModeEnabled);
+        std::cout << "Cybor Mode: " << (m_cyborModeEnabled ? "ENABLED" : "DISABLED") << std::endl;
+    }
+}
+
+void CyborPlayer::SimulateCommand(const CyborInputCommand& command) {
+    const float deltaTime = command.deltaTime;
+
+    m_yaw = command.yaw;
+    m_pitch = command.pitch;
+    UpdateOrientation();
+
     // Movement input
     glm::vec3 moveDirection(0.0f);
-    
-    if (engine->IsKeyPressed(GLFW_KEY_W)) moveDirection += m_forward;
-    if (engine->IsKeyPressed(GLFW_KEY_S)) moveDirection -= m_forward;
-    if (engine->IsKeyPressed(GLFW_KEY_A)) moveDirection -= m_right;
-    if (engine->IsKeyPressed(GLFW_KEY_D)) moveDirection += m_right;
+
+    if (command.buttons & CyborInputCommand::FORWARD) moveDirection += m_forward;
+    if (command.buttons & CyborInputCommand::BACK) moveDirection -= m_forward;
+    if (command.buttons & CyborInputCommand::LEFT) moveDirection -= m_right;
+    if (command.buttons & CyborInputCommand::RIGHT) moveDirection += m_right;
 
     // Normalize movement direction
     if (glm::length(moveDirection) > 0.0f) {
         moveDirection = glm::normalize(moveDirection);
-        
+
         // Determine movement speed
         float speed = m_walkSpeed;
-        if (engine->IsKeyPressed(GLFW_KEY_LEFT_SHIFT)) {
+        if (command.buttons & CyborInputCommand::SPRINT) {
             speed = m_runSpeed;
             m_movementState = MovementState::RUNNING;
-        } else if (glm::length(moveDirection) > 0.0f) {
+        } else {
             m_movementState = MovementState::WALKING;
         }
 
@@ -93,41 +149,52 @@ void CyborPlayer::ProcessInput(CyborEngine* engine, float deltaTime) {
     }
 
     // Jump
-    if (engine->IsKeyPressed(GLFW_KEY_SPACE) && m_isOnGround) {
+    if ((command.buttons & CyborInputCommand::JUMP) && m_isOnGround) {
         Jump();
     }
 
     // Crouch
-    if (engine->IsKeyPressed(GLFW_KEY_LEFT_CONTROL)) {
-        Crouch(true);
-    } else {
-        Crouch(false);
-    }
+    Crouch((command.buttons & CyborInputCommand::CROUCH) != 0);
 
-    // Mouse look
-    glm::vec2 mouseDelta = engine->GetMouseDelta();
-    ProcessMouseLook(mouseDelta, m_mouseSensitivity);
+    ProcessMovement(deltaTime, nullptr);
+    UpdatePhysics(deltaTime);
+}
 
-    // Shooting
-    if (engine->IsMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT) && m_shootCooldown <= 0.0f) {
-        Shoot();
-    }
+CyborMoveState CyborPlayer::GetMoveState() const {
+    return { m_position, m_velocity, m_isOnGround, m_isCrouching };
+}
 
-    // Reload
-    if (engine->IsKeyPressed(GLFW_KEY_R)) {
-        Reload();
+void CyborPlayer::SetMoveState(const CyborMoveState& state) {
+    m_position = state.position;
+    m_velocity = state.velocity;
+    m_isOnGround = state.isOnGround;
+    m_isCrouching = state.isCrouching;
+    m_stanceState = state.isCrouching ? StanceState::CROUCHING : StanceState::STANDING;
+}
+
+void CyborPlayer::ReconcileWithServer(uint32_t lastProcessedSequence, const CyborMoveState& serverState) {
+    // Acks can arrive out of order; never rewind to an older state
+    if (lastProcessedSequence < m_lastProcessedSequence) return;
+    m_lastProcessedSequence = lastProcessedSequence;
+
+    const glm::vec3 predictedPosition = m_position;
+    const float yaw = m_yaw;
+    const float pitch = m_pitch;
+    SetMoveState(serverState);
+
+    // Replay what the server hasn't seen yet; commands that fell out of the buffer are lost
+    for (uint32_t sequence = lastProcessedSequence + 1; sequence < m_nextCommandSequence; sequence++) {
+        const CyborInputCommand& command = m_commandBuffer[sequence % COMMAND_BUFFER_SIZE];
+        if (command.sequence != sequence) break;
+        SimulateCommand(command);
     }
 
-    // Weapon switching
-    if (engine->IsKeyPressed(GLFW_KEY_1)) SwitchWeapon(0);
-    if (engine->IsKeyPressed(GLFW_KEY_2)) SwitchWeapon(1);
-    if (engine->IsKeyPressed(GLFW_KEY_3)) SwitchWeapon(2);
+    // Mouse look since the last command is not part of the replay
+    m_yaw = yaw;
+    m_pitch = pitch;
+    UpdateOrientation();
 
-    // Cybor mode toggle
-    if (engine->IsKeyPressed(GLFW_KEY_C)) {
-        EnableCyborMode(!m_cyborModeEnabled);
-        std::cout << "Cybor Mode: " << (m_cyborModeEnabled ? "ENABLED" : "DISABLED") << std::endl;
-    }
+    m_predictionError = glm::length(m_position - predictedPosition);
 }
 
 void CyborPlayer::ProcessMovement(float deltaTime, CyborEngine* engine) {
@@ -205,18 +272,19 @@ void CyborPlayer::Shoot() {
     if (m_shootCooldown > 0.0f) return;
 
     auto currentWeapon = GetCurrentWeapon();
-    if (currentWeapon && currentWeapon->CanShoot()) {
-        currentWeapon->Shoot();
+    if (currentWeapon && currentWeapon->CanShoot(m_elapsedTime)) {
+        CyborWeapon::ShotInfo shot;
+        if (currentWeapon->Fire(m_position, m_forward, m_elapsedTime, &shot)) {
+            m_pendingShots.push_back(shot);
+        }
         m_shootCooldown = currentWeapon->GetFireRate();
-        
-        std::cout << "Player fired weapon!" << std::endl;
     }
 }
 
 void CyborPlayer::Reload() {
     auto currentWeapon = GetCurrentWeapon();
     if (currentWeapon) {
-        currentWeapon->Reload();
+        currentWeapon->Reload(m_elapsedTime);
         std::cout << "Reloading weapon..." << std::endl;
     }
 }
@@ -238,22 +306,18 @@ void CyborPlayer::PickupWeapon(std::shared_ptr<CyborWeapon> weapon) {
 void CyborPlayer::TakeDamage(float damage, const glm::vec3& hitDirection) {
     if (!IsAlive()) return;
 
-    // Armor absorbs damage first
-    float damageToHealth = damage;
-    if (m_armor > 0.0f) {
-        float armorAbsorption = std::min(m_armor, damage * 0.5f);
-        m_armor -= armorAbsorption;
-        damageToHealth -= armorAbsorption;
-    }
-
-    // Apply remaining damage to health
-    if (damageToHealth > 0.0f) {
-        m_health -= damageToHealth;
-    }
+    float health = m_health;
+    float armor = m_armor;
+    CyborDamageSystem::AbsorbDamage(health, armor, damage);
+    ApplyDamageResult(health, armor);
+}
 
-    std::cout << "Player took " << damage << " damage. Health: " << m_health << ", Armor: " << m_armor << std::endl;
+void CyborPlayer::ApplyDamageResult(float health, float armor) {
+    bool wasAlive = IsAlive();
+    m_health = health;
+    m_armor = armor;
 
-    if (!IsAlive()) {
+    if (wasAlive && !IsAlive()) {
         m_deaths++;
         std::cout << "Player died!" << std::endl;
     }
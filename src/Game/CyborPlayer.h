@@ -4,7 +4,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "../Engine/CyborEngine.h"
 #include "CyborWeapon.h"
+#include "CyborInputCommand.h"
 #include <memory>
+#include <vector>
 
 /*
  * CyborPlayer - Advanced tactical player character
@@ -37,6 +39,17 @@ public:
 
     // Movement and physics
     void ProcessMovement(float deltaTime, CyborEngine* engine);
+    void SimulateCommand(const CyborInputCommand& command);
+    CyborMoveState GetMoveState() const;
+    void SetMoveState(const CyborMoveState& state);
+
+    // Client-side prediction: commands are kept until the server has processed them,
+    // then the unacknowledged ones are replayed on top of the authoritative state
+    void EnablePrediction(bool enable) { m_predictionEnabled = enable; }
+    bool IsPredictionEnabled() const { return m_predictionEnabled; }
+    std::vector<CyborInputCommand>& GetPendingCommands() { return m_pendingCommands; }
+    void ReconcileWithServer(uint32_t lastProcessedSequence, const CyborMoveState& serverState);
+    float GetPredictionError() const { return m_predictionError; }
     void ProcessMouseLook(const glm::vec2& mouseDelta, float sensitivity = 0.002f);
     void Jump();
     void Crouch(bool crouching);
@@ -49,6 +62,7 @@ public:
 
     // Health and armor system
     void TakeDamage(float damage, const glm::vec3& hitDirection = glm::vec3(0));
+    void ApplyDamageResult(float health, float armor);
     void Heal(float amount);
     void AddArmor(float amount);
     bool IsAlive() const { return m_health > 0.0f; }
@@ -59,6 +73,8 @@ public:
     glm::vec3 GetForward() const { return m_forward; }
     glm::vec3 GetRight() const { return m_right; }
     glm::vec3 GetUp() const { return m_up; }
+    float GetYaw() const { return m_yaw; }
+    float GetPitch() const { return m_pitch; }
     glm::mat4 GetViewMatrix() const;
 
     float GetHealth() const { return m_health; }
@@ -66,6 +82,7 @@ public:
     int GetMoney() const { return m_money; }
     int GetKills() const { return m_kills; }
     int GetDeaths() const { return m_deaths; }
+    void AddKill(int reward) { m_kills++; m_money += reward; }
 
     MovementState GetMovementState() const { return m_movementState; }
     StanceState GetStanceState() const { return m_stanceState; }
@@ -73,6 +90,9 @@ public:
     // Current weapon
     std::shared_ptr<CyborWeapon> GetCurrentWeapon() const;
 
+    // Shots fired since the last call, drained by the game manager for hit registration
+    std::vector<CyborWeapon::ShotInfo>& GetPendingShots() { return m_pendingShots; }
+
     // Cybor enhancements
     void EnableCyborMode(bool enable) { m_cyborModeEnabled = enable; }
     void SetCyborEnhancement(float level) { m_cyborEnhancementLevel = level; }
@@ -113,6 +133,18 @@ private:
     std::vector<std::shared_ptr<CyborWeapon>> m_weapons;
     int m_currentWeaponIndex;
     float m_shootCooldown;
+    float m_elapsedTime; // Owner clock for timestamp-based weapon state
+    std::vector<CyborWeapon::ShotInfo> m_pendingShots;
+
+    // Prediction
+    static constexpr uint32_t COMMAND_BUFFER_SIZE = 128;
+    // Zeroed; replay starts at sequence 1, so a slot never written can't match
+    CyborInputCommand m_commandBuffer[COMMAND_BUFFER_SIZE];
+    uint32_t m_nextCommandSequence;
+    uint32_t m_lastProcessedSequence;
+    bool m_predictionEnabled;
+    float m_predictionError;
+    std::vector<CyborInputCommand> m_pendingCommands;
 
     // Physics
     float m_gravity;
@@ -0,0 +1,64 @@
+#include "CyborSpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+CyborSpatialGrid::CyborSpatialGrid(float cellSize)
+    : m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize), m_built(false) {
+}
+
+CyborSpatialGrid::~CyborSpatialGrid() {
+}
+
+void CyborSpatialGrid::Clear() {
+    m_entries.clear();
+    m_built = false;
+}
+
+void CyborSpatialGrid::Insert(uint32_t entityId, const glm::vec3& position, uint8_t tag) {
+    uint64_t key = MakeCellKey(CellCoord(position.x), CellCoord(position.z));
+    m_entries.push_back({ key, entityId, tag, position });
+    m_built = false;
+}
+
+void CyborSpatialGrid::Build() {
+    std::sort(m_entries.begin(), m_entries.end(),
+        [](const Entry& a, const Entry& b) { return a.cellKey < b.cellKey; });
+    m_built = true;
+}
+
+size_t CyborSpatialGrid::QueryRadius(const glm::vec3& center, float radius, std::vector<Entry>& outEntries) const {
+    if (!m_built || m_entries.empty()) return 0;
+
+    const size_t before = outEntries.size();
+    const float radiusSq = radius * radius;
+
+    const int32_t minX = CellCoord(center.x - radius);
+    const int32_t maxX = CellCoord(center.x + radius);
+    const int32_t minZ = CellCoord(center.z - radius);
+    const int32_t maxZ = CellCoord(center.z + radius);
+
+    for (int32_t cellX = minX; cellX <= maxX; cellX++) {
+        for (int32_t cellZ = minZ; cellZ <= maxZ; cellZ++) {
+            uint64_t key = MakeCellKey(cellX, cellZ);
+            auto first = std::lower_bound(m_entries.begin(), m_entries.end(), key,
+                [](const Entry& entry, uint64_t value) { return entry.cellKey < value; });
+
+            for (auto it = first; it != m_entries.end() && it->cellKey == key; ++it) {
+                glm::vec3 offset = it->position - center;
+                if (glm::dot(offset, offset) <= radiusSq) {
+                    outEntries.push_back(*it);
+                }
+            }
+        }
+    }
+
+    return outEntries.size() - before;
+}
+
+int32_t CyborSpatialGrid::CellCoord(float value) const {
+    return static_cast<int32_t>(std::floor(value * m_inverseCellSize));
+}
+
+uint64_t CyborSpatialGrid::MakeCellKey(int32_t cellX, int32_t cellZ) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32) | static_cast<uint32_t>(cellZ);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+/*
+ * CyborSpatialGrid - Uniform grid over the ground plane for entity proximity queries
+ * Rebuilt once per tick; radius queries only visit the cells they overlap
+ */
+class CyborSpatialGrid {
+public:
+    struct Entry {
+        uint64_t cellKey;
+        uint32_t entityId;
+        uint8_t tag; // Caller-defined, e.g. team
+        glm::vec3 position;
+    };
+
+public:
+    CyborSpatialGrid(float cellSize = 8.0f);
+    ~CyborSpatialGrid();
+
+    // Per-tick rebuild
+    void Clear();
+    void Insert(uint32_t entityId, const glm::vec3& position, uint8_t tag = 0);
+    void Build();
+
+    // Entities within radius of center (3D distance), appended to outEntries
+    size_t QueryRadius(const glm::vec3& center, float radius, std::vector<Entry>& outEntries) const;
+
+    float GetCellSize() const { return m_cellSize; }
+    size_t GetEntityCount() const { return m_entries.size(); }
+
+private:
+    float m_cellSize;
+    float m_inverseCellSize;
+
+    // Entries sorted by cell key after Build()
+    std::vector<Entry> m_entries;
+    bool m_built;
+
+    // Private methods
+    int32_t CellCoord(float value) const;
+    static uint64_t MakeCellKey(int32_t cellX, int32_t cellZ);
+};
@@ -1,14 +1,15 @@
 #include "CyborWeapon.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include <random>
 
 CyborWeapon::CyborWeapon(const std::string& name, WeaponType type)
     : m_name(name), m_type(type), m_fireMode(FireMode::SINGLE),
-      m_damage(25.0f), m_fireRate(0.1f), m_accuracy(0.9f), m_range(100.0f), m_recoilAmount(1.0f),
+      m_damage(25.0f), m_fireRate(0.1f), m_accuracy(0.9f), m_range(100.0f), m_recoilAmount(1.0f), m_penetrationPower(1.0f), m_blastRadius(0.0f),
       m_currentAmmo(30), m_maxAmmo(30), m_reserveAmmo(90),
-      m_lastFireTime(0.0f), m_isReloading(false), m_reloadTime(2.0f), m_reloadProgress(0.0f),
-      m_currentRecoilIndex(0), m_recoilRecoveryRate(0.1f),
+      m_lastFireTime(-1000.0f), m_isReloading(false), m_reloadTime(2.0f), m_reloadStartTime(0.0f),
+      m_recoilIndexAtLastShot(0), m_recoilRecoveryRate(60.0f),
       m_cyborModeEnabled(false), m_cyborDamageMultiplier(1.5f), m_cyborAccuracyBonus(0.1f), m_cyborFireRateBonus(0.2f),
       m_fireSound(""), m_reloadSound(""), m_emptySound("") {
     
@@ -70,15 +71,20 @@ void CyborWeapon::InitializeRecoilPattern() {
     }
 }
 
-bool CyborWeapon::Fire(const glm::vec3& origin, const glm::vec3& direction) {
-    if (!HasAmmo() || m_isReloading) {
-        if (!HasAmmo()) {
+bool CyborWeapon::Fire(const glm::vec3& origin, const glm::vec3& direction, float currentTime, ShotInfo* outShot) {
+    CommitReload(currentTime);
+
+    if (!HasAmmo(currentTime) || m_isReloading) {
+        if (!HasAmmo(currentTime)) {
             std::cout << "Weapon empty! Reload needed." << std::endl;
         }
         return false;
     }
 
-    if (!ProcessFireRate()) {
+    // Recoil recovered since the previous shot, read before the fire time moves
+    int recoilIndex = GetRecoilIndex(currentTime);
+
+    if (!ProcessFireRate(currentTime)) {
         return false;
     }
 
@@ -95,7 +101,17 @@ bool CyborWeapon::Fire(const glm::vec3& origin, const glm::vec3& direction) {
     m_currentAmmo--;
 
     // Apply recoil
-    ApplyRecoil();
+    ApplyRecoil(recoilIndex);
+
+    if (outShot) {
+        outShot->origin = origin;
+        outShot->direction = spreadDirection;
+        outShot->damage = finalDamage;
+        outShot->range = m_range;
+        outShot->penetrationPower = m_penetrationPower;
+        outShot->blastRadius = m_blastRadius;
+        outShot->weaponType = m_type;
+    }
 
     std::cout << m_name << " fired! Ammo: " << m_currentAmmo << "/" << m_maxAmmo 
               << " (Reserve: " << m_reserveAmmo << ")" << std::endl;
@@ -103,26 +119,37 @@ bool CyborWeapon::Fire(const glm::vec3& origin, const glm::vec3& direction) {
     return true;
 }
 
-void CyborWeapon::Reload() {
-    if (CanReload() && !m_isReloading) {
-        StartReload();
+void CyborWeapon::Reload(float currentTime) {
+    CommitReload(currentTime);
+
+    if (CanReload(currentTime) && !m_isReloading) {
+        StartReload(currentTime);
     }
 }
 
-void CyborWeapon::Update(float deltaTime) {
-    // Update reload progress
-    if (m_isReloading) {
-        m_reloadProgress += deltaTime / m_reloadTime;
-        
-        if (m_reloadProgress >= 1.0f) {
-            FinishReload();
-        }
-    }
+bool CyborWeapon::CanReload(float currentTime) const {
+    return GetCurrentAmmo(currentTime) < m_maxAmmo && GetReserveAmmo(currentTime) > 0;
+}
 
-    // Recover recoil
-    if (m_currentRecoilIndex > 0) {
-        m_currentRecoilIndex = std::max(0, m_currentRecoilIndex - 1);
-    }
+bool CyborWeapon::IsReloading(float currentTime) const {
+    return m_isReloading && currentTime - m_reloadStartTime < m_reloadTime;
+}
+
+float CyborWeapon::GetReloadProgress(float currentTime) const {
+    if (!IsReloading(currentTime)) return 0.0f;
+    return (currentTime - m_reloadStartTime) / m_reloadTime;
+}
+
+int CyborWeapon::GetRecoilIndex(float currentTime) const {
+    // Recovery is continuous in time, independent of frame rate
+    int recovered = static_cast<int>((currentTime - m_lastFireTime) * m_recoilRecoveryRate);
+    return std::max(0, m_recoilIndexAtLastShot - recovered);
+}
+
+glm::vec2 CyborWeapon::GetRecoilOffset(float currentTime) const {
+    int index = GetRecoilIndex(currentTime);
+    if (index <= 0 || m_recoilPattern.empty()) return glm::vec2(0.0f);
+    return m_recoilPattern[std::min<size_t>(index, m_recoilPattern.size()) - 1] * m_recoilAmount;
 }
 
 glm::vec3 CyborWeapon::CalculateSpread(const glm::vec3& direction) {
@@ -152,16 +179,11 @@ glm::vec3 CyborWeapon::CalculateSpread(const glm::vec3& direction) {
     return glm::normalize(spreadDirection);
 }
 
-void CyborWeapon::ApplyRecoil() {
-    if (m_currentRecoilIndex < m_recoilPattern.size()) {
-        m_currentRecoilIndex++;
-    }
+void CyborWeapon::ApplyRecoil(int recoveredIndex) {
+    m_recoilIndexAtLastShot = std::min(recoveredIndex + 1, static_cast<int>(m_recoilPattern.size()));
 }
 
-bool CyborWeapon::ProcessFireRate() {
-    static float currentTime = 0.0f;
-    currentTime += 0.016f; // Assume 60 FPS
-    
+bool CyborWeapon::ProcessFireRate(float currentTime) {
     float fireRate = m_fireRate;
     if (m_cyborModeEnabled) {
         fireRate *= (1.0f - m_cyborFireRateBonus);
@@ -175,26 +197,29 @@ bool CyborWeapon::ProcessFireRate() {
     return true;
 }
 
-void CyborWeapon::StartReload() {
+void CyborWeapon::StartReload(float currentTime) {
     m_isReloading = true;
-    m_reloadProgress = 0.0f;
+    m_reloadStartTime = currentTime;
     std::cout << "Reloading " << m_name << "..." << std::endl;
 }
 
-void CyborWeapon::FinishReload() {
-    int ammoNeeded = m_maxAmmo - m_currentAmmo;
-    int ammoToAdd = std::min(ammoNeeded, m_reserveAmmo);
-    
+void CyborWeapon::CommitReload(float currentTime) {
+    int ammoToAdd = CompletedReloadAmount(currentTime);
+    if (!m_isReloading || IsReloading(currentTime)) return;
+
     m_currentAmmo += ammoToAdd;
     m_reserveAmmo -= ammoToAdd;
-    
     m_isReloading = false;
-    m_reloadProgress = 0.0f;
-    
+
     std::cout << m_name << " reloaded! Ammo: " << m_currentAmmo << "/" << m_maxAmmo 
               << " (Reserve: " << m_reserveAmmo << ")" << std::endl;
 }
 
+int CyborWeapon::CompletedReloadAmount(float currentTime) const {
+    if (!m_isReloading || currentTime - m_reloadStartTime < m_reloadTime) return 0;
+    return std::min(m_maxAmmo - m_currentAmmo, m_reserveAmmo);
+}
+
 void CyborWeapon::SetAmmo(int currentAmmo, int maxAmmo, int reserveAmmo) {
     m_currentAmmo = currentAmmo;
     m_maxAmmo = maxAmmo;
@@ -211,6 +236,7 @@ namespace CyborWeapons {
         weapon->SetRange(150.0f);
         weapon->SetRecoil(1.5f);
         weapon->SetAmmo(30, 30, 90);
+        weapon->SetPenetration(1.0f);
         return weapon;
     }
 
@@ -222,6 +248,7 @@ namespace CyborWeapons {
         weapon->SetRange(140.0f);
         weapon->SetRecoil(1.2f);
         weapon->SetAmmo(30, 30, 90);
+        weapon->SetPenetration(1.0f);
         return weapon;
     }
 
@@ -233,6 +260,7 @@ namespace CyborWeapons {
         weapon->SetRange(300.0f);
         weapon->SetRecoil(3.0f);
         weapon->SetAmmo(10, 10, 30);
+        weapon->SetPenetration(2.5f);
         return weapon;
     }
 
@@ -244,6 +272,7 @@ namespace CyborWeapons {
         weapon->SetRange(80.0f);
         weapon->SetRecoil(0.8f);
         weapon->SetAmmo(20, 20, 120);
+        weapon->SetPenetration(0.5f);
         return weapon;
     }
 
@@ -255,6 +284,20 @@ namespace CyborWeapons {
         weapon->SetRange(90.0f);
         weapon->SetRecoil(0.6f);
         weapon->SetAmmo(12, 12, 100);
+        weapon->SetPenetration(0.6f);
+        return weapon;
+    }
+
+    std::shared_ptr<CyborWeapon> CreateHEGrenade() {
+        auto weapon = std::make_shared<CyborWeapon>("HE Grenade", CyborWeapon::WeaponType::GRENADE);
+        weapon->SetDamage(98.0f);
+        weapon->SetFireRate(1.0f);
+        weapon->SetAccuracy(0.9f);
+        weapon->SetRange(20.0f); // Throw distance
+        weapon->SetRecoil(0.0f);
+        weapon->SetAmmo(1, 1, 0);
+        weapon->SetPenetration(0.0f);
+        weapon->SetBlastRadius(8.0f);
         return weapon;
     }
 
@@ -266,6 +309,7 @@ namespace CyborWeapons {
         weapon->SetRange(200.0f);
         weapon->SetRecoil(0.5f);
         weapon->SetAmmo(40, 40, 120);
+        weapon->SetPenetration(1.2f);
         weapon->EnableCyborMode(true);
         return weapon;
     }
@@ -278,6 +322,7 @@ namespace CyborWeapons {
         weapon->SetRange(500.0f);
         weapon->SetRecoil(2.5f);
         weapon->SetAmmo(5, 5, 20);
+        weapon->SetPenetration(5.0f);
         weapon->EnableCyborMode(true);
         return weapon;
     }
@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
+#include <memory>
 
 /*
  * CyborWeapon - Advanced tactical weapon system
@@ -29,14 +30,25 @@ public:
         CYBOR_ENHANCED
     };
 
+    // Result of a successful Fire() call, consumed by hit registration
+    struct ShotInfo {
+        glm::vec3 origin;
+        glm::vec3 direction;
+        float damage;
+        float range;
+        float penetrationPower;
+        float blastRadius;
+        WeaponType weaponType;
+    };
+
 public:
     CyborWeapon(const std::string& name, WeaponType type);
     ~CyborWeapon();
 
-    // Weapon actions
-    bool Fire(const glm::vec3& origin, const glm::vec3& direction);
-    void Reload();
-    void Update(float deltaTime);
+    // Weapon actions. Reload and recoil are stored as timestamps and evaluated
+    // against the owner's clock on demand, so weapons need no per-frame update.
+    bool Fire(const glm::vec3& origin, const glm::vec3& direction, float currentTime, ShotInfo* outShot = nullptr);
+    void Reload(float currentTime);
 
     // Weapon properties
     void SetDamage(float damage) { m_damage = damage; }
@@ -44,24 +56,32 @@ public:
     void SetAccuracy(float accuracy) { m_accuracy = accuracy; }
     void SetRange(float range) { m_range = range; }
     void SetRecoil(float recoil) { m_recoilAmount = recoil; }
+    void SetPenetration(float penetrationPower) { m_penetrationPower = penetrationPower; }
+    void SetBlastRadius(float radius) { m_blastRadius = radius; }
 
     // Ammo management
     void SetAmmo(int currentAmmo, int maxAmmo, int reserveAmmo);
-    bool HasAmmo() const { return m_currentAmmo > 0; }
-    bool CanReload() const { return m_currentAmmo < m_maxAmmo && m_reserveAmmo > 0; }
+    bool HasAmmo(float currentTime) const { return GetCurrentAmmo(currentTime) > 0; }
+    bool CanShoot(float currentTime) const { return HasAmmo(currentTime) && !IsReloading(currentTime); }
+    bool CanReload(float currentTime) const;
 
     // Getters
     std::string GetName() const { return m_name; }
     WeaponType GetType() const { return m_type; }
     FireMode GetFireMode() const { return m_fireMode; }
     float GetDamage() const { return m_damage; }
+    float GetFireRate() const { return m_fireRate; }
     float GetAccuracy() const { return m_accuracy; }
     float GetRange() const { return m_range; }
-    int GetCurrentAmmo() const { return m_currentAmmo; }
+    float GetPenetration() const { return m_penetrationPower; }
+    float GetBlastRadius() const { return m_blastRadius; }
+    int GetCurrentAmmo(float currentTime) const { return m_currentAmmo + CompletedReloadAmount(currentTime); }
     int GetMaxAmmo() const { return m_maxAmmo; }
-    int GetReserveAmmo() const { return m_reserveAmmo; }
-    bool IsReloading() const { return m_isReloading; }
-    float GetReloadProgress() const { return m_reloadProgress; }
+    int GetReserveAmmo(float currentTime) const { return m_reserveAmmo - CompletedReloadAmount(currentTime); }
+    bool IsReloading(float currentTime) const;
+    float GetReloadProgress(float currentTime) const;
+    int GetRecoilIndex(float currentTime) const;
+    glm::vec2 GetRecoilOffset(float currentTime) const;
 
     // Cybor enhancements
     void EnableCyborMode(bool enable) { m_cyborModeEnabled = enable; }
@@ -80,22 +100,24 @@ private:
     float m_accuracy;
     float m_range;
     float m_recoilAmount;
+    float m_penetrationPower;
+    float m_blastRadius;
 
     // Ammo system
     int m_currentAmmo;
     int m_maxAmmo;
     int m_reserveAmmo;
 
-    // State management
+    // State management (timestamps on the owner's clock)
     float m_lastFireTime;
     bool m_isReloading;
     float m_reloadTime;
-    float m_reloadProgress;
+    float m_reloadStartTime;
 
     // Recoil pattern (Counter-Strike style)
     std::vector<glm::vec2> m_recoilPattern;
-    int m_currentRecoilIndex;
-    float m_recoilRecoveryRate;
+    int m_recoilIndexAtLastShot;
+    float m_recoilRecoveryRate; // Pattern steps recovered per second
 
     // Cybor enhancements
     bool m_cyborModeEnabled;
@@ -109,11 +131,13 @@ private:
     std::string m_emptySound;
 
     // Private methods
+    void InitializeRecoilPattern();
     glm::vec3 CalculateSpread(const glm::vec3& direction);
-    void ApplyRecoil();
-    bool ProcessFireRate();
-    void StartReload();
-    void FinishReload();
+    void ApplyRecoil(int recoveredIndex);
+    bool ProcessFireRate(float currentTime);
+    void StartReload(float currentTime);
+    void CommitReload(float currentTime);
+    int CompletedReloadAmount(float currentTime) const;
 };
 
 // Pre-defined weapon configurations
@@ -123,6 +147,7 @@ namespace CyborWeapons {
     std::shared_ptr<CyborWeapon> CreateAWP();
     std::shared_ptr<CyborWeapon> CreateGlock();
     std::shared_ptr<CyborWeapon> CreateUSP();
+    std::shared_ptr<CyborWeapon> CreateHEGrenade();
     std::shared_ptr<CyborWeapon> CreateCyborPlasmaRifle();
     std::shared_ptr<CyborWeapon> CreateCyborRailgun();
 }
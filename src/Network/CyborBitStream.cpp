@@ -0,0 +1,126 @@
+#include "CyborBitStream.h"
+#include <cstring>
+
+CyborBitWriter::CyborBitWriter()
+    : m_output(nullptr), m_capacity(0), m_bytes(0), m_overflow(false),
+      m_scratch(0), m_scratchBits(0), m_bitsWritten(0) {
+}
+
+void CyborBitWriter::Reset() {
+    Reset(nullptr, 0);
+}
+
+void CyborBitWriter::Reset(uint8_t* buffer, size_t capacity) {
+    m_data.clear();
+    m_output = buffer;
+    m_capacity = capacity;
+    m_bytes = 0;
+    m_overflow = false;
+    m_scratch = 0;
+    m_scratchBits = 0;
+    m_bitsWritten = 0;
+}
+
+void CyborBitWriter::EmitByte(uint8_t value) {
+    if (!m_output) {
+        m_data.push_back(value);
+    } else if (m_bytes < m_capacity) {
+        m_output[m_bytes++] = value;
+    } else {
+        m_overflow = true;
+    }
+}
+
+void CyborBitWriter::WriteBits(uint32_t value, int bits) {
+    if (bits <= 0) return;
+    if (bits < 32) value &= (1u << bits) - 1;
+
+    m_scratch |= static_cast<uint64_t>(value) << m_scratchBits;
+    m_scratchBits += bits;
+    m_bitsWritten += bits;
+
+    while (m_scratchBits >= 8) {
+        EmitByte(static_cast<uint8_t>(m_scratch));
+        m_scratch >>= 8;
+        m_scratchBits -= 8;
+    }
+}
+
+void CyborBitWriter::WriteFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteBits(bits, 32);
+}
+
+void CyborBitWriter::AlignToByte() {
+    if (m_scratchBits > 0) WriteBits(0, 8 - m_scratchBits);
+}
+
+void CyborBitWriter::WriteBytes(const uint8_t* data, size_t size) {
+    AlignToByte();
+    for (size_t i = 0; i < size; i++) EmitByte(data[i]);
+    m_bitsWritten += size * 8;
+}
+
+void CyborBitWriter::Finish() {
+    if (m_scratchBits > 0) {
+        EmitByte(static_cast<uint8_t>(m_scratch));
+        m_bitsWritten += 8 - m_scratchBits;
+        m_scratch = 0;
+        m_scratchBits = 0;
+    }
+}
+
+CyborBitReader::CyborBitReader(const uint8_t* data, size_t size)
+    : m_data(data), m_size(size), m_bitsRead(0), m_overflow(false) {
+}
+
+uint32_t CyborBitReader::ReadBits(int bits) {
+    if (bits <= 0) return 0;
+    if (m_bitsRead + bits > m_size * 8) {
+        m_overflow = true;
+        m_bitsRead = m_size * 8;
+        return 0;
+    }
+
+    uint64_t value = 0;
+    int gathered = 0;
+    while (gathered < bits) {
+        const size_t byteIndex = m_bitsRead / 8;
+        const int bitOffset = static_cast<int>(m_bitsRead % 8);
+        const int take = (bits - gathered) < (8 - bitOffset) ? (bits - gathered) : (8 - bitOffset);
+
+        const uint64_t chunk = (m_data[byteIndex] >> bitOffset) & ((1u << take) - 1);
+        value |= chunk << gathered;
+        gathered += take;
+        m_bitsRead += take;
+    }
+    return static_cast<uint32_t>(value);
+}
+
+float CyborBitReader::ReadFloat() {
+    uint32_t bits = ReadBits(32);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void CyborBitReader::AlignToByte() {
+    m_bitsRead = (m_bitsRead + 7) / 8 * 8;
+    if (m_bitsRead > m_size * 8) {
+        m_overflow = true;
+        m_bitsRead = m_size * 8;
+    }
+}
+
+const uint8_t* CyborBitReader::ReadBytes(size_t size) {
+    AlignToByte();
+    if (m_overflow || m_bitsRead / 8 + size > m_size) {
+        m_overflow = true;
+        m_bitsRead = m_size * 8;
+        return nullptr;
+    }
+    const uint8_t* bytes = m_data + m_bitsRead / 8;
+    m_bitsRead += size * 8;
+    return bytes;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * CyborBitWriter / CyborBitReader - Bit-packed serialization for network messages
+ * Values are written LSB first with an arbitrary bit width; the reader flags
+ * overflow instead of reading past the end of a truncated packet
+ */
+class CyborBitWriter {
+public:
+    CyborBitWriter();
+
+    void Reset();
+    // Writes straight into caller memory instead of the internal buffer
+    void Reset(uint8_t* buffer, size_t capacity);
+    void WriteBits(uint32_t value, int bits);
+    void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+    void WriteFloat(float value);
+    // Pads to the next byte boundary, then copies bytes as they are
+    void AlignToByte();
+    void WriteBytes(const uint8_t* data, size_t size);
+
+    // Flushes the partial byte; call before sending
+    void Finish();
+
+    // Internal buffer only; external writes land in the caller's memory
+    const std::vector<uint8_t>& GetData() const { return m_data; }
+    size_t GetBitsWritten() const { return m_bitsWritten; }
+    size_t GetBytesWritten() const { return (m_bitsWritten + 7) / 8; }
+    bool HasOverflowed() const { return m_overflow; }
+
+private:
+    std::vector<uint8_t> m_data;
+    uint8_t* m_output;
+    size_t m_capacity;
+    size_t m_bytes;
+    bool m_overflow;
+    uint64_t m_scratch;
+    int m_scratchBits;
+    size_t m_bitsWritten;
+
+    void EmitByte(uint8_t value);
+};
+
+class CyborBitReader {
+public:
+    CyborBitReader(const uint8_t* data, size_t size);
+
+    uint32_t ReadBits(int bits);
+    bool ReadBool() { return ReadBits(1) != 0; }
+    float ReadFloat();
+    void AlignToByte();
+    // Byte-aligned data straight out of the buffer, or nullptr when it runs out
+    const uint8_t* ReadBytes(size_t size);
+
+    bool HasOverflowed() const { return m_overflow; }
+    size_t GetBitsRemaining() const { return m_size * 8 - m_bitsRead; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_bitsRead;
+    bool m_overflow;
+};
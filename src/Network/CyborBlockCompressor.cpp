@@ -0,0 +1,128 @@
+#include "CyborBlockCompressor.h"
+#include <algorithm>
+#include <cstring>
+
+static uint32_t Read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint32_t CyborBlockCompressor::Hash(const uint8_t* data) {
+    return (Read32(data) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+uint8_t* CyborBlockCompressor::WriteLength(uint8_t* out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+size_t CyborBlockCompressor::Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.resize(GetMaxCompressedSize(size));
+    uint8_t* op = out.data();
+    const uint8_t* ip = data;
+    const uint8_t* anchor = data;
+    const uint8_t* const end = data + size;
+
+    if (size > MATCH_LIMIT) {
+        // Last position seen for each hash; a stale or colliding entry just fails the compare
+        uint32_t table[1 << HASH_BITS] = {};
+        const uint8_t* const matchLimit = end - MATCH_LIMIT;
+        const uint8_t* const matchEnd = end - LAST_LITERALS;
+
+        while (ip < matchLimit) {
+            const uint32_t hash = Hash(ip);
+            const uint8_t* candidate = data + table[hash];
+            table[hash] = static_cast<uint32_t>(ip - data);
+            if (candidate >= ip || static_cast<size_t>(ip - candidate) > MAX_OFFSET || Read32(candidate) != Read32(ip)) {
+                ip++;
+                continue;
+            }
+
+            const uint8_t* matchPos = ip + MIN_MATCH;
+            const uint8_t* candidatePos = candidate + MIN_MATCH;
+            while (matchPos < matchEnd && *matchPos == *candidatePos) {
+                matchPos++;
+                candidatePos++;
+            }
+
+            // Token, literals, offset, then whatever of the match length the token can't hold
+            const size_t literals = ip - anchor;
+            const size_t matchLength = matchPos - ip - MIN_MATCH;
+            *op++ = static_cast<uint8_t>((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(matchLength, 15));
+            if (literals >= 15) op = WriteLength(op, literals - 15);
+            std::memcpy(op, anchor, literals);
+            op += literals;
+            const size_t offset = ip - candidate;
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            if (matchLength >= 15) op = WriteLength(op, matchLength - 15);
+
+            ip = matchPos;
+            anchor = ip;
+        }
+    }
+
+    // The block ends on literals alone
+    const size_t literals = end - anchor;
+    *op++ = static_cast<uint8_t>(std::min<size_t>(literals, 15) << 4);
+    if (literals >= 15) op = WriteLength(op, literals - 15);
+    if (literals > 0) std::memcpy(op, anchor, literals);
+    op += literals;
+
+    out.resize(op - out.data());
+    return out.size();
+}
+
+bool CyborBlockCompressor::Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t rawSize) {
+    const uint8_t* ip = data;
+    const uint8_t* const ipEnd = data + size;
+    uint8_t* op = out;
+    uint8_t* const opEnd = out + rawSize;
+
+    while (ip < ipEnd) {
+        const uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t extra;
+            do {
+                if (ip >= ipEnd) return false;
+                extra = *ip++;
+                literals += extra;
+            } while (extra == 255);
+        }
+        if (literals > static_cast<size_t>(ipEnd - ip) || literals > static_cast<size_t>(opEnd - op)) return false;
+        if (literals > 0) std::memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+        if (ip == ipEnd) break;
+
+        if (ipEnd - ip < 2) return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - out)) return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            uint8_t extra;
+            do {
+                if (ip >= ipEnd) return false;
+                extra = *ip++;
+                matchLength += extra;
+            } while (extra == 255);
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > static_cast<size_t>(opEnd - op)) return false;
+
+        // Byte by byte: a match may overlap the bytes it is producing
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < matchLength; i++) op[i] = match[i];
+        op += matchLength;
+    }
+    return op == opEnd;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * CyborBlockCompressor - Fast LZ77 compression of whole blocks, LZ4 style
+ * Each block is a run of sequences: a token byte holding the literal and match
+ * lengths, any literals copied as they are, then a 16-bit back reference.
+ * One hash probe per position keeps compression cheap and decompression is
+ * plain copying, so both run far faster than the disk. Blocks stand alone;
+ * nothing is shared between them, so any one can be decoded by itself.
+ */
+class CyborBlockCompressor {
+public:
+    // Worst case for incompressible input
+    static size_t GetMaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+    // Replaces out with the compressed block and returns its size
+    static size_t Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    // rawSize must be the size Compress was given; false for corrupt input
+    static bool Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t rawSize);
+
+private:
+    static constexpr int HASH_BITS = 12;
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr size_t MAX_OFFSET = 65535;
+    // The last literals are never part of a match, which keeps the decoder's copies in bounds
+    static constexpr size_t LAST_LITERALS = 5;
+    static constexpr size_t MATCH_LIMIT = 12;
+
+    static uint32_t Hash(const uint8_t* data);
+    static uint8_t* WriteLength(uint8_t* out, size_t length);
+};
@@ -0,0 +1,132 @@
+#include "CyborBroadcastRelay.h"
+#include <iostream>
+
+// The clock offset drifts back this fast, so skew between the two clocks can't pin it
+static const float CLOCK_DRIFT_SMOOTHING = 0.01f;
+
+CyborBroadcastRelay::CyborBroadcastRelay()
+    : m_running(false), m_oldest(0), m_count(0),
+      m_localTime(0.0f), m_clockOffset(0.0f), m_lastServerTime(0.0f), m_hasClock(false),
+      m_received(0), m_relayed(0) {
+}
+
+CyborBroadcastRelay::~CyborBroadcastRelay() {
+    Stop();
+}
+
+bool CyborBroadcastRelay::Start(const Settings& settings) {
+    if (m_running) return false;
+    m_settings = settings;
+
+    m_downstream.Initialize();
+    m_upstream.Initialize();
+    if (!settings.key.empty()) {
+        if (!m_upstream.SetCyborKey(settings.key) || !m_downstream.SetCyborKey(settings.key)) return false;
+        m_upstream.SetCyborEncryption(true);
+        m_downstream.SetCyborEncryption(true);
+    }
+
+    // Every tick may carry a snapshot; the buffer decides which ones go out
+    m_downstream.SetSnapshotRate(settings.tickRate * 2);
+    if (!m_downstream.StartServer(settings.port, settings.maxSpectators)) {
+        m_downstream.Shutdown();
+        m_upstream.Shutdown();
+        return false;
+    }
+
+    m_upstream.SetPlayerName(settings.name);
+    m_upstream.SetBroadcastRelay(true);
+    if (!m_upstream.ConnectToServer(settings.serverAddress, settings.serverPort)) {
+        m_downstream.Shutdown();
+        m_upstream.Shutdown();
+        return false;
+    }
+
+    m_oldest = 0;
+    m_count = 0;
+    m_localTime = 0.0f;
+    m_hasClock = false;
+    m_received = 0;
+    m_relayed = 0;
+    m_running = true;
+
+    std::cout << "Broadcast relay for " << settings.serverAddress << ":" << settings.serverPort
+              << " serving spectators on port " << settings.port << std::endl;
+    return true;
+}
+
+void CyborBroadcastRelay::Update(float deltaTime) {
+    if (!m_running) return;
+    m_localTime += deltaTime;
+
+    m_upstream.Update(deltaTime);
+    TakeSnapshot();
+
+    m_downstream.Update(deltaTime);
+    ReleaseSnapshot();
+}
+
+void CyborBroadcastRelay::Stop() {
+    if (!m_running) return;
+    m_running = false;
+    m_upstream.Shutdown();
+    m_downstream.Shutdown();
+}
+
+CyborBroadcastRelay::Stats CyborBroadcastRelay::GetStats() const {
+    Stats stats;
+    stats.connected = m_upstream.IsConnected();
+    stats.spectators = m_downstream.GetPlayerCount();
+    stats.received = m_received;
+    stats.relayed = m_relayed;
+    stats.buffered = 0.0f;
+    if (m_count > 0) {
+        const Frame& oldest = m_frames[m_oldest];
+        const Frame& newest = m_frames[(m_oldest + m_count - 1) % CAPACITY];
+        stats.buffered = newest.serverTime - oldest.serverTime;
+    }
+    stats.serverBandwidth = m_upstream.GetBandwidth();
+    stats.spectatorBandwidth = m_downstream.GetBandwidth();
+    return stats;
+}
+
+void CyborBroadcastRelay::TakeSnapshot() {
+    float serverTime;
+    if (!m_upstream.GetLatestWorldState(m_latest, serverTime)) return;
+    if (m_hasClock && serverTime <= m_lastServerTime) return;
+
+    // Like the interpolation buffer: the least delayed arrival sets the clock
+    const float offsetSample = serverTime - m_localTime;
+    if (!m_hasClock || offsetSample > m_clockOffset) {
+        m_clockOffset = offsetSample;
+    } else {
+        m_clockOffset += (offsetSample - m_clockOffset) * CLOCK_DRIFT_SMOOTHING;
+    }
+    m_lastServerTime = serverTime;
+    m_hasClock = true;
+    m_received++;
+
+    // A full buffer gives up its oldest snapshot; the spectators skip it
+    if (m_count == CAPACITY) {
+        m_oldest = (m_oldest + 1) % CAPACITY;
+        m_count--;
+    }
+    Frame& frame = GetFrame(m_count);
+    frame.serverTime = serverTime;
+    frame.entities.swap(m_latest);
+    m_count++;
+}
+
+void CyborBroadcastRelay::ReleaseSnapshot() {
+    // Snapshots are due bufferTime after the least delayed arrival would have brought them
+    const float releaseServerTime = m_localTime + m_clockOffset - m_settings.bufferTime;
+    int due = 0;
+    while (due < m_count && GetFrame(due).serverTime <= releaseServerTime) due++;
+    if (due == 0) return;
+
+    // Only the newest due goes out; each spectator's delta covers whatever it skipped
+    m_downstream.SendWorldSnapshot(GetFrame(due - 1).entities);
+    m_relayed++;
+    m_oldest = (m_oldest + due) % CAPACITY;
+    m_count -= due;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CyborNetworkManager.h"
+
+/*
+ * CyborBroadcastRelay - Fans one match's broadcast stream out to spectators
+ * Connects to the game server as its broadcast relay, so the server sends one
+ * delayed, delta-compressed world stream however many people are watching.
+ * Snapshots are held here for a short buffer that rides out jitter on the
+ * server link, then served to every spectator as an ordinary server would:
+ * each gets its own deltas against what it acknowledged, over its own
+ * reliable channel. Spectators connect with a normal client and see the
+ * whole world.
+ */
+class CyborBroadcastRelay {
+public:
+    static constexpr int CAPACITY = 256; // Buffered snapshots
+
+    struct Settings {
+        std::string serverAddress = "127.0.0.1";
+        int serverPort = 27015;
+        int port = 27020;         // Spectators connect here
+        int maxSpectators = 64;
+        int tickRate = 64;        // Update calls per second
+        float bufferTime = 0.1f;  // Seconds each snapshot is held before going out
+        std::string name = "CyborRelay";
+        std::string key;          // 64 hex digits; encrypts both sides when set
+    };
+
+    struct Stats {
+        bool connected;
+        int spectators;
+        uint64_t received;        // Snapshots taken from the server
+        uint64_t relayed;         // Snapshots sent on to the spectators
+        float buffered;           // Seconds of snapshots held right now
+        float serverBandwidth;    // Bytes per second to and from the server
+        float spectatorBandwidth; // Bytes per second to and from all spectators
+    };
+
+public:
+    CyborBroadcastRelay();
+    ~CyborBroadcastRelay();
+
+    bool Start(const Settings& settings);
+    void Update(float deltaTime);
+    void Stop();
+
+    bool IsConnected() const { return m_upstream.IsConnected(); }
+    Stats GetStats() const;
+
+private:
+    struct Frame {
+        float serverTime;
+        std::vector<CyborSnapshotCodec::EntityState> entities;
+    };
+
+    Settings m_settings;
+    CyborNetworkManager m_upstream;   // Client of the game server
+    CyborNetworkManager m_downstream; // Server to the spectators
+    bool m_running;
+
+    // Ring of snapshots waiting out the buffer, oldest first
+    Frame m_frames[CAPACITY];
+    int m_oldest;
+    int m_count;
+    std::vector<CyborSnapshotCodec::EntityState> m_latest;
+
+    // Relay clock, and the server's ahead of it for the least delayed arrivals
+    float m_localTime;
+    float m_clockOffset;
+    float m_lastServerTime;
+    bool m_hasClock;
+
+    uint64_t m_received;
+    uint64_t m_relayed;
+
+    // Private methods
+    void TakeSnapshot();
+    void ReleaseSnapshot();
+    Frame& GetFrame(int age) { return m_frames[(m_oldest + age) % CAPACITY]; }
+};
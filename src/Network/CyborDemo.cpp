@@ -0,0 +1,458 @@
+#include "CyborDemo.h"
+#include "CyborBlockCompressor.h"
+#include "CyborMessageSchema.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+// File layout, all little-endian:
+//   header   magic, version, quantization settings, snapshot interval
+//   blocks   block header, then the compressed records; each block opens with a keyframe
+//   index    first tick, last tick, first server time and file offset of every block
+//   footer   index offset, block count, index magic
+static const uint8_t DEMO_MAGIC[8] = { 'C', 'Y', 'B', 'R', 'D', 'E', 'M', 'O' };
+static const uint8_t INDEX_MAGIC[8] = { 'C', 'Y', 'B', 'R', 'I', 'D', 'X', '1' };
+static const uint32_t DEMO_VERSION = 1;
+static const uint32_t BLOCK_MAGIC = 0x4B425943; // "CYBK"
+static const size_t HEADER_SIZE = 44;
+static const size_t BLOCK_HEADER_SIZE = 28;
+static const size_t INDEX_ENTRY_SIZE = 20;
+static const size_t FOOTER_SIZE = 20;
+// Larger sizes in a block header mean a corrupt file, not a real block
+static const uint32_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+// Record kinds inside a block
+static const uint32_t RECORD_SNAPSHOT = 0;
+static const uint32_t RECORD_EVENT = 1;
+
+struct DemoEventRecord {
+    CyborNetworkManager::GameEvent::Type type;
+    uint32_t subjectId;
+    uint32_t instigatorId;
+    int32_t value;
+    std::string_view text;
+};
+using DemoEventSchema = CyborMessageSchema<CyborField<&DemoEventRecord::type>,
+                                           CyborField<&DemoEventRecord::subjectId>,
+                                           CyborField<&DemoEventRecord::instigatorId>,
+                                           CyborField<&DemoEventRecord::value>,
+                                           CyborField<&DemoEventRecord::text>>;
+
+static void Put32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static void Put64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static void PutFloat(uint8_t* out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Put32(out, bits);
+}
+
+static uint32_t Get32(const uint8_t* data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(data[i]) << (8 * i);
+    return value;
+}
+
+static uint64_t Get64(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    return value;
+}
+
+static float GetFloat(const uint8_t* data) {
+    const uint32_t bits = Get32(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool ReadAt(std::FILE* file, uint64_t offset, uint8_t* out, size_t size) {
+    return std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0 && std::fread(out, 1, size, file) == size;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+CyborDemoWriter::CyborDemoWriter()
+    : m_keyframeInterval(DEFAULT_KEYFRAME_INTERVAL), m_tick(0), m_blockHasSnapshot(false), m_blockFirstTick(0),
+      m_blockStartTime(0.0f), m_blockRecords(0), m_droppedBlocks(0), m_stopping(false),
+      m_file(nullptr), m_offset(0), m_failed(false), m_rawBytes(0) {
+}
+
+CyborDemoWriter::~CyborDemoWriter() {
+    Close();
+}
+
+bool CyborDemoWriter::Open(const std::string& path, const CyborSnapshotCodec::QuantizationSettings& quantization,
+                           float snapshotInterval, float keyframeInterval) {
+    if (IsOpen()) return false;
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Cannot create demo file " << path << std::endl;
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE] = {};
+    std::memcpy(header, DEMO_MAGIC, sizeof(DEMO_MAGIC));
+    Put32(header + 8, DEMO_VERSION);
+    for (int axis = 0; axis < 3; axis++) {
+        PutFloat(header + 12 + 4 * axis, quantization.worldMin[axis]);
+        PutFloat(header + 24 + 4 * axis, quantization.worldMax[axis]);
+    }
+    header[36] = static_cast<uint8_t>(quantization.positionBits);
+    header[37] = static_cast<uint8_t>(quantization.angleBits);
+    header[38] = static_cast<uint8_t>(quantization.positionDeltaBits);
+    PutFloat(header + 40, snapshotInterval);
+    m_offset = 0;
+    m_failed = false;
+    if (!Write(header, sizeof(header))) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+
+    m_codec = CyborSnapshotCodec(quantization);
+    m_block.Reset();
+    m_keyframeInterval = keyframeInterval;
+    m_tick = 0;
+    m_blockHasSnapshot = false;
+    m_blockRecords = 0;
+    m_droppedBlocks = 0;
+    m_index.clear();
+    m_rawBytes = 0;
+    m_stopping = false;
+    m_thread = std::thread(&CyborDemoWriter::RunIo, this);
+
+    std::cout << "Recording demo to " << path << std::endl;
+    return true;
+}
+
+void CyborDemoWriter::Close() {
+    if (!IsOpen()) return;
+
+    FlushBlock();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    // The I/O thread is gone; its state is ours now
+    std::vector<uint8_t> index(m_index.size() * INDEX_ENTRY_SIZE + FOOTER_SIZE);
+    uint8_t* out = index.data();
+    for (const IndexEntry& entry : m_index) {
+        Put32(out, entry.firstTick);
+        Put32(out + 4, entry.lastTick);
+        PutFloat(out + 8, entry.firstTime);
+        Put64(out + 12, entry.offset);
+        out += INDEX_ENTRY_SIZE;
+    }
+    Put64(out, m_offset);
+    Put32(out + 8, static_cast<uint32_t>(m_index.size()));
+    std::memcpy(out + 12, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    Write(index.data(), index.size());
+    std::fclose(m_file);
+    m_file = nullptr;
+
+    std::cout << "Demo closed: " << m_tick << " ticks in " << m_index.size() << " blocks, " << m_offset / 1024
+              << " KiB (" << m_rawBytes / 1024 << " KiB before compression)";
+    if (m_droppedBlocks > 0) std::cout << ", " << m_droppedBlocks << " blocks dropped";
+    std::cout << std::endl;
+}
+
+void CyborDemoWriter::AddSnapshot(const CyborSnapshotCodec::Snapshot& snapshot) {
+    if (!IsOpen()) return;
+
+    if (m_blockHasSnapshot && snapshot.serverTime - m_blockStartTime >= m_keyframeInterval) FlushBlock();
+    const bool keyframe = !m_blockHasSnapshot;
+    if (keyframe) {
+        m_blockFirstTick = m_tick;
+        m_blockStartTime = snapshot.serverTime;
+        m_blockHasSnapshot = true;
+    }
+
+    m_current.sequence = static_cast<uint16_t>(m_tick);
+    m_current.serverTime = snapshot.serverTime;
+    m_current.entities.assign(snapshot.entities.begin(), snapshot.entities.end());
+
+    m_block.WriteBits(RECORD_SNAPSHOT, 8);
+    m_block.WriteBits(m_tick, 32);
+    m_codec.Encode(m_current, keyframe ? nullptr : &m_previous, m_block);
+    m_block.AlignToByte();
+    m_blockRecords++;
+
+    std::swap(m_current, m_previous);
+    m_tick++;
+}
+
+void CyborDemoWriter::AddEvent(const CyborNetworkManager::GameEvent& event) {
+    if (!IsOpen()) return;
+
+    m_block.WriteBits(RECORD_EVENT, 8);
+    m_block.WriteBits(m_tick, 32);
+    DemoEventSchema::Write({ event.type, event.subjectId, event.instigatorId, event.value, event.text }, m_block);
+    m_block.AlignToByte();
+    m_blockRecords++;
+}
+
+void CyborDemoWriter::FlushBlock() {
+    if (m_blockRecords == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending.size() >= MAX_PENDING_BLOCKS) {
+            // The next block opens with a keyframe, so the demo only loses this stretch
+            if (m_droppedBlocks++ == 0) std::cerr << "Demo writer is behind the disk; dropping blocks" << std::endl;
+        } else {
+            PendingBlock block;
+            block.firstTick = m_blockHasSnapshot ? m_blockFirstTick : m_tick;
+            block.lastTick = m_blockHasSnapshot ? m_tick - 1 : m_tick;
+            block.firstTime = m_blockHasSnapshot ? m_blockStartTime : m_previous.serverTime;
+            block.records = m_blockRecords;
+            if (!m_spareBuffers.empty()) {
+                block.data = std::move(m_spareBuffers.back());
+                m_spareBuffers.pop_back();
+            }
+            block.data.assign(m_block.GetData().begin(), m_block.GetData().end());
+            m_pending.push_back(std::move(block));
+        }
+    }
+    m_wake.notify_one();
+
+    m_block.Reset();
+    m_blockHasSnapshot = false;
+    m_blockRecords = 0;
+}
+
+void CyborDemoWriter::RunIo() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+        if (m_pending.empty()) return;
+
+        PendingBlock block = std::move(m_pending.front());
+        m_pending.pop_front();
+        lock.unlock();
+        WriteBlock(block);
+        lock.lock();
+        m_spareBuffers.push_back(std::move(block.data));
+    }
+}
+
+void CyborDemoWriter::WriteBlock(const PendingBlock& block) {
+    CyborBlockCompressor::Compress(block.data.data(), block.data.size(), m_compressed);
+
+    uint8_t header[BLOCK_HEADER_SIZE];
+    Put32(header, BLOCK_MAGIC);
+    Put32(header + 4, block.firstTick);
+    Put32(header + 8, block.lastTick);
+    PutFloat(header + 12, block.firstTime);
+    Put32(header + 16, block.records);
+    Put32(header + 20, static_cast<uint32_t>(block.data.size()));
+    Put32(header + 24, static_cast<uint32_t>(m_compressed.size()));
+
+    const uint64_t offset = m_offset;
+    if (!Write(header, sizeof(header)) || !Write(m_compressed.data(), m_compressed.size())) return;
+    m_index.push_back({ block.firstTick, block.lastTick, block.firstTime, offset });
+    m_rawBytes += block.data.size();
+}
+
+bool CyborDemoWriter::Write(const uint8_t* data, size_t size) {
+    if (m_failed) return false;
+    if (std::fwrite(data, 1, size, m_file) != size) {
+        std::cerr << "Demo write failed; the rest of the recording is lost" << std::endl;
+        m_failed = true;
+        return false;
+    }
+    m_offset += size;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+CyborDemoReader::CyborDemoReader()
+    : m_file(nullptr), m_snapshotInterval(0.0f), m_nextBlock(0), m_reader(nullptr, 0), m_recordsLeft(0),
+      m_type(RecordType::SNAPSHOT), m_tick(0), m_event() {
+}
+
+CyborDemoReader::~CyborDemoReader() {
+    Close();
+}
+
+bool CyborDemoReader::Open(const std::string& path) {
+    Close();
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file) {
+        std::cerr << "Cannot open demo file " << path << std::endl;
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE];
+    if (!ReadAt(m_file, 0, header, sizeof(header)) || std::memcmp(header, DEMO_MAGIC, sizeof(DEMO_MAGIC)) != 0 ||
+        Get32(header + 8) != DEMO_VERSION) {
+        std::cerr << path << " is not a Cybor demo of a version this build reads" << std::endl;
+        Close();
+        return false;
+    }
+    CyborSnapshotCodec::QuantizationSettings quantization;
+    for (int axis = 0; axis < 3; axis++) {
+        quantization.worldMin[axis] = GetFloat(header + 12 + 4 * axis);
+        quantization.worldMax[axis] = GetFloat(header + 24 + 4 * axis);
+    }
+    quantization.positionBits = header[36];
+    quantization.angleBits = header[37];
+    quantization.positionDeltaBits = header[38];
+    m_codec = CyborSnapshotCodec(quantization);
+    m_snapshotInterval = GetFloat(header + 40);
+
+    std::fseek(m_file, 0, SEEK_END);
+    const uint64_t fileSize = static_cast<uint64_t>(std::ftell(m_file));
+    if (!ReadIndex(fileSize)) {
+        RebuildIndex(fileSize);
+        std::cerr << path << " has no index, the recording was cut short; found " << m_index.size()
+                  << " blocks" << std::endl;
+    }
+
+    Rewind();
+    return true;
+}
+
+void CyborDemoReader::Close() {
+    if (m_file) std::fclose(m_file);
+    m_file = nullptr;
+    m_index.clear();
+    m_recordsLeft = 0;
+}
+
+void CyborDemoReader::Rewind() {
+    m_nextBlock = 0;
+    m_recordsLeft = 0;
+}
+
+bool CyborDemoReader::Seek(uint32_t tick) {
+    // The last block starting at or before the tick holds it
+    auto it = std::upper_bound(m_index.begin(), m_index.end(), tick,
+        [](uint32_t value, const IndexEntry& entry) { return value < entry.firstTick; });
+    size_t block = it == m_index.begin() ? 0 : static_cast<size_t>(it - m_index.begin()) - 1;
+
+    // A dropped block leaves a gap; the tick then resolves to the next snapshot there is
+    for (; block < m_index.size(); block++) {
+        if (!LoadBlock(block)) return false;
+        while (m_recordsLeft > 0) {
+            if (!ReadRecord()) return false;
+            if (m_type == RecordType::SNAPSHOT && m_tick >= tick) return true;
+        }
+    }
+    return false;
+}
+
+bool CyborDemoReader::Next() {
+    while (m_recordsLeft == 0) {
+        if (m_nextBlock >= m_index.size() || !LoadBlock(m_nextBlock)) return false;
+    }
+    return ReadRecord();
+}
+
+void CyborDemoReader::GetEntityStates(std::vector<CyborSnapshotCodec::EntityState>& outStates) const {
+    outStates.resize(m_snapshot.entities.size());
+    for (size_t i = 0; i < m_snapshot.entities.size(); i++) m_codec.Dequantize(m_snapshot.entities[i], outStates[i]);
+}
+
+bool CyborDemoReader::ReadIndex(uint64_t fileSize) {
+    uint8_t footer[FOOTER_SIZE];
+    if (fileSize < HEADER_SIZE + FOOTER_SIZE || !ReadAt(m_file, fileSize - FOOTER_SIZE, footer, sizeof(footer)) ||
+        std::memcmp(footer + 12, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        return false;
+    }
+    const uint64_t indexOffset = Get64(footer);
+    const uint32_t count = Get32(footer + 8);
+    if (indexOffset + static_cast<uint64_t>(count) * INDEX_ENTRY_SIZE + FOOTER_SIZE != fileSize) return false;
+
+    std::vector<uint8_t> index(count * INDEX_ENTRY_SIZE);
+    if (count > 0 && !ReadAt(m_file, indexOffset, index.data(), index.size())) return false;
+    m_index.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* entry = index.data() + i * INDEX_ENTRY_SIZE;
+        m_index[i] = { Get32(entry), Get32(entry + 4), GetFloat(entry + 8), Get64(entry + 12) };
+    }
+    return true;
+}
+
+void CyborDemoReader::RebuildIndex(uint64_t fileSize) {
+    m_index.clear();
+    uint64_t offset = HEADER_SIZE;
+    uint8_t header[BLOCK_HEADER_SIZE];
+    while (offset + BLOCK_HEADER_SIZE <= fileSize && ReadAt(m_file, offset, header, sizeof(header))) {
+        const uint32_t compressedSize = Get32(header + 24);
+        if (Get32(header) != BLOCK_MAGIC || compressedSize > MAX_BLOCK_SIZE ||
+            offset + BLOCK_HEADER_SIZE + compressedSize > fileSize) {
+            break;
+        }
+        m_index.push_back({ Get32(header + 4), Get32(header + 8), GetFloat(header + 12), offset });
+        offset += BLOCK_HEADER_SIZE + compressedSize;
+    }
+}
+
+bool CyborDemoReader::LoadBlock(size_t index) {
+    m_recordsLeft = 0;
+    m_nextBlock = index + 1;
+
+    uint8_t header[BLOCK_HEADER_SIZE];
+    if (!ReadAt(m_file, m_index[index].offset, header, sizeof(header)) || Get32(header) != BLOCK_MAGIC) return false;
+    const uint32_t records = Get32(header + 16);
+    const uint32_t rawSize = Get32(header + 20);
+    const uint32_t compressedSize = Get32(header + 24);
+    if (rawSize > MAX_BLOCK_SIZE || compressedSize > MAX_BLOCK_SIZE) return false;
+
+    m_compressed.resize(compressedSize);
+    m_blockData.resize(rawSize);
+    if (std::fread(m_compressed.data(), 1, compressedSize, m_file) != compressedSize ||
+        !CyborBlockCompressor::Decompress(m_compressed.data(), compressedSize, m_blockData.data(), rawSize)) {
+        std::cerr << "Demo block " << index << " is corrupt" << std::endl;
+        return false;
+    }
+
+    // Every block opens with a keyframe, so nothing before it is needed
+    m_reader = CyborBitReader(m_blockData.data(), m_blockData.size());
+    m_history.Clear();
+    m_recordsLeft = records;
+    return true;
+}
+
+bool CyborDemoReader::ReadRecord() {
+    m_recordsLeft--;
+    const uint32_t kind = m_reader.ReadBits(8);
+    m_tick = m_reader.ReadBits(32);
+
+    bool valid = false;
+    if (kind == RECORD_SNAPSHOT) {
+        m_type = RecordType::SNAPSHOT;
+        valid = m_codec.Decode(m_reader, m_history, m_snapshot);
+        if (valid) m_history.Store(m_snapshot);
+    } else if (kind == RECORD_EVENT) {
+        m_type = RecordType::EVENT;
+        DemoEventRecord record;
+        valid = DemoEventSchema::Read(m_reader, record);
+        m_event.type = record.type;
+        m_event.subjectId = record.subjectId;
+        m_event.instigatorId = record.instigatorId;
+        m_event.value = record.value;
+        m_event.text.assign(record.text);
+    }
+    m_reader.AlignToByte();
+
+    if (!valid || m_reader.HasOverflowed()) {
+        std::cerr << "Demo record at tick " << m_tick << " is corrupt" << std::endl;
+        m_recordsLeft = 0;
+        m_nextBlock = m_index.size();
+        return false;
+    }
+    return true;
+}
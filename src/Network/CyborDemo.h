@@ -0,0 +1,168 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CyborBitStream.h"
+#include "CyborSnapshot.h"
+#include "CyborNetworkManager.h"
+
+/*
+ * CyborDemoWriter - Records a server's snapshots and game events to a demo file
+ * Snapshots are delta-encoded against the one before, the same way they go
+ * over the wire, and grouped into blocks that each open with a full keyframe
+ * so any block decodes on its own. Finished blocks are handed to a background
+ * thread that compresses and writes them; the game thread only encodes. An
+ * index of the blocks' first ticks goes at the end of the file.
+ */
+class CyborDemoWriter {
+public:
+    static constexpr float DEFAULT_KEYFRAME_INTERVAL = 5.0f; // Seconds per block
+    static constexpr size_t MAX_PENDING_BLOCKS = 64;         // Past this the disk is behind; blocks are dropped
+
+public:
+    CyborDemoWriter();
+    ~CyborDemoWriter();
+
+    bool Open(const std::string& path, const CyborSnapshotCodec::QuantizationSettings& quantization,
+              float snapshotInterval, float keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+    // Writes what is left, the index and the footer
+    void Close();
+    bool IsOpen() const { return m_thread.joinable(); }
+
+    // Game thread. Each snapshot is the next tick; events belong before the snapshot that follows them.
+    void AddSnapshot(const CyborSnapshotCodec::Snapshot& snapshot);
+    void AddEvent(const CyborNetworkManager::GameEvent& event);
+
+    uint32_t GetTickCount() const { return m_tick; }
+
+private:
+    struct PendingBlock {
+        uint32_t firstTick;
+        uint32_t lastTick;
+        float firstTime;
+        uint32_t records;
+        std::vector<uint8_t> data;
+    };
+
+    struct IndexEntry {
+        uint32_t firstTick;
+        uint32_t lastTick;
+        float firstTime;
+        uint64_t offset;
+    };
+
+    // Game thread
+    CyborSnapshotCodec m_codec;
+    CyborBitWriter m_block;
+    CyborSnapshotCodec::Snapshot m_current;  // Renumbered by tick so baselines never collide
+    CyborSnapshotCodec::Snapshot m_previous;
+    float m_keyframeInterval;
+    uint32_t m_tick;
+    bool m_blockHasSnapshot; // False until the block's keyframe
+    uint32_t m_blockFirstTick;
+    float m_blockStartTime;
+    uint32_t m_blockRecords;
+    uint32_t m_droppedBlocks;
+
+    // Shared with the I/O thread
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<PendingBlock> m_pending;
+    std::vector<std::vector<uint8_t>> m_spareBuffers;
+    bool m_stopping;
+
+    // I/O thread, then Close once it has stopped
+    std::FILE* m_file;
+    uint64_t m_offset;
+    bool m_failed;
+    std::vector<IndexEntry> m_index;
+    std::vector<uint8_t> m_compressed;
+    uint64_t m_rawBytes;
+
+    // Private methods
+    void FlushBlock();
+    void RunIo();
+    void WriteBlock(const PendingBlock& block);
+    bool Write(const uint8_t* data, size_t size);
+};
+
+/*
+ * CyborDemoReader - Plays back a demo file, record by record
+ * Seeking finds the block holding a tick by binary search over the index,
+ * then decodes that one block from its keyframe; nothing before it is read.
+ * A demo whose recording was cut short has no index; it is rebuilt by
+ * walking the block headers.
+ */
+class CyborDemoReader {
+public:
+    enum class RecordType {
+        SNAPSHOT,
+        EVENT
+    };
+
+public:
+    CyborDemoReader();
+    ~CyborDemoReader();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    uint32_t GetTickCount() const { return m_index.empty() ? 0 : m_index.back().lastTick + 1; }
+    float GetSnapshotInterval() const { return m_snapshotInterval; }
+    size_t GetBlockCount() const { return m_index.size(); }
+    const CyborSnapshotCodec& GetCodec() const { return m_codec; }
+
+    // Back to before the first record
+    void Rewind();
+    // Moves to the snapshot at tick, or the first one after it; false past the end.
+    // Events of that tick come before its snapshot and are skipped.
+    bool Seek(uint32_t tick);
+    // Moves to the next record; false at the end or on a corrupt block
+    bool Next();
+
+    // The current record
+    RecordType GetRecordType() const { return m_type; }
+    uint32_t GetTick() const { return m_tick; }
+    const CyborSnapshotCodec::Snapshot& GetSnapshot() const { return m_snapshot; }
+    void GetEntityStates(std::vector<CyborSnapshotCodec::EntityState>& outStates) const;
+    const CyborNetworkManager::GameEvent& GetEvent() const { return m_event; }
+
+private:
+    struct IndexEntry {
+        uint32_t firstTick;
+        uint32_t lastTick;
+        float firstTime;
+        uint64_t offset;
+    };
+
+    std::FILE* m_file;
+    CyborSnapshotCodec m_codec;
+    float m_snapshotInterval;
+    std::vector<IndexEntry> m_index;
+
+    // Decoded block being read
+    size_t m_nextBlock;
+    std::vector<uint8_t> m_compressed;
+    std::vector<uint8_t> m_blockData;
+    CyborBitReader m_reader;
+    uint32_t m_recordsLeft;
+    CyborSnapshotHistory m_history; // Baselines for the deltas
+
+    RecordType m_type;
+    uint32_t m_tick;
+    CyborSnapshotCodec::Snapshot m_snapshot;
+    CyborNetworkManager::GameEvent m_event;
+
+    // Private methods
+    bool ReadIndex(uint64_t fileSize);
+    void RebuildIndex(uint64_t fileSize);
+    bool LoadBlock(size_t index);
+    bool ReadRecord();
+};
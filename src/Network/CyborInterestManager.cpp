@@ -0,0 +1,109 @@
+#include "CyborInterestManager.h"
+#include "../Game/CyborCollisionWorld.h"
+#include <algorithm>
+
+// Coarser than the hit-registration grid; relevancy queries cover a much larger radius
+static const float INTEREST_CELL_SIZE = 16.0f;
+
+CyborInterestManager::CyborInterestManager()
+    : m_relevancyRadius(48.0f), m_proximityRadius(6.0f), m_visibilityLinger(0.5f),
+      m_collisionWorld(nullptr), m_grid(INTEREST_CELL_SIZE) {
+}
+
+CyborInterestManager::~CyborInterestManager() {
+}
+
+void CyborInterestManager::Update(const std::vector<CyborSnapshotCodec::EntityState>& entities,
+                                  const std::vector<Viewer>& viewers, float currentTime) {
+    m_grid.Clear();
+    for (const auto& entity : entities) {
+        m_grid.Insert(entity.entityId, entity.position, entity.team);
+    }
+    m_grid.Build();
+
+    m_viewerPositions.resize(viewers.size());
+    m_relevantEntities.resize(viewers.size());
+    m_hiddenEntities.resize(viewers.size());
+
+    const float proximitySq = m_proximityRadius * m_proximityRadius;
+
+    for (size_t v = 0; v < viewers.size(); v++) {
+        const Viewer& viewer = viewers[v];
+        std::vector<uint32_t>& relevant = m_relevantEntities[v];
+        std::vector<uint32_t>& hidden = m_hiddenEntities[v];
+        std::vector<Linger>& lingers = m_lingers[viewer.viewerId];
+        m_viewerPositions[v] = viewer.position;
+        relevant.clear();
+        hidden.clear();
+
+        m_candidates.clear();
+        m_grid.QueryRadius(viewer.position, m_relevancyRadius, m_candidates);
+
+        // Self, teammates and anything close enough to be heard are always relevant;
+        // everyone else has to pass line of sight
+        m_occlusionTargets.clear();
+        m_occlusionIds.clear();
+        for (const auto& candidate : m_candidates) {
+            glm::vec3 offset = candidate.position - viewer.position;
+            if (candidate.entityId == viewer.entityId ||
+                (viewer.team != NO_TEAM && candidate.tag == viewer.team) ||
+                glm::dot(offset, offset) <= proximitySq) {
+                relevant.push_back(candidate.entityId);
+            } else if (m_collisionWorld) {
+                m_occlusionTargets.push_back(candidate.position);
+                m_occlusionIds.push_back(candidate.entityId);
+            } else {
+                relevant.push_back(candidate.entityId);
+            }
+        }
+
+        if (!m_occlusionTargets.empty()) {
+            m_occluded.resize(m_occlusionTargets.size());
+            m_collisionWorld->TestOcclusion(viewer.position, m_occlusionTargets.data(),
+                                            m_occlusionTargets.size(), m_occluded.data());
+
+            for (size_t i = 0; i < m_occlusionIds.size(); i++) {
+                const uint32_t entityId = m_occlusionIds[i];
+                auto linger = std::find_if(lingers.begin(), lingers.end(),
+                    [entityId](const Linger& entry) { return entry.entityId == entityId; });
+
+                if (!m_occluded[i]) {
+                    relevant.push_back(entityId);
+                    if (linger != lingers.end()) {
+                        linger->expiryTime = currentTime + m_visibilityLinger;
+                    } else {
+                        lingers.push_back({ entityId, currentTime + m_visibilityLinger });
+                    }
+                } else if (linger != lingers.end() && linger->expiryTime > currentTime) {
+                    relevant.push_back(entityId);
+                    hidden.push_back(entityId);
+                }
+            }
+        }
+
+        lingers.erase(std::remove_if(lingers.begin(), lingers.end(),
+            [currentTime](const Linger& entry) { return entry.expiryTime <= currentTime; }), lingers.end());
+
+        std::sort(relevant.begin(), relevant.end());
+        std::sort(hidden.begin(), hidden.end());
+    }
+
+    // Forget viewers that left
+    for (auto it = m_lingers.begin(); it != m_lingers.end();) {
+        const uint32_t viewerId = it->first;
+        bool present = std::any_of(viewers.begin(), viewers.end(),
+            [viewerId](const Viewer& viewer) { return viewer.viewerId == viewerId; });
+        it = present ? std::next(it) : m_lingers.erase(it);
+    }
+}
+
+void CyborInterestManager::GetViewersInRange(const glm::vec3& position, std::vector<size_t>& outViewers) const {
+    outViewers.clear();
+    const float radiusSq = m_relevancyRadius * m_relevancyRadius;
+    for (size_t v = 0; v < m_viewerPositions.size(); v++) {
+        glm::vec3 offset = m_viewerPositions[v] - position;
+        if (glm::dot(offset, offset) <= radiusSq) {
+            outViewers.push_back(v);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "CyborSnapshot.h"
+#include "../Game/CyborSpatialGrid.h"
+
+class CyborCollisionWorld;
+
+/*
+ * CyborInterestManager - Per-client relevancy culling
+ * Each tick the entity set is bucketed into a spatial grid and every viewer
+ * only looks at its own neighbourhood, so cost follows local density rather
+ * than players x entities. Enemies outside close range must also be visible
+ * through the collision world when one is set.
+ */
+class CyborInterestManager {
+public:
+    struct Viewer {
+        uint32_t viewerId; // Stable across ticks, e.g. the peer id
+        uint32_t entityId; // Entity the viewer controls, always relevant
+        glm::vec3 position;
+        uint8_t team;      // NO_TEAM shares nothing
+    };
+
+    static constexpr uint8_t NO_TEAM = 0xFF;
+    static constexpr uint32_t NO_ENTITY = 0xFFFFFFFFu;
+
+public:
+    CyborInterestManager();
+    ~CyborInterestManager();
+
+    // Configuration
+    void SetRelevancyRadius(float radius) { m_relevancyRadius = radius; }
+    void SetProximityRadius(float radius) { m_proximityRadius = radius; }
+    void SetVisibilityLinger(float seconds) { m_visibilityLinger = seconds; }
+    void SetCollisionWorld(const CyborCollisionWorld* collisionWorld) { m_collisionWorld = collisionWorld; }
+    float GetRelevancyRadius() const { return m_relevancyRadius; }
+
+    // Recomputes every viewer's relevant set
+    void Update(const std::vector<CyborSnapshotCodec::EntityState>& entities,
+                const std::vector<Viewer>& viewers, float currentTime);
+
+    // Sorted entity ids relevant to viewers[viewerIndex] as of the last Update
+    const std::vector<uint32_t>& GetRelevantEntities(size_t viewerIndex) const { return m_relevantEntities[viewerIndex]; }
+    // The sorted subset that is out of sight, kept only because it was seen a moment ago
+    const std::vector<uint32_t>& GetHiddenEntities(size_t viewerIndex) const { return m_hiddenEntities[viewerIndex]; }
+
+    // Viewers within relevancy range of a positional event
+    void GetViewersInRange(const glm::vec3& position, std::vector<size_t>& outViewers) const;
+
+private:
+    struct Linger {
+        uint32_t entityId;
+        float expiryTime;
+    };
+
+    float m_relevancyRadius;
+    float m_proximityRadius;
+    float m_visibilityLinger;
+    const CyborCollisionWorld* m_collisionWorld;
+
+    CyborSpatialGrid m_grid;
+    std::vector<glm::vec3> m_viewerPositions;
+    std::vector<std::vector<uint32_t>> m_relevantEntities;
+    std::vector<std::vector<uint32_t>> m_hiddenEntities;
+
+    // Recently visible enemies stay relevant briefly so they don't pop at corners
+    std::unordered_map<uint32_t, std::vector<Linger>> m_lingers;
+
+    // Scratch buffers reused every tick
+    std::vector<CyborSpatialGrid::Entry> m_candidates;
+    std::vector<glm::vec3> m_occlusionTargets;
+    std::vector<uint32_t> m_occlusionIds;
+    std::vector<uint8_t> m_occluded;
+};
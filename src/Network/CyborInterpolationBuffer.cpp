@@ -0,0 +1,143 @@
+#include "CyborInterpolationBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+// Smoothing factors for the timing estimates
+static const float INTERVAL_SMOOTHING = 0.1f;
+static const float JITTER_SMOOTHING = 1.0f / 16.0f; // RFC 3550 gain
+static const float DELAY_SMOOTHING = 0.05f;
+static const float CLOCK_DRIFT_SMOOTHING = 0.01f;
+static const float JITTER_MARGIN = 2.5f;
+
+CyborInterpolationBuffer::CyborInterpolationBuffer()
+    : m_newest(-1), m_count(0),
+      m_clockOffset(0.0f), m_lastSequence(0), m_lastServerTime(0.0f), m_lastLocalTime(0.0f),
+      m_snapshotInterval(1.0f / 64.0f), m_jitter(0.0f), m_delay(2.0f / 64.0f),
+      m_minimumDelay(1.0f / 64.0f), m_maxExtrapolation(0.1f) {
+}
+
+CyborInterpolationBuffer::~CyborInterpolationBuffer() {
+}
+
+void CyborInterpolationBuffer::Clear() {
+    m_newest = -1;
+    m_count = 0;
+    m_jitter = 0.0f;
+    m_delay = 2.0f * m_snapshotInterval;
+}
+
+void CyborInterpolationBuffer::AddSnapshot(uint16_t sequence, float serverTime, float localTime,
+                                           const std::vector<CyborSnapshotCodec::EntityState>& entities) {
+    // Late arrivals are useless once a newer snapshot is in
+    if (m_count > 0 && serverTime <= GetFrame(0).serverTime) return;
+
+    const float offsetSample = serverTime - localTime;
+    if (m_count == 0) {
+        m_clockOffset = offsetSample;
+    } else {
+        const float serverDelta = serverTime - m_lastServerTime;
+        const float localDelta = localTime - m_lastLocalTime;
+
+        // Divide out gaps left by lost snapshots
+        const uint16_t sequenceDelta = static_cast<uint16_t>(sequence - m_lastSequence);
+        if (sequenceDelta > 0) {
+            m_snapshotInterval += (serverDelta / sequenceDelta - m_snapshotInterval) * INTERVAL_SMOOTHING;
+        }
+        m_jitter += (std::fabs(localDelta - serverDelta) - m_jitter) * JITTER_SMOOTHING;
+
+        // Track the least delayed arrival; drift back slowly so clock skew can't pin it
+        if (offsetSample > m_clockOffset) {
+            m_clockOffset = offsetSample;
+        } else {
+            m_clockOffset += (offsetSample - m_clockOffset) * CLOCK_DRIFT_SMOOTHING;
+        }
+    }
+    m_lastSequence = sequence;
+    m_lastServerTime = serverTime;
+    m_lastLocalTime = localTime;
+
+    // One interval keeps a newer snapshot in hand, the margin covers late packets
+    const float targetDelay = std::max(m_snapshotInterval + JITTER_MARGIN * m_jitter, m_minimumDelay);
+    m_delay += (targetDelay - m_delay) * DELAY_SMOOTHING;
+
+    m_newest = (m_newest + 1) % CAPACITY;
+    m_count = std::min(m_count + 1, CAPACITY);
+    Frame& frame = m_frames[m_newest];
+    frame.serverTime = serverTime;
+    frame.entities.assign(entities.begin(), entities.end());
+    std::sort(frame.entities.begin(), frame.entities.end(),
+        [](const CyborSnapshotCodec::EntityState& a, const CyborSnapshotCodec::EntityState& b) {
+            return a.entityId < b.entityId;
+        });
+}
+
+bool CyborInterpolationBuffer::Sample(float localTime, std::vector<CyborSnapshotCodec::EntityState>& outEntities) const {
+    outEntities.clear();
+    if (m_count == 0) return false;
+
+    const float renderTime = GetRenderTime(localTime);
+    const Frame& newest = GetFrame(0);
+
+    // Ahead of the stream: extrapolate from the last two snapshots, but not far
+    if (renderTime >= newest.serverTime) {
+        outEntities = newest.entities;
+        if (m_count < 2) return true;
+
+        const Frame& previous = GetFrame(1);
+        const float frameDelta = newest.serverTime - previous.serverTime;
+        const float extrapolation = std::min(renderTime - newest.serverTime, m_maxExtrapolation);
+        if (frameDelta <= 0.0f || extrapolation <= 0.0f) return true;
+
+        for (auto& entity : outEntities) {
+            const CyborSnapshotCodec::EntityState* before = FindEntity(previous, entity.entityId);
+            if (!before || !entity.alive) continue;
+            const glm::vec3 velocity = (entity.position - before->position) / frameDelta;
+            entity.position += velocity * extrapolation;
+        }
+        return true;
+    }
+
+    // Find the pair of snapshots around the render time
+    for (int age = 0; age + 1 < m_count; age++) {
+        const Frame& newer = GetFrame(age);
+        const Frame& older = GetFrame(age + 1);
+        if (renderTime < older.serverTime) continue;
+
+        const float alpha = (renderTime - older.serverTime) / (newer.serverTime - older.serverTime);
+        outEntities.reserve(newer.entities.size());
+        for (const auto& entity : newer.entities) {
+            const CyborSnapshotCodec::EntityState* from = FindEntity(older, entity.entityId);
+            if (!from) {
+                outEntities.push_back(entity);
+                continue;
+            }
+
+            // Continuous fields blend, discrete ones hold until the newer snapshot is reached
+            CyborSnapshotCodec::EntityState state = *from;
+            state.position = glm::mix(from->position, entity.position, alpha);
+            state.yaw = LerpAngle(from->yaw, entity.yaw, alpha);
+            state.pitch = LerpAngle(from->pitch, entity.pitch, alpha);
+            outEntities.push_back(state);
+        }
+        return true;
+    }
+
+    // Older than anything buffered
+    outEntities = GetFrame(m_count - 1).entities;
+    return true;
+}
+
+const CyborInterpolationBuffer::Frame& CyborInterpolationBuffer::GetFrame(int age) const {
+    return m_frames[(m_newest - age + CAPACITY) % CAPACITY];
+}
+
+float CyborInterpolationBuffer::LerpAngle(float from, float to, float t) {
+    float delta = std::fmod(to - from + 540.0f, 360.0f) - 180.0f;
+    return from + delta * t;
+}
+
+const CyborSnapshotCodec::EntityState* CyborInterpolationBuffer::FindEntity(const Frame& frame, uint32_t entityId) {
+    auto it = std::lower_bound(frame.entities.begin(), frame.entities.end(), entityId,
+        [](const CyborSnapshotCodec::EntityState& entity, uint32_t id) { return entity.entityId < id; });
+    return (it != frame.entities.end() && it->entityId == entityId) ? &*it : nullptr;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CyborSnapshot.h"
+
+/*
+ * CyborInterpolationBuffer - Smooth remote entities from a low-rate snapshot stream
+ * Rendering samples the world slightly in the past, between two received
+ * snapshots. The delay adapts to measured arrival jitter, and when the
+ * stream stalls entities are extrapolated for a bounded time only.
+ */
+class CyborInterpolationBuffer {
+public:
+    static constexpr int CAPACITY = 32;
+
+public:
+    CyborInterpolationBuffer();
+    ~CyborInterpolationBuffer();
+
+    void Clear();
+
+    // localTime is the receiver's clock when the snapshot arrived
+    void AddSnapshot(uint16_t sequence, float serverTime, float localTime,
+                     const std::vector<CyborSnapshotCodec::EntityState>& entities);
+
+    // World state at localTime minus the interpolation delay; false until data arrives
+    bool Sample(float localTime, std::vector<CyborSnapshotCodec::EntityState>& outEntities) const;
+    // Server time of the world Sample shows at localTime
+    float GetRenderTime(float localTime) const { return localTime + m_clockOffset - m_delay; }
+
+    // Tuning
+    void SetMaxExtrapolation(float seconds) { m_maxExtrapolation = seconds; }
+    void SetMinimumDelay(float seconds) { m_minimumDelay = seconds; }
+
+    // Diagnostics
+    float GetInterpolationDelay() const { return m_delay; }
+    float GetJitter() const { return m_jitter; }
+    float GetSnapshotInterval() const { return m_snapshotInterval; }
+
+private:
+    struct Frame {
+        float serverTime;
+        std::vector<CyborSnapshotCodec::EntityState> entities; // Sorted by id
+    };
+
+    Frame m_frames[CAPACITY];
+    int m_newest;
+    int m_count;
+
+    // Clock and timing estimates
+    float m_clockOffset;      // serverTime - localTime of the least delayed arrivals
+    uint16_t m_lastSequence;
+    float m_lastServerTime;
+    float m_lastLocalTime;
+    float m_snapshotInterval;
+    float m_jitter;
+    float m_delay;
+    float m_minimumDelay;
+    float m_maxExtrapolation;
+
+    // Private methods
+    const Frame& GetFrame(int age) const;
+    static float LerpAngle(float from, float to, float t);
+    static const CyborSnapshotCodec::EntityState* FindEntity(const Frame& frame, uint32_t entityId);
+};
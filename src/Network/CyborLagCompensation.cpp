@@ -0,0 +1,139 @@
+#include "CyborLagCompensation.h"
+#include <algorithm>
+#include <cmath>
+
+CyborLagCompensation::CyborLagCompensation(int tickRate, float maxRewindSeconds, int maxEntities)
+    : m_maxEntities(maxEntities), m_head(0), m_frameCount(0), m_recording(false),
+      m_maxEntitySpeed(10.0f) {
+    m_capacity = static_cast<size_t>(std::ceil(tickRate * maxRewindSeconds)) + 1;
+
+    m_frames.resize(m_capacity);
+    size_t totalEntities = m_capacity * m_maxEntities;
+    m_ids.resize(totalEntities);
+    m_posX.resize(totalEntities);
+    m_posY.resize(totalEntities);
+    m_posZ.resize(totalEntities);
+    m_team.resize(totalEntities);
+}
+
+CyborLagCompensation::~CyborLagCompensation() {
+}
+
+void CyborLagCompensation::BeginTick(float serverTime) {
+    m_frames[m_head].time = serverTime;
+    m_frames[m_head].count = 0;
+    m_recording = true;
+}
+
+void CyborLagCompensation::AddEntity(uint32_t entityId, const glm::vec3& position, uint8_t team) {
+    Frame& frame = m_frames[m_head];
+    if (!m_recording || frame.count >= m_maxEntities) return;
+
+    size_t index = m_head * m_maxEntities + frame.count;
+    m_ids[index] = entityId;
+    m_posX[index] = Quantize(position.x);
+    m_posY[index] = Quantize(position.y);
+    m_posZ[index] = Quantize(position.z);
+    m_team[index] = team;
+    frame.count++;
+}
+
+void CyborLagCompensation::EndTick() {
+    if (!m_recording) return;
+
+    m_recording = false;
+    m_head = (m_head + 1) % m_capacity;
+    m_frameCount = std::min(m_frameCount + 1, m_capacity);
+}
+
+void CyborLagCompensation::Clear() {
+    m_head = 0;
+    m_frameCount = 0;
+    m_recording = false;
+}
+
+size_t CyborLagCompensation::RewindAlongRay(float targetTime, const glm::vec3& origin, const glm::vec3& direction,
+                                            float range, float hitRadius, std::vector<RewoundHitbox>& outHitboxes) const {
+    outHitboxes.clear();
+    if (m_frameCount == 0) return 0;
+
+    const size_t newestSlot = SlotForAge(0);
+    const float newestTime = m_frames[newestSlot].time;
+    const float time = std::clamp(targetTime, GetOldestTime(), newestTime);
+
+    // Youngest frame at or before the target time; ages grow into the past
+    size_t low = 0;
+    size_t high = m_frameCount - 1;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (m_frames[SlotForAge(mid)].time <= time) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    const size_t olderSlot = SlotForAge(low);
+    const size_t newerSlot = low > 0 ? SlotForAge(low - 1) : olderSlot;
+    const float olderTime = m_frames[olderSlot].time;
+    const float newerTime = m_frames[newerSlot].time;
+    const float alpha = newerTime > olderTime ? (time - olderTime) / (newerTime - olderTime) : 0.0f;
+
+    // Anything that could have been within reach of the ray back then
+    const float margin = hitRadius + m_maxEntitySpeed * (newestTime - time);
+    const float marginSq = margin * margin;
+
+    const size_t newestBase = newestSlot * m_maxEntities;
+    for (int i = 0; i < m_frames[newestSlot].count; i++) {
+        glm::vec3 current = Dequantize(newestSlot, i);
+
+        glm::vec3 toEntity = current - origin;
+        float along = std::clamp(glm::dot(toEntity, direction), 0.0f, range);
+        glm::vec3 offset = toEntity - direction * along;
+        if (glm::dot(offset, offset) > marginSq) continue;
+
+        uint32_t entityId = m_ids[newestBase + i];
+        int olderIndex = FindEntity(olderSlot, entityId);
+        int newerIndex = FindEntity(newerSlot, entityId);
+        if (olderIndex < 0 && newerIndex < 0) continue;
+
+        glm::vec3 olderPos = olderIndex >= 0 ? Dequantize(olderSlot, olderIndex) : Dequantize(newerSlot, newerIndex);
+        glm::vec3 newerPos = newerIndex >= 0 ? Dequantize(newerSlot, newerIndex) : olderPos;
+
+        outHitboxes.push_back({ entityId, m_team[newestBase + i], glm::mix(olderPos, newerPos, alpha) });
+    }
+
+    return outHitboxes.size();
+}
+
+float CyborLagCompensation::GetOldestTime() const {
+    if (m_frameCount == 0) return 0.0f;
+    return m_frames[SlotForAge(m_frameCount - 1)].time;
+}
+
+float CyborLagCompensation::GetNewestTime() const {
+    if (m_frameCount == 0) return 0.0f;
+    return m_frames[SlotForAge(0)].time;
+}
+
+size_t CyborLagCompensation::SlotForAge(size_t age) const {
+    return (m_head + m_capacity - 1 - age) % m_capacity;
+}
+
+int CyborLagCompensation::FindEntity(size_t slot, uint32_t entityId) const {
+    const uint32_t* begin = m_ids.data() + slot * m_maxEntities;
+    const uint32_t* end = begin + m_frames[slot].count;
+    const uint32_t* found = std::lower_bound(begin, end, entityId);
+    if (found == end || *found != entityId) return -1;
+    return static_cast<int>(found - begin);
+}
+
+glm::vec3 CyborLagCompensation::Dequantize(size_t slot, int index) const {
+    size_t i = slot * m_maxEntities + index;
+    return glm::vec3(m_posX[i], m_posY[i], m_posZ[i]) / POSITION_SCALE;
+}
+
+int16_t CyborLagCompensation::Quantize(float value) {
+    float scaled = std::round(value * POSITION_SCALE);
+    return static_cast<int16_t>(std::clamp(scaled, -32767.0f, 32767.0f));
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+/*
+ * CyborLagCompensation - Rewindable hitbox history for server-side hit registration
+ * Keeps a ring buffer of per-tick entity positions, quantized and stored as
+ * structure-of-arrays, so a shot can be checked against what the shooter saw
+ */
+class CyborLagCompensation {
+public:
+    struct RewoundHitbox {
+        uint32_t entityId;
+        uint8_t team;
+        glm::vec3 center;
+    };
+
+public:
+    CyborLagCompensation(int tickRate = 128, float maxRewindSeconds = 1.0f, int maxEntities = 64);
+    ~CyborLagCompensation();
+
+    // Recording, once per server tick. Entities must be added in ascending id order.
+    void BeginTick(float serverTime);
+    void AddEntity(uint32_t entityId, const glm::vec3& position, uint8_t team);
+    void EndTick();
+    void Clear();
+
+    // Rewinds only the entities whose hitbox can reach the ray at targetTime,
+    // interpolated between the two recorded ticks around it
+    size_t RewindAlongRay(float targetTime, const glm::vec3& origin, const glm::vec3& direction,
+                          float range, float hitRadius, std::vector<RewoundHitbox>& outHitboxes) const;
+
+    // Upper bound on entity speed, widens the broadphase around the ray
+    void SetMaxEntitySpeed(float speed) { m_maxEntitySpeed = speed; }
+
+    // History info
+    size_t GetFrameCount() const { return m_frameCount; }
+    float GetOldestTime() const;
+    float GetNewestTime() const;
+
+    // Quantization step: 1/32 unit, covering +-1024 units per axis in 16 bits
+    static constexpr float POSITION_SCALE = 32.0f;
+
+private:
+    struct Frame {
+        float time;
+        uint16_t count;
+    };
+
+    int m_maxEntities;
+    size_t m_capacity;
+
+    // Ring of frames, m_head is the slot being written next
+    std::vector<Frame> m_frames;
+    size_t m_head;
+    size_t m_frameCount;
+    bool m_recording;
+
+    // Per-frame entity data, slot * m_maxEntities + index
+    std::vector<uint32_t> m_ids;
+    std::vector<int16_t> m_posX;
+    std::vector<int16_t> m_posY;
+    std::vector<int16_t> m_posZ;
+    std::vector<uint8_t> m_team;
+
+    float m_maxEntitySpeed;
+
+    // Private methods
+    size_t SlotForAge(size_t age) const;
+    int FindEntity(size_t slot, uint32_t entityId) const;
+    glm::vec3 Dequantize(size_t slot, int index) const;
+    static int16_t Quantize(float value);
+};
@@ -0,0 +1,105 @@
+#include "CyborLinkEmulator.h"
+#include <algorithm>
+
+CyborLinkEmulator::CyborLinkEmulator() {
+    Configure(Settings(), 1);
+}
+
+CyborLinkEmulator::~CyborLinkEmulator() {
+}
+
+void CyborLinkEmulator::Configure(const Settings& settings, uint64_t seed) {
+    m_settings = settings;
+    m_random.seed(seed);
+    Clear();
+}
+
+void CyborLinkEmulator::Clear() {
+    m_stats = Stats{ 0, 0, 0, 0, 0, 0 };
+    m_inLossBurst = false;
+    m_linkFreeTime = 0.0;
+    m_lastArrivalTime = 0.0;
+    m_order = 0;
+    m_inFlight.clear();
+}
+
+void CyborLinkEmulator::Submit(CyborPacketPtr packet, uint32_t address, uint16_t port, double now, CyborPacketPool& pool) {
+    m_stats.submitted++;
+
+    // Always the same draws in the same order, whatever happens to the packet
+    const double lossDraw = Uniform();
+    const double jitterDraw = Uniform();
+    const double reorderDraw = Uniform();
+    const double duplicateDraw = Uniform();
+    const double duplicateDelayDraw = Uniform();
+
+    // Gilbert-Elliott: a lossy state entered so that the long-run rate matches,
+    // left after lossBurstLength packets on average
+    const double burstLength = std::max(1.0, m_settings.lossBurstLength);
+    if (m_inLossBurst) {
+        if (lossDraw < 1.0 / burstLength) m_inLossBurst = false;
+    } else if (m_settings.lossRate > 0.0) {
+        const double enterRate = m_settings.lossRate >= 1.0
+            ? 1.0 : m_settings.lossRate / (burstLength * (1.0 - m_settings.lossRate));
+        if (lossDraw < enterRate) m_inLossBurst = true;
+    }
+    if (m_inLossBurst) {
+        m_stats.lost++;
+        return;
+    }
+
+    // Serialization at the capped rate; the sender's queue overflows like a router's would
+    double departure = now;
+    if (m_settings.bandwidth > 0.0) {
+        const double start = std::max(now, m_linkFreeTime);
+        const double queuedBytes = (start - now) * m_settings.bandwidth;
+        if (queuedBytes + packet->Size() > m_settings.queueLimit) {
+            m_stats.queueDropped++;
+            return;
+        }
+        m_linkFreeTime = start + packet->Size() / m_settings.bandwidth;
+        departure = m_linkFreeTime;
+    }
+
+    // Jitter alone never reorders; only packets picked for it are held back
+    double arrival = departure + m_settings.latency + m_settings.jitter * jitterDraw;
+    if (reorderDraw < m_settings.reorderRate) {
+        arrival += m_settings.reorderDelay;
+        m_stats.reordered++;
+    } else {
+        arrival = std::max(arrival, m_lastArrivalTime);
+        m_lastArrivalTime = arrival;
+    }
+
+    if (duplicateDraw < m_settings.duplicateRate) {
+        CyborPacketPtr copy = pool.Acquire(packet->GetHeadroom());
+        copy->Append(packet->Data(), packet->Size());
+        Schedule(std::move(copy), address, port, arrival + m_settings.jitter * duplicateDelayDraw);
+        m_stats.duplicated++;
+    }
+    Schedule(std::move(packet), address, port, arrival);
+}
+
+bool CyborLinkEmulator::PollDelivered(double now, Delivery& outDelivery) {
+    if (m_inFlight.empty() || m_inFlight.front().time > now) return false;
+
+    std::pop_heap(m_inFlight.begin(), m_inFlight.end(), Later);
+    outDelivery = std::move(m_inFlight.back());
+    m_inFlight.pop_back();
+    m_stats.delivered++;
+    return true;
+}
+
+double CyborLinkEmulator::Uniform() {
+    // 53 random bits; std distributions differ between standard libraries
+    return static_cast<double>(m_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void CyborLinkEmulator::Schedule(CyborPacketPtr packet, uint32_t address, uint16_t port, double time) {
+    m_inFlight.push_back(Delivery{ time, m_order++, address, port, std::move(packet) });
+    std::push_heap(m_inFlight.begin(), m_inFlight.end(), Later);
+}
+
+bool CyborLinkEmulator::Later(const Delivery& a, const Delivery& b) {
+    return a.time > b.time || (a.time == b.time && a.order > b.order);
+}
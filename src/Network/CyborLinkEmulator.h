@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "CyborPacketBuffer.h"
+
+/*
+ * CyborLinkEmulator - Reproducible bad-network simulation for one direction of a link
+ * Packets are delayed, jittered, reordered, duplicated, rate limited and
+ * dropped (with bursts) the way a real path would. Every packet consumes
+ * the same number of draws from the seeded generator, so a given seed and
+ * packet sequence always meets the same fate regardless of wall-clock timing.
+ */
+class CyborLinkEmulator {
+public:
+    struct Settings {
+        double latency = 0.0;        // One way, seconds
+        double jitter = 0.0;         // Extra delay, uniform in [0, jitter]
+        double lossRate = 0.0;       // Long-run fraction dropped, 0..1
+        double lossBurstLength = 1.0; // Mean consecutive losses; 1 is independent loss
+        double reorderRate = 0.0;    // Fraction held back so later packets overtake them
+        double reorderDelay = 0.02;  // How long a held-back packet waits
+        double duplicateRate = 0.0;
+        double bandwidth = 0.0;      // Bytes per second, 0 for unlimited
+        size_t queueLimit = 64 * 1024; // Bytes waiting for bandwidth before tail drop
+    };
+
+    struct Delivery {
+        double time;
+        uint64_t order; // Tie-break so equal times keep submission order
+        uint32_t address;
+        uint16_t port;
+        CyborPacketPtr packet;
+    };
+
+    struct Stats {
+        uint64_t submitted;
+        uint64_t lost;
+        uint64_t queueDropped;
+        uint64_t reordered;
+        uint64_t duplicated;
+        uint64_t delivered;
+    };
+
+public:
+    CyborLinkEmulator();
+    ~CyborLinkEmulator();
+
+    // Resets the generator, the link state and the statistics
+    void Configure(const Settings& settings, uint64_t seed);
+    void Clear();
+    const Settings& GetSettings() const { return m_settings; }
+    const Stats& GetStats() const { return m_stats; }
+
+    // Takes the packet onto the link at 'now'. Duplicates need a pool to copy from.
+    void Submit(CyborPacketPtr packet, uint32_t address, uint16_t port, double now, CyborPacketPool& pool);
+    // Next packet due by 'now', earliest first
+    bool PollDelivered(double now, Delivery& outDelivery);
+    bool IsIdle() const { return m_inFlight.empty(); }
+
+private:
+    Settings m_settings;
+    std::mt19937_64 m_random;
+    Stats m_stats;
+
+    // Link state
+    bool m_inLossBurst;
+    double m_linkFreeTime;    // When the bandwidth-limited sender finishes what it has
+    double m_lastArrivalTime; // Keeps jittered packets in order unless chosen for reordering
+    uint64_t m_order;
+
+    // Min-heap on (time, order)
+    std::vector<Delivery> m_inFlight;
+
+    double Uniform();
+    void Schedule(CyborPacketPtr packet, uint32_t address, uint16_t port, double time);
+    static bool Later(const Delivery& a, const Delivery& b);
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include "CyborBitStream.h"
+
+/*
+ * CyborMessageSchema - Wire formats declared as a list of fields
+ * A message is a plain struct; its schema names the members in wire order,
+ * each with a bit width fixed at compile time, and from that writes the
+ * struct bit-packed and reads it back. Strings are byte-aligned on the wire
+ * and read as views into the received buffer, so decoding neither copies
+ * nor allocates; the views live as long as the buffer.
+ *
+ *   struct ChatMessage { std::string_view sender; std::string_view text; };
+ *   using ChatSchema = CyborMessageSchema<CyborField<&ChatMessage::sender>,
+ *                                         CyborField<&ChatMessage::text>>;
+ *
+ * Field types: bool, integers and enums up to 32 bits (signed ones are sign
+ * extended), float, glm::vec3, std::string_view (up to 255 bytes) and
+ * std::array<uint8_t, N>.
+ */
+namespace CyborWire {
+
+template <typename Member>
+struct MemberTraits;
+
+template <typename Class, typename Value>
+struct MemberTraits<Value Class::*> {
+    using ClassType = Class;
+    using ValueType = Value;
+};
+
+template <typename T>
+struct IsByteArray : std::false_type {};
+
+template <size_t N>
+struct IsByteArray<std::array<uint8_t, N>> : std::true_type {};
+
+constexpr size_t MAX_STRING_SIZE = 255;
+
+// Integers default to their full width; everything else has a fixed encoding
+template <typename T>
+constexpr int DefaultBits() {
+    if constexpr (std::is_same_v<T, bool>) return 1;
+    else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) return static_cast<int>(sizeof(T) * 8);
+    else return 0;
+}
+
+// Most the field can take on the wire, counting alignment padding
+template <typename T, int Bits>
+constexpr size_t MaxBits() {
+    if constexpr (std::is_same_v<T, float>) return 32;
+    else if constexpr (std::is_same_v<T, glm::vec3>) return 96;
+    else if constexpr (std::is_same_v<T, std::string_view>) return 8 + 7 + MAX_STRING_SIZE * 8;
+    else if constexpr (IsByteArray<T>::value) return 7 + sizeof(T) * 8;
+    else return Bits;
+}
+
+} // namespace CyborWire
+
+template <auto Member,
+          int Bits = CyborWire::DefaultBits<typename CyborWire::MemberTraits<decltype(Member)>::ValueType>()>
+struct CyborField {
+    using ClassType = typename CyborWire::MemberTraits<decltype(Member)>::ClassType;
+    using ValueType = typename CyborWire::MemberTraits<decltype(Member)>::ValueType;
+
+    static constexpr bool IS_INTEGER = std::is_integral_v<ValueType> || std::is_enum_v<ValueType>;
+    static_assert(IS_INTEGER || std::is_same_v<ValueType, float> || std::is_same_v<ValueType, glm::vec3> ||
+                  std::is_same_v<ValueType, std::string_view> || CyborWire::IsByteArray<ValueType>::value,
+                  "CyborField: unsupported member type");
+    static_assert(!IS_INTEGER || (Bits >= 1 && Bits <= 32 && Bits <= static_cast<int>(sizeof(ValueType) * 8)),
+                  "CyborField: integers take 1 to 32 bits, and no more than their type holds");
+
+    static constexpr size_t MAX_BITS = CyborWire::MaxBits<ValueType, Bits>();
+
+    static void Write(const ClassType& message, CyborBitWriter& writer) {
+        const ValueType& value = message.*Member;
+        if constexpr (std::is_same_v<ValueType, bool>) {
+            writer.WriteBool(value);
+        } else if constexpr (IS_INTEGER) {
+            writer.WriteBits(static_cast<uint32_t>(value), Bits);
+        } else if constexpr (std::is_same_v<ValueType, float>) {
+            writer.WriteFloat(value);
+        } else if constexpr (std::is_same_v<ValueType, glm::vec3>) {
+            for (int axis = 0; axis < 3; axis++) writer.WriteFloat(value[axis]);
+        } else if constexpr (std::is_same_v<ValueType, std::string_view>) {
+            const size_t size = value.size() < CyborWire::MAX_STRING_SIZE ? value.size() : CyborWire::MAX_STRING_SIZE;
+            writer.WriteBits(static_cast<uint32_t>(size), 8);
+            writer.WriteBytes(reinterpret_cast<const uint8_t*>(value.data()), size);
+        } else {
+            writer.WriteBytes(value.data(), value.size());
+        }
+    }
+
+    static void Read(CyborBitReader& reader, ClassType& message) {
+        ValueType& value = message.*Member;
+        if constexpr (std::is_same_v<ValueType, bool>) {
+            value = reader.ReadBool();
+        } else if constexpr (IS_INTEGER) {
+            uint32_t bits = reader.ReadBits(Bits);
+            if constexpr (Bits < 32 && std::is_signed_v<ValueType>) {
+                if (bits & (1u << (Bits - 1))) bits |= ~((1u << Bits) - 1);
+            }
+            value = static_cast<ValueType>(bits);
+        } else if constexpr (std::is_same_v<ValueType, float>) {
+            value = reader.ReadFloat();
+        } else if constexpr (std::is_same_v<ValueType, glm::vec3>) {
+            for (int axis = 0; axis < 3; axis++) value[axis] = reader.ReadFloat();
+        } else if constexpr (std::is_same_v<ValueType, std::string_view>) {
+            const size_t size = reader.ReadBits(8);
+            const uint8_t* bytes = reader.ReadBytes(size);
+            value = bytes ? std::string_view(reinterpret_cast<const char*>(bytes), size) : std::string_view();
+        } else {
+            const uint8_t* bytes = reader.ReadBytes(value.size());
+            for (size_t i = 0; i < value.size(); i++) value[i] = bytes ? bytes[i] : 0;
+        }
+    }
+};
+
+template <typename FirstField, typename... Fields>
+struct CyborMessageSchema {
+    using Message = typename FirstField::ClassType;
+    static_assert((std::is_same_v<Message, typename Fields::ClassType> && ...),
+                  "CyborMessageSchema: every field must belong to the same message");
+
+    static constexpr size_t FIELD_COUNT = 1 + sizeof...(Fields);
+    // Upper bound on the encoded size, for checking a message fits its packet at compile time
+    static constexpr size_t MAX_BITS = FirstField::MAX_BITS + (Fields::MAX_BITS + ... + 0);
+    static constexpr size_t MAX_BYTES = (MAX_BITS + 7) / 8;
+
+    static void Write(const Message& message, CyborBitWriter& writer) {
+        FirstField::Write(message, writer);
+        (Fields::Write(message, writer), ...);
+    }
+
+    // False when the data runs out; fields read by then are unreliable
+    static bool Read(CyborBitReader& reader, Message& message) {
+        FirstField::Read(reader, message);
+        (Fields::Read(reader, message), ...);
+        return !reader.HasOverflowed();
+    }
+};
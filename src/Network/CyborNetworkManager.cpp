@@ -1,10 +1,122 @@
 #include "CyborNetworkManager.h"
+#include "CyborDemo.h"
+#include "CyborMessageSchema.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
+// Commands resent with every upload so a lost packet costs nothing
+static const size_t REDUNDANT_COMMANDS = 8;
+// Server: what a client may have waiting for the next tick, in commands and in simulated time.
+// Later commands are taken from their redundant copies once the game has drained these.
+static const size_t MAX_PENDING_COMMANDS = 16;
+static const float MAX_PENDING_COMMAND_TIME = 0.25f;
+// Server: the longest step one command may simulate
+static const float MAX_COMMAND_DELTA_TIME = 0.1f;
+// A client repeats its PLAYER_INFO until the server answers
+static const float PLAYER_INFO_RETRY_INTERVAL = 0.25f;
+// Events the game hasn't polled; the oldest go first
+static const size_t MAX_QUEUED_GAME_EVENTS = 1024;
+static const size_t MAX_QUEUED_REMOTE_SHOTS = 256;
+// Furthest back a shot may be registered, the length of the game's hitbox history
+static const float MAX_SHOT_VIEW_AGE = 1.0f;
+// Beyond this a client sees an entity at reduced snapshot detail when the server is loaded
+static const float DISTANT_ENTITY_RANGE = 16.0f;
+// Snapshot priority: full weight within this range, falling off with distance beyond it
+static const float PRIORITY_NEAR_DISTANCE = 8.0f;
+static const float PRIORITY_HIDDEN_WEIGHT = 0.25f;        // Out of sight, lingering
+static const float PRIORITY_NEW_ENTITY_WEIGHT = 2.0f;     // Not in the client's baseline yet
+static const float PRIORITY_STATUS_CHANGE_WEIGHT = 4.0f;  // Health, armor, weapon, alive or team changed
+static const int MAX_SNAPSHOT_PACKING_ATTEMPTS = 4;
+// How often the roster's pings follow the measured round trips
+static const float PING_REFRESH_INTERVAL = 1.0f;
+
+// Wire formats of the fixed-layout messages, after the type byte
+struct WeaponFireMessage {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float viewTime; // Server time of the world the shooter saw
+};
+using WeaponFireSchema = CyborMessageSchema<CyborField<&WeaponFireMessage::origin>,
+                                            CyborField<&WeaponFireMessage::direction>,
+                                            CyborField<&WeaponFireMessage::viewTime>>;
+
+struct ChatMessage {
+    std::string_view sender;
+    std::string_view text;
+};
+using ChatSchema = CyborMessageSchema<CyborField<&ChatMessage::sender>, CyborField<&ChatMessage::text>>;
+
+struct CyborSignalMessage {
+    std::string_view signal;
+};
+using CyborSignalSchema = CyborMessageSchema<CyborField<&CyborSignalMessage::signal>>;
+
+// Two bits hold every event type
+struct GameEventMessage {
+    CyborNetworkManager::GameEvent::Type type;
+    uint32_t subjectId;
+    uint32_t instigatorId;
+    int32_t value;
+    std::string_view text;
+};
+using GameEventSchema = CyborMessageSchema<CyborField<&GameEventMessage::type, 2>,
+                                           CyborField<&GameEventMessage::subjectId>,
+                                           CyborField<&GameEventMessage::instigatorId>,
+                                           CyborField<&GameEventMessage::value>,
+                                           CyborField<&GameEventMessage::text>>;
+static_assert(static_cast<int>(CyborNetworkManager::GameEvent::Type::ROUND_END) < 4, "GAME_EVENT type needs more bits");
+
+struct SnapshotAckMessage {
+    uint16_t sequence;
+};
+using SnapshotAckSchema = CyborMessageSchema<CyborField<&SnapshotAckMessage::sequence>>;
+
+// Full precision, the client replays on top of it
+struct PlayerStateMessage {
+    uint32_t sequence;
+    glm::vec3 position;
+    glm::vec3 velocity;
+    bool onGround;
+    bool crouching;
+};
+using PlayerStateSchema = CyborMessageSchema<CyborField<&PlayerStateMessage::sequence>,
+                                             CyborField<&PlayerStateMessage::position>,
+                                             CyborField<&PlayerStateMessage::velocity>,
+                                             CyborField<&PlayerStateMessage::onGround>,
+                                             CyborField<&PlayerStateMessage::crouching>>;
+
+struct PlayerInfoMessage {
+    std::string_view name;
+    bool cyborEnhanced;
+    bool relay;
+    std::array<uint8_t, CyborPacketCrypto::SALT_SIZE> salt;
+};
+using PlayerInfoSchema = CyborMessageSchema<CyborField<&PlayerInfoMessage::name>,
+                                            CyborField<&PlayerInfoMessage::cyborEnhanced>,
+                                            CyborField<&PlayerInfoMessage::relay>,
+                                            CyborField<&PlayerInfoMessage::salt>>;
+
+// Decodes a received message; string fields point into data
+template <typename Schema>
+static bool ReadMessage(const CyborPacketBuffer& data, typename Schema::Message& message) {
+    CyborBitReader reader(data.Data() + 1, data.Size() - 1);
+    return Schema::Read(reader, message);
+}
+
 CyborNetworkManager::CyborNetworkManager()
-    : m_initialized(false), m_isServer(false), m_isClient(false), m_isConnected(false),
-      m_serverPort(27015), m_maxPlayers(10), m_currentPlayers(0),
-      m_networkLatency(0.0f), m_packetLoss(0.0f) {
+    : m_initialized(false), m_networkMode(NetworkMode::SINGLE_PLAYER), m_localPlayerName("CyborPlayer"),
+      m_isServer(false), m_serverRunning(false), m_serverPort(27015), m_maxPlayers(16),
+      m_isClient(false), m_connected(false), m_serverPort_client(27015),
+      m_snapshotSequence(0), m_snapshotInterval(1.0f / 64.0f), m_snapshotTimer(0.0f), m_snapshotDetailLevel(0),
+      m_clientBandwidthLimit(0), m_networkTime(0.0f), m_broadcastDelay(0.0f), m_isBroadcastRelay(false),
+      m_hasAuthoritativeState(false), m_authoritativeSequence(0),
+      m_ping(0), m_packetLoss(0.0f), m_bandwidth(0.0f), m_pingRefreshTimer(0.0f),
+      m_publishedPlayers(std::make_shared<std::vector<PlayerInfo>>()), m_playersChanged(false),
+      m_cyborProtocolEnabled(false), m_cyborEncryption(false), m_hasCyborKey(false),
+      m_hasServerInfo(false), m_playerInfoTimer(0.0f), m_receiveTime(0.0) {
 }
 
 CyborNetworkManager::~CyborNetworkManager() {
@@ -12,112 +124,1184 @@ CyborNetworkManager::~CyborNetworkManager() {
 }
 
 bool CyborNetworkManager::Initialize() {
-    // Initialize networking system
-    // In a real implementation, this would initialize Winsock, SDL_net, or similar
     std::cout << "Initializing Cybor Network Manager..." << std::endl;
-    
+
     m_initialized = true;
     std::cout << "Cybor Network Manager initialized successfully!" << std::endl;
     return true;
 }
 
 void CyborNetworkManager::Update(float deltaTime) {
-    if (!m_initialized) return;
-    
-    // Update network connections, process packets, etc.
-    // This would handle network updates in a real implementation
-    
-    // Simulate network latency
-    m_networkLatency = 0.016f + (rand() % 50) / 1000.0f; // 16-66ms
-    m_packetLoss = (rand() % 100) / 1000.0f; // 0-10% packet loss
-}
-
-bool CyborNetworkManager::StartServer(int port) {
-    if (!m_initialized) return false;
-    
+    if (!m_initialized || !m_transport.IsRunning()) return;
+
+    m_networkTime += deltaTime;
+    m_snapshotTimer += deltaTime;
+
+    // Whatever last tick's traffic didn't carry goes out before anything new arrives
+    FlushReliableChannels();
+    if (m_isClient && m_connected && !m_hasServerInfo) {
+        m_playerInfoTimer += deltaTime;
+        if (m_playerInfoTimer >= PLAYER_INFO_RETRY_INTERVAL) SendPlayerInfo(0);
+    }
+
+    ProcessIncomingPackets();
+    UpdateConnectionStats(deltaTime);
+    PublishPlayers();
+
+    // Hand everything queued this tick to the network thread in one wakeup
+    m_transport.Flush();
+}
+
+bool CyborNetworkManager::StartServer(int port, int maxPlayers) {
+    if (!m_initialized || m_transport.IsRunning()) return false;
+
+    if (!m_transport.StartServer(static_cast<uint16_t>(port), maxPlayers)) {
+        std::cerr << "Failed to start Cybor Network Server on port " << port << std::endl;
+        return false;
+    }
+
+    m_networkMode = m_cyborProtocolEnabled ? NetworkMode::CYBOR_ENHANCED_PROTOCOL : NetworkMode::LAN_SERVER;
     m_serverPort = port;
+    m_maxPlayers = maxPlayers;
     m_isServer = true;
-    m_isConnected = true;
-    
-    std::cout << "Cybor Network Server started on port " << port << std::endl;
+    m_serverRunning = true;
+    m_clients.assign(maxPlayers, ClientConnection{ false, CyborSnapshotHistory(), 0, false,
+                                                   false, CyborInterestManager::NO_ENTITY, glm::vec3(0.0f),
+                                                   CyborInterestManager::NO_TEAM, {}, 0, false, CyborPriorityAccumulator(),
+                                                   false });
+    m_peerSecurity.assign(maxPlayers, PeerSecurity());
+    m_channels.assign(maxPlayers, CyborReliableChannel());
+    m_connectionStats.assign(maxPlayers, CyborNetworkStats());
+    m_gameEvents.clear();
+    m_remoteShots.clear();
+    m_broadcastSnapshots.clear();
+    m_snapshotSequence = 0;
+    m_snapshotTimer = 0.0f;
+    m_networkTime = 0.0f;
+
+    std::cout << "Cybor Network Server started on port " << port
+              << " (max " << maxPlayers << " players)" << std::endl;
     return true;
 }
 
-bool CyborNetworkManager::ConnectToServer(const std::string& serverIP, int port) {
-    if (!m_initialized) return false;
-    
+void CyborNetworkManager::StopServer() {
+    if (!m_isServer) return;
+
+    StopDemoRecording();
+    m_transport.Stop();
+    m_isServer = false;
+    m_serverRunning = false;
+    m_clients.clear();
+    m_networkMode = NetworkMode::SINGLE_PLAYER;
+    m_connectedPlayers.clear();
+    m_playersChanged = true;
+    PublishPlayers();
+
+    std::cout << "Cybor Network Server stopped" << std::endl;
+}
+
+bool CyborNetworkManager::ConnectToServer(const std::string& ipAddress, int port) {
+    if (!m_initialized || m_transport.IsRunning()) return false;
+
+    if (!m_transport.StartClient(ipAddress, static_cast<uint16_t>(port))) {
+        std::cerr << "Failed to reach Cybor Network Server at " << ipAddress << ":" << port << std::endl;
+        return false;
+    }
+
+    // Connected once the server accepts the handshake, see ProcessIncomingPackets
+    m_networkMode = m_cyborProtocolEnabled ? NetworkMode::CYBOR_ENHANCED_PROTOCOL : NetworkMode::LAN_CLIENT;
+    m_serverIP = ipAddress;
+    m_serverPort_client = port;
     m_isClient = true;
-    m_isConnected = true;
-    
-    std::cout << "Connected to Cybor Network Server at " << serverIP << ":" << port << std::endl;
+    m_connected = false;
+    m_receivedSnapshots.Clear();
+    m_interpolationBuffer.Clear();
+    m_recentCommands.clear();
+    m_hasAuthoritativeState = false;
+    m_peerSecurity.assign(1, PeerSecurity());
+    m_channels.assign(1, CyborReliableChannel());
+    m_connectionStats.assign(1, CyborNetworkStats());
+    m_gameEvents.clear();
+    m_hasServerInfo = false;
+
+    std::cout << "Connecting to Cybor Network Server at " << ipAddress << ":" << port << "..." << std::endl;
     return true;
 }
 
 void CyborNetworkManager::Disconnect() {
-    if (m_isConnected) {
-        m_isConnected = false;
-        m_isServer = false;
-        m_isClient = false;
-        m_currentPlayers = 0;
-        
-        std::cout << "Disconnected from Cybor Network" << std::endl;
+    if (!m_isClient) return;
+
+    m_transport.Stop();
+    m_isClient = false;
+    m_connected = false;
+    m_networkMode = NetworkMode::SINGLE_PLAYER;
+    m_connectedPlayers.clear();
+    m_playersChanged = true;
+    PublishPlayers();
+
+    std::cout << "Disconnected from Cybor Network" << std::endl;
+}
+
+void CyborNetworkManager::SendPlayerUpdate(const glm::vec3& position, const glm::vec3& rotation) {
+    if (!IsServerRunning() && !IsConnected()) return;
+
+    // Same quantization as snapshots: 3 x 16 bit position, 3 x 12 bit angles
+    const CyborSnapshotCodec::QuantizationSettings& settings = m_snapshotCodec.GetSettings();
+    CyborPacketPtr packet = BeginBitMessage(MessageType::PLAYER_UPDATE);
+    for (int axis = 0; axis < 3; axis++) {
+        m_writer.WriteBits(m_snapshotCodec.QuantizePosition(position[axis], axis), settings.positionBits);
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        m_writer.WriteBits(m_snapshotCodec.QuantizeAngle(rotation[axis]), settings.angleBits);
     }
+    SendBitMessage(std::move(packet));
 }
 
-void CyborNetworkManager::SendPlayerUpdate(const PlayerNetworkData& playerData) {
-    if (!m_isConnected) return;
-    
-    // Send player position, health, actions, etc.
-    std::cout << "Sending player update: Position(" 
-              << playerData.position.x << ", " << playerData.position.y << ", " << playerData.position.z 
-              << ") Health: " << playerData.health << std::endl;
+void CyborNetworkManager::SendWeaponFire(const glm::vec3& origin, const glm::vec3& direction) {
+    if (!IsServerRunning() && !IsConnected()) return;
+
+    // A client sees the world as interpolated, a little behind the server
+    const float viewTime = IsConnected() ? m_interpolationBuffer.GetRenderTime(m_networkTime) : m_networkTime;
+    CyborPacketPtr packet = BeginBitMessage(MessageType::WEAPON_FIRE);
+    WeaponFireSchema::Write({ origin, direction, viewTime }, m_writer);
+    SendBitMessage(std::move(packet));
+}
+
+void CyborNetworkManager::SendChatMessage(const std::string& message) {
+    if (!IsServerRunning() && !IsConnected()) return;
+
+    CyborPacketPtr packet = BeginBitMessage(MessageType::CHAT_MESSAGE);
+    ChatSchema::Write({ m_localPlayerName, message }, m_writer);
+    if (EndBitMessage(*packet)) SendReliable(std::move(packet));
 }
 
 void CyborNetworkManager::SendGameEvent(const GameEvent& event) {
-    if (!m_isConnected) return;
-    
-    std::cout << "Sending game event: " << (int)event.type << " to all players" << std::endl;
+    if (!IsServerRunning() && !IsConnected()) return;
+    if (m_demoWriter && m_isServer) m_demoWriter->AddEvent(event);
+    QueueGameEvent(event, CyborUdpTransport::INVALID_PEER);
+}
+
+bool CyborNetworkManager::PollGameEvent(GameEvent& outEvent) {
+    if (m_gameEvents.empty()) return false;
+    outEvent = std::move(m_gameEvents.front());
+    m_gameEvents.pop_front();
+    return true;
+}
+
+bool CyborNetworkManager::PollRemoteShot(RemoteShot& outShot) {
+    if (m_remoteShots.empty()) return false;
+    outShot = m_remoteShots.front();
+    m_remoteShots.pop_front();
+    return true;
+}
+
+void CyborNetworkManager::BroadcastCyborSignal(const std::string& signal) {
+    if (!m_cyborProtocolEnabled || (!IsServerRunning() && !IsConnected())) return;
+
+    CyborPacketPtr packet = BeginBitMessage(MessageType::CYBOR_SIGNAL);
+    CyborSignalSchema::Write({ signal }, m_writer);
+    SendBitMessage(std::move(packet));
+}
+
+void CyborNetworkManager::BroadcastCyborSignal(const std::string& signal, const glm::vec3& origin) {
+    if (!IsServerRunning()) {
+        BroadcastCyborSignal(signal);
+        return;
+    }
+    if (!m_cyborProtocolEnabled) return;
+
+    // Only clients whose viewer was in range at the last snapshot
+    m_interestManager.GetViewersInRange(origin, m_viewersInRange);
+    for (size_t viewerIndex : m_viewersInRange) {
+        CyborPacketPtr packet = BeginBitMessage(MessageType::CYBOR_SIGNAL);
+        CyborSignalSchema::Write({ signal }, m_writer);
+        SendBitMessage(std::move(packet), m_viewerPeers[viewerIndex]);
+    }
+}
+
+bool CyborNetworkManager::SetCyborKey(const std::string& hexKey) {
+    if (!CyborPacketCrypto::ParseKey(hexKey, m_cyborKey)) {
+        std::cerr << "Cybor key must be 64 hex digits" << std::endl;
+        return false;
+    }
+    m_hasCyborKey = true;
+    return true;
+}
+
+void CyborNetworkManager::SendWorldSnapshot(const std::vector<CyborSnapshotCodec::EntityState>& entities) {
+    if (!IsServerRunning() || m_snapshotTimer < m_snapshotInterval) return;
+    m_snapshotTimer = std::min(m_snapshotTimer - m_snapshotInterval, m_snapshotInterval);
+
+    // Quantize once, then delta-encode per client against what it last acknowledged
+    m_worldSnapshot.sequence = m_snapshotSequence++;
+    m_worldSnapshot.serverTime = m_networkTime;
+    m_snapshotCodec.Quantize(entities.data(), entities.size(), m_worldSnapshot);
+    if (m_demoWriter) m_demoWriter->AddSnapshot(m_worldSnapshot);
+
+    m_viewers.clear();
+    m_viewerPeers.clear();
+    for (uint32_t peerId = 0; peerId < m_clients.size(); peerId++) {
+        const ClientConnection& client = m_clients[peerId];
+        // Gathered in the same order, and for the same clients, as the send loop below reads them
+        if (client.active && !client.isRelay && client.hasViewer) {
+            m_viewers.push_back({ peerId, client.viewerEntityId, client.viewerPosition, client.viewerTeam });
+            m_viewerPeers.push_back(peerId);
+        }
+    }
+    m_interestManager.Update(entities, m_viewers, m_networkTime);
+
+    size_t viewerIndex = 0;
+    for (uint32_t peerId = 0; peerId < m_clients.size(); peerId++) {
+        const ClientConnection& client = m_clients[peerId];
+        if (!client.active || client.isRelay) continue;
+
+        // A client that hasn't reported a position yet is offered the whole world
+        const std::vector<uint32_t>* relevant = nullptr;
+        const std::vector<uint32_t>* hidden = nullptr;
+        if (client.hasViewer) {
+            relevant = &m_interestManager.GetRelevantEntities(viewerIndex);
+            hidden = &m_interestManager.GetHiddenEntities(viewerIndex);
+            viewerIndex++;
+        }
+        SendClientSnapshot(peerId, m_worldSnapshot, GetSnapshotBudget(), relevant, hidden);
+    }
+
+    SendBroadcastSnapshot();
+}
+
+void CyborNetworkManager::SendClientSnapshot(uint32_t peerId, const CyborSnapshotCodec::Snapshot& world, size_t budget,
+                                             const std::vector<uint32_t>* relevant, const std::vector<uint32_t>* hidden) {
+    ClientConnection& client = m_clients[peerId];
+    const CyborSnapshotCodec::Snapshot* baseline =
+        client.hasAck ? client.sentSnapshots.Find(client.ackedSequence) : nullptr;
+    const uint32_t fixedBits = GatherEntities(client, world, relevant, baseline);
+
+    // Id gaps can make the estimate come out short; then the packet is packed again a little tighter
+    uint32_t budgetBits = static_cast<uint32_t>(budget * 8);
+    bool weighed = false;
+    CyborPacketPtr packet;
+    for (int attempt = 0; attempt < MAX_SNAPSHOT_PACKING_ATTEMPTS; attempt++) {
+        const uint32_t entityBudget = budgetBits > fixedBits ? budgetBits - fixedBits : 0;
+        if (!weighed && client.priorities.GetTotalBits() > entityBudget) {
+            WeighEntities(client, hidden);
+            weighed = true;
+        }
+        client.priorities.Select(entityBudget);
+        PackClientSnapshot(client, world);
+
+        // Encoded straight into this client's packet
+        packet = BeginBitMessage(MessageType::WORLD_SNAPSHOT);
+        m_snapshotCodec.Encode(m_clientSnapshot, baseline, m_writer);
+        m_writer.Finish();
+        if (!m_writer.HasOverflowed()) break;
+        budgetBits = budgetBits * 3 / 4;
+    }
+    client.priorities.Commit();
+    SendBitMessage(std::move(packet), peerId);
+
+    client.sentSnapshots.Store(m_clientSnapshot);
+}
+
+void CyborNetworkManager::SendBroadcastSnapshot() {
+    const int relays = GetRelayCount();
+    if (relays == 0) {
+        while (!m_broadcastSnapshots.empty()) {
+            m_spareSnapshots.push_back(std::move(m_broadcastSnapshots.front()));
+            m_broadcastSnapshots.pop_front();
+        }
+        return;
+    }
+
+    // Assigning into a recycled snapshot reuses its entity list
+    if (!m_spareSnapshots.empty()) {
+        m_broadcastSnapshots.push_back(std::move(m_spareSnapshots.back()));
+        m_spareSnapshots.pop_back();
+        m_broadcastSnapshots.back() = m_worldSnapshot;
+    } else {
+        m_broadcastSnapshots.push_back(m_worldSnapshot);
+    }
+
+    // The newest snapshot old enough goes out; any older ones still waiting are skipped
+    const float releaseTime = m_networkTime - m_broadcastDelay;
+    if (m_broadcastSnapshots.front().serverTime > releaseTime) return;
+    while (m_broadcastSnapshots.size() > 1 && m_broadcastSnapshots[1].serverTime <= releaseTime) {
+        m_spareSnapshots.push_back(std::move(m_broadcastSnapshots.front()));
+        m_broadcastSnapshots.pop_front();
+    }
+
+    // Relays sit on a fast link and see everything; only the packet limits them
+    const CyborSnapshotCodec::Snapshot& delayed = m_broadcastSnapshots.front();
+    for (uint32_t peerId = 0; peerId < m_clients.size(); peerId++) {
+        if (m_clients[peerId].active && m_clients[peerId].isRelay) {
+            SendClientSnapshot(peerId, delayed, GetMessageBudget(), nullptr, nullptr);
+        }
+    }
+    m_spareSnapshots.push_back(std::move(m_broadcastSnapshots.front()));
+    m_broadcastSnapshots.pop_front();
+}
+
+bool CyborNetworkManager::StartDemoRecording(const std::string& path) {
+    if (!IsServerRunning() || m_demoWriter) return false;
+
+    auto writer = std::make_unique<CyborDemoWriter>();
+    if (!writer->Open(path, m_snapshotCodec.GetSettings(), m_snapshotInterval)) return false;
+    m_demoWriter = std::move(writer);
+
+    // Players already here join at the start of the demo
+    for (const PlayerInfo& player : m_connectedPlayers) {
+        m_demoWriter->AddEvent({ GameEvent::Type::PLAYER_JOINED, player.peerId, 0, 0, player.name });
+    }
+    return true;
 }
 
-void CyborNetworkManager::BroadcastMessage(const std::string& message) {
-    if (!m_isConnected) return;
-    
-    std::cout << "Broadcasting message: " << message << std::endl;
+void CyborNetworkManager::StopDemoRecording() {
+    if (!m_demoWriter) return;
+    m_demoWriter->Close();
+    m_demoWriter.reset();
 }
 
-bool CyborNetworkManager::IsServer() const {
-    return m_isServer;
+int CyborNetworkManager::GetRelayCount() const {
+    int relays = 0;
+    for (const ClientConnection& client : m_clients) {
+        if (client.active && client.isRelay) relays++;
+    }
+    return relays;
 }
 
-bool CyborNetworkManager::IsClient() const {
-    return m_isClient;
+uint32_t CyborNetworkManager::GatherEntities(ClientConnection& client, const CyborSnapshotCodec::Snapshot& world,
+                                             const std::vector<uint32_t>* relevant,
+                                             const CyborSnapshotCodec::Snapshot* baseline) {
+    static const std::vector<CyborSnapshotCodec::NetEntity> noEntities;
+    const std::vector<CyborSnapshotCodec::NetEntity>& previous = baseline ? baseline->entities : noEntities;
+
+    // Under load distant entities take turns being refreshed, staggered by id
+    const uint32_t refreshMask = (1u << m_snapshotDetailLevel) - 1;
+    const CyborSnapshotCodec::Snapshot* latest =
+        refreshMask && client.hasViewer ? client.sentSnapshots.GetLatest() : nullptr;
+    const std::vector<CyborSnapshotCodec::NetEntity>& sent = latest ? latest->entities : noEntities;
+    const float distantRangeSq = DISTANT_ENTITY_RANGE * DISTANT_ENTITY_RANGE;
+
+    client.priorities.Begin();
+    m_packedEntities.clear();
+    uint32_t fixedBits = 8 + CyborSnapshotCodec::GetHeaderBits(baseline != nullptr); // Message type too
+
+    // The world, relevant, baseline and sent lists are all sorted by id
+    size_t r = 0;
+    size_t p = 0;
+    size_t s = 0;
+    for (const auto& worldEntity : world.entities) {
+        if (relevant) {
+            while (r < relevant->size() && (*relevant)[r] < worldEntity.entityId) r++;
+            if (r == relevant->size()) break;
+            if ((*relevant)[r] != worldEntity.entityId) continue;
+        }
+
+        // Off its turn a distant entity repeats the state last sent, so the client sees no change.
+        // Leaving it out would read as a removal.
+        const CyborSnapshotCodec::NetEntity* current = &worldEntity;
+        if (latest && ((worldEntity.entityId + world.sequence) & refreshMask) != 0) {
+            glm::vec3 offset;
+            for (int axis = 0; axis < 3; axis++) {
+                offset[axis] = m_snapshotCodec.DequantizePosition(worldEntity.position[axis], axis) -
+                               client.viewerPosition[axis];
+            }
+            if (glm::dot(offset, offset) > distantRangeSq) {
+                while (s < sent.size() && sent[s].entityId < worldEntity.entityId) s++;
+                if (s < sent.size() && sent[s].entityId == worldEntity.entityId) current = &sent[s];
+            }
+        }
+        const CyborSnapshotCodec::NetEntity& entity = *current;
+
+        // Whatever the baseline had that this client no longer sees is removed
+        while (p < previous.size() && previous[p].entityId < entity.entityId) {
+            fixedBits += CyborSnapshotCodec::GetRemovedEntityBits();
+            p++;
+        }
+        const CyborSnapshotCodec::NetEntity* entityBaseline =
+            p < previous.size() && previous[p].entityId == entity.entityId ? &previous[p++] : nullptr;
+
+        // Unchanged since the baseline costs nothing and needs no turn
+        const uint32_t bits = m_snapshotCodec.GetEntityBits(entity, entityBaseline, baseline != nullptr);
+        if (bits == 0) {
+            m_packedEntities.push_back({ &entity, entityBaseline, -1 });
+            continue;
+        }
+        const bool required = client.hasViewer && entity.entityId == client.viewerEntityId;
+        const size_t candidate = client.priorities.Add(entity.entityId, bits, required);
+        m_packedEntities.push_back({ &entity, entityBaseline, static_cast<int32_t>(candidate) });
+    }
+    fixedBits += static_cast<uint32_t>(previous.size() - p) * CyborSnapshotCodec::GetRemovedEntityBits();
+    return fixedBits;
+}
+
+void CyborNetworkManager::WeighEntities(ClientConnection& client, const std::vector<uint32_t>* hidden) {
+    const float distantRangeSq = DISTANT_ENTITY_RANGE * DISTANT_ENTITY_RANGE;
+    const float distantWeight = 1.0f / static_cast<float>(1u << m_snapshotDetailLevel);
+
+    size_t h = 0;
+    for (const PackedEntity& packed : m_packedEntities) {
+        if (packed.candidate < 0) continue;
+        const CyborSnapshotCodec::NetEntity& entity = *packed.entity;
+
+        float weight = 1.0f;
+        if (client.hasViewer) {
+            glm::vec3 offset;
+            for (int axis = 0; axis < 3; axis++) {
+                offset[axis] = m_snapshotCodec.DequantizePosition(entity.position[axis], axis) - client.viewerPosition[axis];
+            }
+            const float distanceSq = glm::dot(offset, offset);
+            if (distanceSq > PRIORITY_NEAR_DISTANCE * PRIORITY_NEAR_DISTANCE) {
+                weight = PRIORITY_NEAR_DISTANCE / std::sqrt(distanceSq);
+            }
+            // Under load distant entities wait longer for their turn
+            if (distanceSq > distantRangeSq) weight *= distantWeight;
+
+            while (h < hidden->size() && (*hidden)[h] < entity.entityId) h++;
+            if (h < hidden->size() && (*hidden)[h] == entity.entityId) weight *= PRIORITY_HIDDEN_WEIGHT;
+        }
+        if (!packed.baseline) {
+            weight *= PRIORITY_NEW_ENTITY_WEIGHT;
+        } else if (entity.health != packed.baseline->health || entity.armor != packed.baseline->armor ||
+                   entity.weaponType != packed.baseline->weaponType || entity.flags != packed.baseline->flags) {
+            weight *= PRIORITY_STATUS_CHANGE_WEIGHT;
+        }
+        client.priorities.AddWeight(packed.candidate, weight);
+    }
+}
+
+void CyborNetworkManager::PackClientSnapshot(const ClientConnection& client, const CyborSnapshotCodec::Snapshot& world) {
+    m_clientSnapshot.sequence = world.sequence;
+    m_clientSnapshot.serverTime = world.serverTime;
+    m_clientSnapshot.entities.clear();
+
+    // An entity that didn't make it repeats what the client acknowledged, which costs nothing;
+    // one the client has never had waits to appear
+    for (const PackedEntity& packed : m_packedEntities) {
+        if (packed.candidate < 0 || client.priorities.IsSelected(packed.candidate)) {
+            m_clientSnapshot.entities.push_back(*packed.entity);
+        } else if (packed.baseline) {
+            m_clientSnapshot.entities.push_back(*packed.baseline);
+        }
+    }
+}
+
+size_t CyborNetworkManager::GetSnapshotBudget() const {
+    size_t budget = GetMessageBudget();
+    if (m_clientBandwidthLimit > 0) {
+        budget = std::min(budget, static_cast<size_t>(m_clientBandwidthLimit * m_snapshotInterval));
+    }
+    return budget;
+}
+
+void CyborNetworkManager::SendInputCommands(std::vector<CyborInputCommand>& commands) {
+    if (commands.empty()) return;
+    if (!IsConnected()) {
+        commands.clear();
+        return;
+    }
+
+    m_recentCommands.insert(m_recentCommands.end(), commands.begin(), commands.end());
+    commands.clear();
+    if (m_recentCommands.size() > REDUNDANT_COMMANDS) {
+        m_recentCommands.erase(m_recentCommands.begin(), m_recentCommands.end() - REDUNDANT_COMMANDS);
+    }
+
+    CyborPacketPtr packet = BeginBitMessage(MessageType::INPUT_COMMANDS);
+    m_writer.WriteBits(static_cast<uint32_t>(m_recentCommands.size()), 4);
+    for (const auto& command : m_recentCommands) {
+        m_writer.WriteBits(command.sequence, 32);
+        m_writer.WriteFloat(command.deltaTime);
+        m_writer.WriteBits(static_cast<uint16_t>(static_cast<int16_t>(command.yaw * CyborInputCommand::ANGLE_STEPS_PER_DEGREE)), 16);
+        m_writer.WriteBits(static_cast<uint16_t>(static_cast<int16_t>(command.pitch * CyborInputCommand::ANGLE_STEPS_PER_DEGREE)), 16);
+        m_writer.WriteBits(command.buttons, 7);
+    }
+    SendBitMessage(std::move(packet));
+}
+
+bool CyborNetworkManager::PollAuthoritativeState(uint32_t& outLastProcessedSequence, CyborMoveState& outState) {
+    if (!m_hasAuthoritativeState) return false;
+
+    outLastProcessedSequence = m_authoritativeSequence;
+    outState = m_authoritativeState;
+    m_hasAuthoritativeState = false;
+    return true;
+}
+
+std::vector<CyborInputCommand>& CyborNetworkManager::GetClientCommands(uint32_t peerId) {
+    if (peerId >= m_clients.size()) return m_noCommands;
+    return m_clients[peerId].commands;
+}
+
+void CyborNetworkManager::SendPlayerState(uint32_t peerId, uint32_t lastProcessedSequence, const CyborMoveState& state) {
+    if (!IsServerRunning()) return;
+
+    CyborPacketPtr packet = BeginBitMessage(MessageType::PLAYER_STATE);
+    PlayerStateSchema::Write({ lastProcessedSequence, state.position, state.velocity, state.isOnGround, state.isCrouching },
+                             m_writer);
+    SendBitMessage(std::move(packet), peerId);
+}
+
+void CyborNetworkManager::SetClientViewer(uint32_t peerId, uint32_t entityId, const glm::vec3& eyePosition, uint8_t team) {
+    if (peerId >= m_clients.size() || m_clients[peerId].isRelay) return;
+
+    ClientConnection& client = m_clients[peerId];
+    client.hasViewer = true;
+    client.viewerEntityId = entityId;
+    client.viewerPosition = eyePosition;
+    client.viewerTeam = team;
+}
+
+bool CyborNetworkManager::GetLatestWorldState(std::vector<CyborSnapshotCodec::EntityState>& outStates,
+                                              float& outServerTime) const {
+    const CyborSnapshotCodec::Snapshot* snapshot = m_receivedSnapshots.GetLatest();
+    if (!snapshot) return false;
+
+    outStates.resize(snapshot->entities.size());
+    for (size_t i = 0; i < snapshot->entities.size(); i++) {
+        m_snapshotCodec.Dequantize(snapshot->entities[i], outStates[i]);
+    }
+    outServerTime = snapshot->serverTime;
+    return true;
 }
 
-bool CyborNetworkManager::IsConnected() const {
-    return m_isConnected;
+bool CyborNetworkManager::GetInterpolatedWorldState(std::vector<CyborSnapshotCodec::EntityState>& outStates) const {
+    return m_interpolationBuffer.Sample(m_networkTime, outStates);
+}
+
+CyborNetworkManager::PlayerRoster CyborNetworkManager::GetConnectedPlayers() const {
+    return std::atomic_load(&m_publishedPlayers);
 }
 
 int CyborNetworkManager::GetPlayerCount() const {
-    return m_currentPlayers;
+    return static_cast<int>(GetConnectedPlayers()->size());
 }
 
-float CyborNetworkManager::GetLatency() const {
-    return m_networkLatency;
+void CyborNetworkManager::ProcessIncomingPackets() {
+    CyborUdpTransport::Event event;
+    while (m_transport.PollEvent(event)) {
+        switch (event.type) {
+            case CyborUdpTransport::Event::Type::CONNECTED:
+                if (m_isServer && event.peerId < m_clients.size()) {
+                    ClientConnection& client = m_clients[event.peerId];
+                    client.active = true;
+                    client.hasAck = false;
+                    client.hasViewer = false;
+                    client.viewerEntityId = CyborInterestManager::NO_ENTITY;
+                    client.viewerTeam = CyborInterestManager::NO_TEAM;
+                    client.commands.clear();
+                    client.hasCommands = false;
+                    client.sentSnapshots.Clear();
+                    client.priorities.Clear();
+                    client.isRelay = false;
+                }
+                if (m_isClient) {
+                    m_connected = true;
+                    std::cout << "Connected to Cybor Network Server at " << m_serverIP << ":"
+                              << m_serverPort_client << std::endl;
+                }
+
+                if (event.peerId < m_channels.size()) m_channels[event.peerId].Reset();
+                if (event.peerId < m_connectionStats.size()) m_connectionStats[event.peerId].Reset();
+
+                // A fresh salt per connection means fresh session keys
+                if (event.peerId < m_peerSecurity.size()) {
+                    PeerSecurity& security = m_peerSecurity[event.peerId];
+                    security.crypto.Clear();
+                    security.verified = false;
+                    security.hasIntroduction = false;
+                    CyborPacketCrypto::GenerateSalt(security.localSalt);
+                }
+
+                // The client introduces itself, repeating until the server answers; the server
+                // answers every introduction, so an answer means both sides have both salts
+                if (m_isClient) {
+                    m_hasServerInfo = false;
+                    SendPlayerInfo(event.peerId);
+                }
+                break;
+
+            case CyborUdpTransport::Event::Type::DISCONNECTED:
+                if (m_isServer && event.peerId < m_clients.size()) {
+                    if (m_clients[event.peerId].isRelay) std::cout << "Broadcast relay disconnected" << std::endl;
+                    m_clients[event.peerId].active = false;
+                }
+                if (event.peerId < m_channels.size()) m_channels[event.peerId].Reset();
+                if (event.peerId < m_connectionStats.size()) m_connectionStats[event.peerId].Reset();
+                HandlePlayerDisconnect(event.peerId);
+                if (m_isClient && m_connected) {
+                    m_connected = false;
+                    std::cout << "Lost connection to Cybor Network Server" << std::endl;
+                }
+                break;
+
+            case CyborUdpTransport::Event::Type::PAYLOAD:
+                if (event.peerId < m_connectionStats.size()) {
+                    m_connectionStats[event.peerId].AddReceivedBytes(event.packet->Size() + CyborUdpTransport::HEADER_SIZE);
+                }
+                if (DecryptCyborPacket(event.peerId, *event.packet)) {
+                    ReceivePacket(event.peerId, *event.packet, event.time);
+                }
+                break;
+        }
+    }
 }
 
-float CyborNetworkManager::GetPacketLoss() const {
-    return m_packetLoss;
+void CyborNetworkManager::ReceivePacket(uint32_t peerId, CyborPacketBuffer& packet, double time) {
+    if (packet.Empty()) return;
+    m_receiveTime = time;
+
+    // Only the handshake travels outside the channel
+    if (packet[0] != static_cast<uint8_t>(MessageType::CHANNEL)) {
+        if (packet[0] == static_cast<uint8_t>(MessageType::PLAYER_INFO)) HandleMessage(peerId, packet);
+        return;
+    }
+    if (peerId >= m_channels.size()) return;
+
+    CyborReliableChannel& channel = m_channels[peerId];
+    packet.Consume(1);
+    if (!channel.ReadPacket(packet)) return;
+    if (peerId < m_connectionStats.size()) {
+        const CyborReliableChannel::PacketHeader& header = channel.GetLastReadHeader();
+        m_connectionStats[peerId].OnPacketReceived(header.sequence, header.ack, header.ackBits, time);
+    }
+    if (!packet.Empty()) HandleMessage(peerId, packet);
+
+    // Reliable messages now in order, including any a loss had held back
+    if (!channel.HasMessage()) return;
+    CyborPacketPtr message = m_transport.AcquirePacket();
+    while (channel.PopMessage(*message)) {
+        HandleMessage(peerId, *message);
+    }
 }
 
-void CyborNetworkManager::SetMaxPlayers(int maxPlayers) {
-    m_maxPlayers = maxPlayers;
-    std::cout << "Max players set to: " << maxPlayers << std::endl;
+void CyborNetworkManager::HandleMessage(uint32_t peerId, const CyborPacketBuffer& data) {
+    if (data.Empty()) return;
+
+    switch (static_cast<MessageType>(data[0])) {
+        case MessageType::PLAYER_INFO: {
+            PlayerInfoMessage info;
+            if (!ReadMessage<PlayerInfoSchema>(data, info)) {
+                std::cerr << "Malformed player info from peer " << peerId << std::endl;
+                return;
+            }
+            if (!IsEncrypting()) {
+                AdmitPeer(peerId, std::string(info.name), info.cyborEnhanced, info.relay);
+            } else if (peerId < m_peerSecurity.size()) {
+                // Anyone can send the clear-text handshake; the peer joins once it proves it
+                // holds the key, see DecryptCyborPacket
+                PeerSecurity& security = m_peerSecurity[peerId];
+                if (!security.verified) {
+                    security.hasIntroduction = true;
+                    security.introducedName = std::string(info.name);
+                    security.introducedCybor = info.cyborEnhanced;
+                    security.introducedRelay = info.relay;
+                }
+
+                // Keys are derived once per connection; re-deriving would restart the nonce sequence
+                if (!security.crypto.IsReady()) {
+                    const uint8_t* remoteSalt = info.salt.data();
+                    security.crypto.DeriveKeys(m_cyborKey, m_isServer ? remoteSalt : security.localSalt,
+                                               m_isServer ? security.localSalt : remoteSalt, m_isServer);
+                }
+            }
+
+            if (m_isServer) {
+                SendPlayerInfo(peerId);
+            } else {
+                m_hasServerInfo = true;
+            }
+            break;
+        }
+
+        case MessageType::PLAYER_UPDATE: {
+            const CyborSnapshotCodec::QuantizationSettings& settings = m_snapshotCodec.GetSettings();
+            CyborBitReader reader(data.Data() + 1, data.Size() - 1);
+            glm::vec3 position, rotation;
+            for (int axis = 0; axis < 3; axis++) {
+                position[axis] = m_snapshotCodec.DequantizePosition(reader.ReadBits(settings.positionBits), axis);
+            }
+            for (int axis = 0; axis < 3; axis++) {
+                rotation[axis] = m_snapshotCodec.DequantizeAngle(reader.ReadBits(settings.angleBits));
+            }
+            if (reader.HasOverflowed()) return;
+
+            // Relays see the whole world and have no position of their own
+            if (m_isServer && peerId < m_clients.size()) {
+                if (m_clients[peerId].isRelay) return;
+                m_clients[peerId].hasViewer = true;
+                m_clients[peerId].viewerPosition = position;
+            }
+
+            if (PlayerInfo* player = FindPlayer(peerId)) {
+                player->position = position;
+                player->rotation = rotation;
+                m_playersChanged = true;
+            }
+            break;
+        }
+
+        case MessageType::WEAPON_FIRE: {
+            // Only players shoot; the game fires from where it has the shooter, the origin is not trusted
+            if (!m_isServer || !FindPlayer(peerId)) return;
+            WeaponFireMessage message;
+            if (!ReadMessage<WeaponFireSchema>(data, message)) return;
+            const float length = glm::length(message.direction);
+            if (!std::isfinite(length) || length < 1e-3f || !std::isfinite(message.viewTime)) return;
+
+            const float viewAge = std::min(std::max(m_networkTime - message.viewTime, 0.0f), MAX_SHOT_VIEW_AGE);
+            if (m_remoteShots.size() >= MAX_QUEUED_REMOTE_SHOTS) m_remoteShots.pop_front();
+            m_remoteShots.push_back({ peerId, message.direction / length, viewAge });
+            break;
+        }
+
+        case MessageType::CHAT_MESSAGE: {
+            ChatMessage chat;
+            if (!ReadMessage<ChatSchema>(data, chat)) return;
+            std::cout << "[Chat] " << chat.sender << ": " << chat.text << std::endl;
+
+            // The server relays chat to everyone else
+            if (m_isServer) {
+                for (const PlayerInfo& player : m_connectedPlayers) {
+                    if (player.peerId != peerId) QueueReliable(player.peerId, data);
+                }
+            }
+            break;
+        }
+
+        case MessageType::GAME_EVENT: {
+            GameEventMessage message;
+            if (!ReadMessage<GameEventSchema>(data, message)) return;
+            GameEvent event;
+            event.type = message.type;
+            event.subjectId = message.subjectId;
+            event.instigatorId = message.instigatorId;
+            event.value = message.value;
+            event.text.assign(message.text);
+
+            if (m_gameEvents.size() >= MAX_QUEUED_GAME_EVENTS) m_gameEvents.pop_front();
+            m_gameEvents.push_back(std::move(event));
+            break;
+        }
+
+        case MessageType::CYBOR_SIGNAL: {
+            CyborSignalMessage message;
+            if (!ReadMessage<CyborSignalSchema>(data, message)) return;
+            std::cout << "Cybor signal received: " << message.signal << std::endl;
+            break;
+        }
+
+        case MessageType::WORLD_SNAPSHOT:
+            if (m_isClient) HandleWorldSnapshot(peerId, data);
+            break;
+
+        case MessageType::INPUT_COMMANDS: {
+            if (!m_isServer || peerId >= m_clients.size()) return;
+            ClientConnection& client = m_clients[peerId];
+            CyborBitReader reader(data.Data() + 1, data.Size() - 1);
+            float pendingTime = 0.0f;
+            for (const auto& pending : client.commands) pendingTime += pending.deltaTime;
+
+            const uint32_t count = reader.ReadBits(4);
+            for (uint32_t i = 0; i < count; i++) {
+                CyborInputCommand command;
+                command.sequence = reader.ReadBits(32);
+                command.deltaTime = reader.ReadFloat();
+                command.yaw = static_cast<int16_t>(reader.ReadBits(16)) / CyborInputCommand::ANGLE_STEPS_PER_DEGREE;
+                command.pitch = static_cast<int16_t>(reader.ReadBits(16)) / CyborInputCommand::ANGLE_STEPS_PER_DEGREE;
+                command.buttons = static_cast<uint8_t>(reader.ReadBits(7));
+                if (reader.HasOverflowed()) return;
+
+                // Redundant copies of commands we already have are skipped
+                if (client.hasCommands && command.sequence <= client.lastCommandSequence) continue;
+
+                // A command that would stall or fast-forward the player is dropped or cut short
+                const bool valid = std::isfinite(command.deltaTime) && command.deltaTime > 0.0f;
+                command.deltaTime = valid ? std::min(command.deltaTime, MAX_COMMAND_DELTA_TIME) : 0.0f;
+
+                // Beyond the budget the rest wait for their redundant copies in a later packet
+                if (client.commands.size() >= MAX_PENDING_COMMANDS ||
+                    pendingTime + command.deltaTime > MAX_PENDING_COMMAND_TIME) {
+                    break;
+                }
+                client.lastCommandSequence = command.sequence;
+                client.hasCommands = true;
+                if (!valid) continue;
+                client.commands.push_back(command);
+                pendingTime += command.deltaTime;
+            }
+            break;
+        }
+
+        case MessageType::PLAYER_STATE: {
+            if (!m_isClient) return;
+            PlayerStateMessage message;
+            if (!ReadMessage<PlayerStateSchema>(data, message)) return;
+
+            if (!m_hasAuthoritativeState || message.sequence >= m_authoritativeSequence) {
+                m_authoritativeSequence = message.sequence;
+                m_authoritativeState.position = message.position;
+                m_authoritativeState.velocity = message.velocity;
+                m_authoritativeState.isOnGround = message.onGround;
+                m_authoritativeState.isCrouching = message.crouching;
+                m_hasAuthoritativeState = true;
+            }
+            break;
+        }
+
+        case MessageType::SNAPSHOT_ACK: {
+            SnapshotAckMessage ack;
+            if (!m_isServer || peerId >= m_clients.size() || !ReadMessage<SnapshotAckSchema>(data, ack)) return;
+            ClientConnection& client = m_clients[peerId];
+            if (!client.hasAck || CyborSnapshotHistory::SequenceGreaterThan(ack.sequence, client.ackedSequence)) {
+                client.ackedSequence = ack.sequence;
+                client.hasAck = true;
+            }
+            break;
+        }
+
+        case MessageType::CHANNEL:
+        case MessageType::SEALED:
+            // Unwrapped by ReceivePacket and DecryptCyborPacket; a nested one is malformed
+            break;
+    }
+}
+
+void CyborNetworkManager::HandleWorldSnapshot(uint32_t peerId, const CyborPacketBuffer& data) {
+    CyborBitReader reader(data.Data() + 1, data.Size() - 1);
+    CyborSnapshotCodec::Snapshot snapshot;
+    if (!m_snapshotCodec.Decode(reader, m_receivedSnapshots, snapshot)) {
+        // Baseline already gone; the server falls back to a full snapshot once acks stop advancing
+        return;
+    }
+
+    // Server time stamps every snapshot, which gives jitter over one-way transit
+    if (peerId < m_connectionStats.size()) m_connectionStats[peerId].OnTimestamp(snapshot.serverTime, m_receiveTime);
+
+    const CyborSnapshotCodec::Snapshot* latest = m_receivedSnapshots.GetLatest();
+    if (latest && !CyborSnapshotHistory::SequenceGreaterThan(snapshot.sequence, latest->sequence)) return;
+    m_receivedSnapshots.Store(snapshot);
+
+    m_decodedStates.resize(snapshot.entities.size());
+    for (size_t i = 0; i < snapshot.entities.size(); i++) {
+        m_snapshotCodec.Dequantize(snapshot.entities[i], m_decodedStates[i]);
+    }
+    m_interpolationBuffer.AddSnapshot(snapshot.sequence, snapshot.serverTime, m_networkTime, m_decodedStates);
+
+    CyborPacketPtr packet = BeginBitMessage(MessageType::SNAPSHOT_ACK);
+    SnapshotAckSchema::Write({ snapshot.sequence }, m_writer);
+    SendBitMessage(std::move(packet), peerId);
+}
+
+void CyborNetworkManager::SendPacket(CyborPacketPtr packet, uint32_t peerId) {
+    if (peerId == CyborUdpTransport::INVALID_PEER) {
+        // A client's only peer is the server
+        if (!m_isServer) {
+            peerId = 0;
+        } else {
+            // Each channel frames its packets differently, so a broadcast becomes one copy per client
+            for (uint32_t target = 0; target < m_clients.size(); target++) {
+                if (!m_clients[target].active || m_clients[target].isRelay) continue;
+                CyborPacketPtr copy = m_transport.AcquirePacket();
+                copy->Append(packet->Data(), packet->Size());
+                SendPacket(std::move(copy), target);
+            }
+            return;
+        }
+    }
+    if (peerId >= m_channels.size()) return;
+
+    // Everything but the handshake picks up the channel's acks and any reliable messages due
+    if (packet->Empty() || (*packet)[0] != static_cast<uint8_t>(MessageType::PLAYER_INFO)) {
+        if (!m_channels[peerId].WritePacket(*packet, GetMessageBudget(), m_networkTime)) return;
+        uint8_t* type = packet->Prepend(1);
+        if (!type) return;
+        *type = static_cast<uint8_t>(MessageType::CHANNEL);
+        m_connectionStats[peerId].OnPacketSent(m_channels[peerId].GetLastWrittenSequence(), CyborUdpTransport::Now());
+    }
+
+    if (IsEncrypting() && !EncryptCyborPacket(peerId, *packet)) return;
+
+    const size_t size = packet->Size();
+    if (!m_transport.Send(peerId, std::move(packet))) {
+        // Too big for a datagram, or the network thread is behind and the send queue is full
+        std::cerr << "Dropped network message (" << size << " bytes)" << std::endl;
+        return;
+    }
+    m_connectionStats[peerId].AddSentBytes(size + CyborUdpTransport::HEADER_SIZE);
+}
+
+CyborPacketPtr CyborNetworkManager::BeginBitMessage(MessageType type) {
+    CyborPacketPtr packet = m_transport.AcquirePacket();
+    m_writer.Reset(packet->Tail(), std::min(packet->GetTailroom(), GetMessageBudget()));
+    m_writer.WriteBits(static_cast<uint32_t>(type), 8);
+    return packet;
+}
+
+bool CyborNetworkManager::EndBitMessage(CyborPacketBuffer& packet) {
+    m_writer.Finish();
+    if (m_writer.HasOverflowed()) {
+        std::cerr << "Dropped network message larger than a packet buffer" << std::endl;
+        return false;
+    }
+    packet.Commit(m_writer.GetBytesWritten());
+    return true;
+}
+
+void CyborNetworkManager::SendBitMessage(CyborPacketPtr packet, uint32_t peerId) {
+    if (EndBitMessage(*packet)) SendPacket(std::move(packet), peerId);
+}
+
+size_t CyborNetworkManager::GetMessageBudget() const {
+    size_t budget = CyborUdpTransport::MAX_PAYLOAD_SIZE - 1 - CyborReliableChannel::HEADER_SIZE;
+    if (IsEncrypting()) budget -= 1 + CyborPacketCrypto::OVERHEAD;
+    return budget;
+}
+
+void CyborNetworkManager::SendReliable(CyborPacketPtr packet, uint32_t peerId) {
+    if (peerId != CyborUdpTransport::INVALID_PEER) {
+        QueueReliable(peerId, *packet);
+    } else if (!m_isServer) {
+        QueueReliable(0, *packet);
+    } else {
+        for (uint32_t target = 0; target < m_clients.size(); target++) {
+            if (m_clients[target].active && !m_clients[target].isRelay) QueueReliable(target, *packet);
+        }
+    }
+}
+
+void CyborNetworkManager::QueueReliable(uint32_t peerId, const CyborPacketBuffer& message) {
+    if (peerId >= m_channels.size()) return;
+    if (!m_channels[peerId].Queue(message.Data(), message.Size())) {
+        std::cerr << "Dropped reliable message for peer " << peerId << " (too large or too much waiting)" << std::endl;
+    }
+}
+
+void CyborNetworkManager::QueueGameEvent(const GameEvent& event, uint32_t peerId) {
+    CyborPacketPtr packet = BeginBitMessage(MessageType::GAME_EVENT);
+    GameEventSchema::Write({ event.type, event.subjectId, event.instigatorId, event.value, event.text }, m_writer);
+    if (EndBitMessage(*packet)) SendReliable(std::move(packet), peerId);
+}
+
+void CyborNetworkManager::FlushReliableChannels() {
+    // Acks owed and reliable messages due that no packet carried last tick go out on their own
+    for (uint32_t peerId = 0; peerId < m_channels.size(); peerId++) {
+        if (IsPeerConnected(peerId) && m_channels[peerId].WantsToSend(m_networkTime)) {
+            SendPacket(m_transport.AcquirePacket(), peerId);
+        }
+    }
+}
+
+void CyborNetworkManager::UpdateConnectionStats(float deltaTime) {
+    const double now = CyborUdpTransport::Now();
+    m_pingRefreshTimer += deltaTime;
+    const bool refreshPings = m_pingRefreshTimer >= PING_REFRESH_INTERVAL;
+    if (refreshPings) m_pingRefreshTimer = 0.0f;
+
+    float rtt = 0.0f;
+    float loss = 0.0f;
+    float bandwidth = 0.0f;
+    int measured = 0;
+    for (uint32_t peerId = 0; peerId < m_connectionStats.size(); peerId++) {
+        if (!IsPeerConnected(peerId)) continue;
+        CyborNetworkStats& stats = m_connectionStats[peerId];
+        stats.Update(now);
+        m_channels[peerId].SetResendDelay(stats.GetRetransmitTimeout());
+
+        const CyborNetworkStats::Summary& summary = stats.GetSummary();
+        bandwidth += summary.sendBandwidth + summary.receiveBandwidth;
+        if (!summary.hasRtt) continue;
+        rtt += summary.rtt;
+        loss += summary.packetLoss;
+        measured++;
+
+        if (refreshPings) {
+            if (PlayerInfo* player = FindPlayer(peerId)) {
+                const int ping = static_cast<int>(summary.rtt * 1000.0f + 0.5f);
+                if (player->ping != ping) {
+                    player->ping = ping;
+                    m_playersChanged = true;
+                }
+            }
+        }
+    }
+
+    m_ping = measured ? static_cast<int>(rtt / measured * 1000.0f + 0.5f) : 0;
+    m_packetLoss = measured ? loss / measured : 0.0f;
+    m_bandwidth = bandwidth;
+}
+
+bool CyborNetworkManager::GetConnectionStats(uint32_t peerId, CyborNetworkStats::Summary& outStats) const {
+    if (peerId >= m_connectionStats.size() || !IsPeerConnected(peerId)) return false;
+    outStats = m_connectionStats[peerId].GetSummary();
+    return true;
+}
+
+void CyborNetworkManager::SendPlayerInfo(uint32_t peerId) {
+    if (peerId >= m_peerSecurity.size()) return;
+
+    PlayerInfoMessage info;
+    info.name = m_localPlayerName;
+    info.cyborEnhanced = m_cyborProtocolEnabled;
+    info.relay = !m_isServer && m_isBroadcastRelay;
+    std::memcpy(info.salt.data(), m_peerSecurity[peerId].localSalt, CyborPacketCrypto::SALT_SIZE);
+
+    CyborPacketPtr packet = BeginBitMessage(MessageType::PLAYER_INFO);
+    PlayerInfoSchema::Write(info, m_writer);
+    SendBitMessage(std::move(packet), peerId);
+    m_playerInfoTimer = 0.0f;
+}
+
+bool CyborNetworkManager::IsPeerConnected(uint32_t peerId) const {
+    if (m_isServer) return peerId < m_clients.size() && m_clients[peerId].active;
+    return m_isClient && m_connected && peerId == 0;
+}
+
+bool CyborNetworkManager::EncryptCyborPacket(uint32_t peerId, CyborPacketBuffer& packet) {
+    // The handshake carries the salts, so it is the one message sent in the clear
+    if (!packet.Empty() && packet[0] == static_cast<uint8_t>(MessageType::PLAYER_INFO)) return true;
+
+    // No keys yet: drop rather than leak plaintext
+    if (peerId >= m_peerSecurity.size() || !m_peerSecurity[peerId].crypto.Seal(packet)) return false;
+
+    uint8_t* type = packet.Prepend(1);
+    if (!type) return false;
+    *type = static_cast<uint8_t>(MessageType::SEALED);
+    return true;
+}
+
+bool CyborNetworkManager::DecryptCyborPacket(uint32_t peerId, CyborPacketBuffer& packet) {
+    if (packet.Empty()) return false;
+
+    // With encryption on, anything else in the clear is forged or from a misconfigured peer
+    if (packet[0] != static_cast<uint8_t>(MessageType::SEALED)) {
+        return !IsEncrypting() || packet[0] == static_cast<uint8_t>(MessageType::PLAYER_INFO);
+    }
+    if (peerId >= m_peerSecurity.size()) return false;
+
+    PeerSecurity& security = m_peerSecurity[peerId];
+    packet.Consume(1);
+    if (!security.crypto.Open(packet)) return false;
+
+    // The first sealed packet proves the peer holds the key; only now does its introduction count
+    if (!security.verified) {
+        security.verified = true;
+        if (security.hasIntroduction) {
+            AdmitPeer(peerId, security.introducedName, security.introducedCybor, security.introducedRelay);
+        }
+    }
+    return true;
+}
+
+void CyborNetworkManager::AdmitPeer(uint32_t peerId, const std::string& name, bool cyborEnhanced, bool relay) {
+    if (m_isServer && relay && peerId < m_clients.size()) {
+        if (m_clients[peerId].isRelay) return;
+
+        // An undelayed or unvetted relay would hand anyone a live view of the whole world
+        const std::string address = m_transport.GetPeerAddress(peerId);
+        const std::string host = address.substr(0, address.rfind(':'));
+        if (m_broadcastDelay <= 0.0f ||
+            std::find(m_relayAddresses.begin(), m_relayAddresses.end(), host) == m_relayAddresses.end()) {
+            std::cerr << "Refused broadcast relay " << name << " from " << address
+                      << (m_broadcastDelay <= 0.0f ? ": no broadcast delay is set" : ": address not allowed")
+                      << std::endl;
+            m_transport.DisconnectPeer(peerId);
+            return;
+        }
+        std::cout << "Broadcast relay " << name << " connected from " << address << std::endl;
+        m_clients[peerId].isRelay = true;
+        m_clients[peerId].hasViewer = false;
+        return;
+    }
+
+    HandlePlayerConnect(peerId, name);
+    if (PlayerInfo* player = FindPlayer(peerId)) {
+        player->isCyborEnhanced = cyborEnhanced;
+    }
+}
+
+void CyborNetworkManager::HandlePlayerConnect(uint32_t peerId, const std::string& playerName) {
+    m_playersChanged = true;
+    if (PlayerInfo* player = FindPlayer(peerId)) {
+        player->name = playerName;
+        return;
+    }
+
+    PlayerInfo player;
+    player.peerId = peerId;
+    player.name = playerName;
+    player.ipAddress = m_transport.GetPeerAddress(peerId);
+    player.ping = 0;
+    player.score = 0;
+    player.isCyborEnhanced = false;
+    player.position = glm::vec3(0.0f);
+    player.rotation = glm::vec3(0.0f);
+    m_connectedPlayers.push_back(player);
+
+    std::cout << playerName << " joined from " << player.ipAddress << std::endl;
+
+    // Everyone hears about everyone else exactly once
+    if (m_isServer) {
+        const GameEvent joined{ GameEvent::Type::PLAYER_JOINED, peerId, 0, 0, playerName };
+        if (m_demoWriter) m_demoWriter->AddEvent(joined);
+        for (const PlayerInfo& other : m_connectedPlayers) {
+            if (other.peerId == peerId) continue;
+            QueueGameEvent(joined, other.peerId);
+            QueueGameEvent({ GameEvent::Type::PLAYER_JOINED, other.peerId, 0, 0, other.name }, peerId);
+        }
+    }
+}
+
+void CyborNetworkManager::HandlePlayerDisconnect(uint32_t peerId) {
+    auto it = std::find_if(m_connectedPlayers.begin(), m_connectedPlayers.end(),
+        [peerId](const PlayerInfo& player) { return player.peerId == peerId; });
+    if (it == m_connectedPlayers.end()) return;
+
+    std::cout << it->name << " left the game" << std::endl;
+    const GameEvent left{ GameEvent::Type::PLAYER_LEFT, peerId, 0, 0, it->name };
+    m_connectedPlayers.erase(it);
+    m_playersChanged = true;
+
+    if (m_isServer) {
+        if (m_demoWriter) m_demoWriter->AddEvent(left);
+        for (const PlayerInfo& other : m_connectedPlayers) QueueGameEvent(left, other.peerId);
+    }
+}
+
+CyborNetworkManager::PlayerInfo* CyborNetworkManager::FindPlayer(uint32_t peerId) {
+    for (PlayerInfo& player : m_connectedPlayers) {
+        if (player.peerId == peerId) return &player;
+    }
+    return nullptr;
+}
+
+void CyborNetworkManager::PublishPlayers() {
+    if (!m_playersChanged) return;
+    m_playersChanged = false;
+
+    // A copy only this list still holds has no readers left and can be overwritten;
+    // assigning into it reuses its capacity and strings
+    std::shared_ptr<std::vector<PlayerInfo>> copy;
+    for (const auto& candidate : m_playerCopies) {
+        if (candidate.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire); // Pairs with the last reader's release
+            copy = candidate;
+            break;
+        }
+    }
+    if (!copy) {
+        copy = std::make_shared<std::vector<PlayerInfo>>();
+        m_playerCopies.push_back(copy);
+    }
+
+    *copy = m_connectedPlayers;
+    std::atomic_store(&m_publishedPlayers, copy);
 }
 
 void CyborNetworkManager::Shutdown() {
     if (m_initialized) {
+        StopServer();
         Disconnect();
         m_initialized = false;
         std::cout << "Cybor Network Manager shut down" << std::endl;
     }
-} 
\ No newline at end of file
+}
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <glm/glm.hpp>
+#include <deque>
 #include <string>
 #include <vector>
 #include <memory>
-#include <thread>
-#include <mutex>
+#include "CyborUdpTransport.h"
+#include "CyborReliableChannel.h"
+#include "CyborNetworkStats.h"
+#include "CyborSnapshot.h"
+#include "CyborInterestManager.h"
+#include "CyborPriorityAccumulator.h"
+#include "CyborInterpolationBuffer.h"
+#include "CyborPacketCrypto.h"
+#include "../Game/CyborInputCommand.h"
+
+class CyborDemoWriter;
 
 /*
  * CyborNetworkManager - Advanced networking system
@@ -20,11 +31,39 @@ public:
     };
 
     struct PlayerInfo {
+        uint32_t peerId;
         std::string name;
         std::string ipAddress;
         int ping;
         int score;
         bool isCyborEnhanced;
+        glm::vec3 position;
+        glm::vec3 rotation;
+    };
+
+    using PlayerRoster = std::shared_ptr<const std::vector<PlayerInfo>>;
+
+    // Things every peer must hear about, delivered reliably and in order
+    struct GameEvent {
+        enum class Type : uint8_t {
+            PLAYER_JOINED, // subjectId: the player's peer id on the server, text: name
+            PLAYER_LEFT,   // subjectId, text as above
+            KILL,          // subjectId: victim, instigatorId: killer, value: weapon type
+            ROUND_END      // value: winning team
+        };
+
+        Type type;
+        uint32_t subjectId;
+        uint32_t instigatorId;
+        int32_t value;
+        std::string text;
+    };
+
+    // A connected player's shot, as the server received it
+    struct RemoteShot {
+        uint32_t peerId;
+        glm::vec3 direction;
+        float viewAge; // How far in the past the shooter saw the world, within the lag compensation window
     };
 
 public:
@@ -48,61 +87,272 @@ public:
     // Game state synchronization
     void SendPlayerUpdate(const glm::vec3& position, const glm::vec3& rotation);
     void SendWeaponFire(const glm::vec3& origin, const glm::vec3& direction);
+    // Reliable and ordered; sharing packets with the unreliable traffic, never stuck behind it
     void SendChatMessage(const std::string& message);
+    // The server sends to every client, a client to the server. Joins and leaves are sent by the server itself.
+    void SendGameEvent(const GameEvent& event);
+    bool PollGameEvent(GameEvent& outEvent);
+    // Server: shots from connected players, oldest first
+    bool PollRemoteShot(RemoteShot& outShot);
+
+    // Server: delta-compressed world state to every client, at the snapshot rate. Each client's
+    // snapshot fits one packet and its bandwidth limit; when the news doesn't, entities take turns
+    // by accumulated priority (near, in sight and changed first) and the rest repeat old state.
+    void SendWorldSnapshot(const std::vector<CyborSnapshotCodec::EntityState>& entities);
+    void SetSnapshotRate(int snapshotsPerSecond) { m_snapshotInterval = 1.0f / snapshotsPerSecond; }
+    // Snapshot bytes per second per client; 0 leaves only the packet size as a limit
+    void SetClientBandwidthLimit(int bytesPerSecond) { m_clientBandwidthLimit = bytesPerSecond; }
+    // Server under load: at level n, entities far from a client are refreshed only in every 2^n-th
+    // snapshot, and gain priority 2^n times more slowly when the client's bandwidth runs short
+    void SetSnapshotLevelOfDetail(int level) { m_snapshotDetailLevel = level; }
+    // Server: where a client sees the world from; snapshots only carry what is relevant there.
+    // Until the game sets this, the client's own player updates are used.
+    void SetClientViewer(uint32_t peerId, uint32_t entityId, const glm::vec3& eyePosition, uint8_t team);
+    // Server: broadcast relays (peers connecting with SetBroadcastRelay) get one stream of the whole
+    // world running this far behind the game, whatever number of spectators they feed. They are not
+    // players: they stay off the roster and get neither events, chat nor other messages.
+    void SetBroadcastDelay(float seconds) { m_broadcastDelay = seconds; }
+    // Server: relays see everything, so only hosts added here may connect as one, and only while
+    // the broadcast delay is above zero. Anyone else claiming to be a relay is disconnected.
+    void AllowBroadcastRelay(const std::string& address) { m_relayAddresses.push_back(address); }
+    int GetRelayCount() const;
+    // Client: connect as a broadcast relay rather than a player; set before connecting
+    void SetBroadcastRelay(bool relay) { m_isBroadcastRelay = relay; }
+    // Server: write every world snapshot and game event to a demo file until stopped
+    bool StartDemoRecording(const std::string& path);
+    void StopDemoRecording();
+    bool IsRecordingDemo() const { return m_demoWriter != nullptr; }
+    CyborInterestManager& GetInterestManager() { return m_interestManager; }
+    // Client prediction: commands go up every tick (with redundancy for loss),
+    // the server answers with the authoritative state after the last one it ran
+    void SendInputCommands(std::vector<CyborInputCommand>& commands);
+    bool PollAuthoritativeState(uint32_t& outLastProcessedSequence, CyborMoveState& outState);
+    // Server: commands received from a client, in order and without duplicates
+    std::vector<CyborInputCommand>& GetClientCommands(uint32_t peerId);
+    void SendPlayerState(uint32_t peerId, uint32_t lastProcessedSequence, const CyborMoveState& state);
+
+    // Client: most recent world state received from the server
+    bool GetLatestWorldState(std::vector<CyborSnapshotCodec::EntityState>& outStates, float& outServerTime) const;
+    // Client: remote entities for rendering, interpolated between snapshots at the current frame time
+    bool GetInterpolatedWorldState(std::vector<CyborSnapshotCodec::EntityState>& outStates) const;
+    CyborInterpolationBuffer& GetInterpolationBuffer() { return m_interpolationBuffer; }
 
     // Player management
-    std::vector<PlayerInfo> GetConnectedPlayers() const { return m_connectedPlayers; }
-    int GetPlayerCount() const { return m_connectedPlayers.size(); }
+    void SetPlayerName(const std::string& name) { m_localPlayerName = name; }
+    // Roster as of the last Update. Any thread may call this; it does not allocate, but the
+    // shared_ptr atomic load briefly takes a standard-library mutex, so it is not lock-free.
+    // The list stays valid and unchanged for as long as the caller holds it.
+    PlayerRoster GetConnectedPlayers() const;
+    int GetPlayerCount() const;
 
-    // Network statistics
-    int GetPing() const { return m_ping; }
-    float GetPacketLoss() const { return m_packetLoss; }
+    // Testing: put this endpoint behind an emulated link (both directions), set before starting
+    bool SetLinkEmulation(const CyborLinkEmulator::Settings& settings, uint64_t seed) {
+        return m_transport.SetLinkEmulation(settings, settings, seed);
+    }
+    const CyborUdpTransport& GetTransport() const { return m_transport; }
+
+    // Network statistics, measured per connection. A client's describe its link to the server;
+    // a server's ping and loss are averaged over its clients and its bandwidth is their total.
+    int GetPing() const { return m_ping; }               // Milliseconds
+    float GetPacketLoss() const { return m_packetLoss; } // Inbound, 0..1
+    float GetBandwidth() const { return m_bandwidth; }   // Bytes per second, both directions
+    // One connection (a client's is peer 0); false when the peer isn't connected. Doesn't allocate.
+    bool GetConnectionStats(uint32_t peerId, CyborNetworkStats::Summary& outStats) const;
 
     // Cybor networking enhancements
     void EnableCyborProtocol(bool enable) { m_cyborProtocolEnabled = enable; }
     void SetCyborEncryption(bool enable) { m_cyborEncryption = enable; }
+    // Shared 256-bit key as 64 hex digits; both ends need the same one before connecting
+    bool SetCyborKey(const std::string& hexKey);
     void BroadcastCyborSignal(const std::string& signal);
+    void BroadcastCyborSignal(const std::string& signal, const glm::vec3& origin);
 
 private:
+    // First payload byte of every message
+    enum class MessageType : uint8_t {
+        PLAYER_INFO,
+        PLAYER_UPDATE,
+        WEAPON_FIRE,
+        CHAT_MESSAGE,
+        CYBOR_SIGNAL,
+        WORLD_SNAPSHOT,
+        SNAPSHOT_ACK,
+        INPUT_COMMANDS,
+        PLAYER_STATE,
+        GAME_EVENT,
+        CHANNEL, // Reliability header; wraps every message except the handshake
+        SEALED   // Wraps any other message once the connection has keys
+    };
+
+    // Server-side state per peer, indexed by peer id
+    struct ClientConnection {
+        bool active;
+        CyborSnapshotHistory sentSnapshots;
+        uint16_t ackedSequence;
+        bool hasAck;
+        bool hasViewer;
+        uint32_t viewerEntityId;
+        glm::vec3 viewerPosition;
+        uint8_t viewerTeam;
+        std::vector<CyborInputCommand> commands;
+        uint32_t lastCommandSequence;
+        bool hasCommands;
+        CyborPriorityAccumulator priorities;
+        bool isRelay;
+    };
+
+    // One entity of the client snapshot being packed
+    struct PackedEntity {
+        const CyborSnapshotCodec::NetEntity* entity;
+        const CyborSnapshotCodec::NetEntity* baseline; // The client's acknowledged state, if any
+        int32_t candidate;                             // Priority candidate, or -1 when unchanged
+    };
+
+    // Packet protection per peer; the salts travel in PLAYER_INFO
+    struct PeerSecurity {
+        uint8_t localSalt[CyborPacketCrypto::SALT_SIZE];
+        CyborPacketCrypto crypto;
+        // With encryption on, the clear-text introduction waits here until a sealed
+        // packet from the peer opens, proving it holds the key
+        bool verified = false;
+        bool hasIntroduction = false;
+        std::string introducedName;
+        bool introducedCybor = false;
+        bool introducedRelay = false;
+    };
+
+    bool m_initialized;
     NetworkMode m_networkMode;
+    std::string m_localPlayerName;
+
+    // Socket, epoll loop and peer connections live on the transport's network thread
+    CyborUdpTransport m_transport;
 
     // Server state
     bool m_isServer;
     bool m_serverRunning;
     int m_serverPort;
     int m_maxPlayers;
-    std::thread m_serverThread;
 
     // Client state
     bool m_isClient;
     bool m_connected;
     std::string m_serverIP;
     int m_serverPort_client;
-    std::thread m_clientThread;
+
+    // Snapshots
+    CyborSnapshotCodec m_snapshotCodec;
+    CyborBitWriter m_writer;
+    std::vector<ClientConnection> m_clients;
+    CyborSnapshotCodec::Snapshot m_worldSnapshot;
+    CyborSnapshotHistory m_receivedSnapshots;
+    CyborSnapshotCodec::Snapshot m_clientSnapshot;
+    CyborInterpolationBuffer m_interpolationBuffer;
+    std::vector<CyborSnapshotCodec::EntityState> m_decodedStates;
+    uint16_t m_snapshotSequence;
+    float m_snapshotInterval;
+    float m_snapshotTimer;
+    int m_snapshotDetailLevel;
+    int m_clientBandwidthLimit;
+    std::vector<PackedEntity> m_packedEntities;
+    float m_networkTime; // Session clock: stamps snapshots on the server, times arrivals on the client
+
+    // Broadcast: world snapshots waiting out the delay before going to the relays, oldest first
+    std::deque<CyborSnapshotCodec::Snapshot> m_broadcastSnapshots;
+    std::vector<CyborSnapshotCodec::Snapshot> m_spareSnapshots; // Recycled, entity lists keep their capacity
+    float m_broadcastDelay;
+    std::vector<std::string> m_relayAddresses; // Hosts allowed to connect as relays
+    bool m_isBroadcastRelay;
+
+    // Demo recording, owns a background I/O thread while open
+    std::unique_ptr<CyborDemoWriter> m_demoWriter;
+
+    // Prediction
+    std::vector<CyborInputCommand> m_recentCommands;
+    bool m_hasAuthoritativeState;
+    uint32_t m_authoritativeSequence;
+    CyborMoveState m_authoritativeState;
+    std::vector<CyborInputCommand> m_noCommands;
+
+    // Relevancy
+    CyborInterestManager m_interestManager;
+    std::vector<CyborInterestManager::Viewer> m_viewers;
+    std::vector<uint32_t> m_viewerPeers;
+    std::vector<size_t> m_viewersInRange;
 
     // Network statistics
+    std::vector<CyborNetworkStats> m_connectionStats; // Indexed by peer id
     int m_ping;
     float m_packetLoss;
     float m_bandwidth;
+    float m_pingRefreshTimer;
 
-    // Connected players
+    // Connected players: edited on the game thread, then published as a copy that readers
+    // share. Copies are recycled once the last reader lets go (RCU-style).
     std::vector<PlayerInfo> m_connectedPlayers;
-    std::mutex m_playersMutex;
+    std::shared_ptr<std::vector<PlayerInfo>> m_publishedPlayers; // std::atomic_load/store only
+    std::vector<std::shared_ptr<std::vector<PlayerInfo>>> m_playerCopies;
+    bool m_playersChanged;
 
     // Cybor enhancements
     bool m_cyborProtocolEnabled;
     bool m_cyborEncryption;
-    std::string m_cyborKey;
+    bool m_hasCyborKey;
+    uint8_t m_cyborKey[CyborPacketCrypto::KEY_SIZE];
+    std::vector<PeerSecurity> m_peerSecurity; // Indexed by peer id
+
+    // Reliability
+    std::vector<CyborReliableChannel> m_channels; // Indexed by peer id
+    std::deque<GameEvent> m_gameEvents;
+    std::deque<RemoteShot> m_remoteShots;
+    bool m_hasServerInfo;     // Client: the server has answered our PLAYER_INFO
+    float m_playerInfoTimer;
+    double m_receiveTime;     // Arrival of the packet being handled, on the transport's clock
 
     // Private methods
-    void ServerThreadFunction();
-    void ClientThreadFunction();
     void ProcessIncomingPackets();
-    void SendPacket(const std::vector<uint8_t>& data, const std::string& destination = "");
-    void HandlePlayerConnect(const std::string& playerName, const std::string& ipAddress);
-    void HandlePlayerDisconnect(const std::string& ipAddress);
+    void ReceivePacket(uint32_t peerId, CyborPacketBuffer& packet, double time);
+    void HandleMessage(uint32_t peerId, const CyborPacketBuffer& data);
+    void HandleWorldSnapshot(uint32_t peerId, const CyborPacketBuffer& data);
+    void SendPacket(CyborPacketPtr packet, uint32_t peerId = CyborUdpTransport::INVALID_PEER);
+    // Bit-packed messages are written by m_writer directly into the packet's payload
+    CyborPacketPtr BeginBitMessage(MessageType type);
+    // Closes the message into the packet; false, with the message dropped, if it didn't fit
+    bool EndBitMessage(CyborPacketBuffer& packet);
+    void SendBitMessage(CyborPacketPtr packet, uint32_t peerId = CyborUdpTransport::INVALID_PEER);
+    // Bytes of messages, unreliable and reliable together, that fit in one packet after all the headers
+    size_t GetMessageBudget() const;
+    // Bytes one client's snapshot message may take
+    size_t GetSnapshotBudget() const;
+    // One client's snapshot of world, delta-encoded against what it acknowledged
+    void SendClientSnapshot(uint32_t peerId, const CyborSnapshotCodec::Snapshot& world, size_t budget,
+                            const std::vector<uint32_t>* relevant, const std::vector<uint32_t>* hidden);
+    // Queues this snapshot for the relays and sends them the one that has waited out the delay
+    void SendBroadcastSnapshot();
+    // Offers the client's changed entities to its accumulator; returns the bits spent whatever it selects
+    uint32_t GatherEntities(ClientConnection& client, const CyborSnapshotCodec::Snapshot& world,
+                            const std::vector<uint32_t>* relevant, const CyborSnapshotCodec::Snapshot* baseline);
+    // Their weights this snapshot, by distance, visibility and what changed
+    void WeighEntities(ClientConnection& client, const std::vector<uint32_t>* hidden);
+    // m_clientSnapshot from the accumulator's current selection
+    void PackClientSnapshot(const ClientConnection& client, const CyborSnapshotCodec::Snapshot& world);
+    // Reliable messages wait on the peer's channel for its next packet
+    void SendReliable(CyborPacketPtr packet, uint32_t peerId = CyborUdpTransport::INVALID_PEER);
+    void QueueReliable(uint32_t peerId, const CyborPacketBuffer& message);
+    void QueueGameEvent(const GameEvent& event, uint32_t peerId);
+    void FlushReliableChannels();
+    // Rolls the per-connection statistics and tunes each channel's resend delay to its round trip
+    void UpdateConnectionStats(float deltaTime);
+    void SendPlayerInfo(uint32_t peerId);
+    bool IsPeerConnected(uint32_t peerId) const;
+    void AdmitPeer(uint32_t peerId, const std::string& name, bool cyborEnhanced, bool relay);
+    void HandlePlayerConnect(uint32_t peerId, const std::string& playerName);
+    void HandlePlayerDisconnect(uint32_t peerId);
+    PlayerInfo* FindPlayer(uint32_t peerId);
+    void PublishPlayers();
 
-    // Cybor networking
-    std::vector<uint8_t> EncryptCyborPacket(const std::vector<uint8_t>& data);
-    std::vector<uint8_t> DecryptCyborPacket(const std::vector<uint8_t>& data);
+    // Cybor networking, in place on the pooled buffer
+    bool IsEncrypting() const { return m_cyborEncryption && m_hasCyborKey; }
+    bool EncryptCyborPacket(uint32_t peerId, CyborPacketBuffer& packet);
+    bool DecryptCyborPacket(uint32_t peerId, CyborPacketBuffer& packet);
 };
@@ -0,0 +1,223 @@
+#include "CyborNetworkStats.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+// RFC 6298 gains for the smoothed round trip and its deviation
+static const double RTT_GAIN = 1.0 / 8.0;
+static const double RTT_VARIANCE_GAIN = 1.0 / 4.0;
+// RFC 3550 gain for jitter
+static const double JITTER_GAIN = 1.0 / 16.0;
+// Weight of the newest interval in the bandwidth averages
+static const double BANDWIDTH_SMOOTHING = 0.5;
+
+CyborNetworkStats::CyborNetworkStats() {
+    Reset();
+}
+
+void CyborNetworkStats::Reset() {
+    m_summary = Summary{};
+
+    m_srtt = 0.0;
+    m_rttVariance = 0.0;
+    m_lastRttSample = 0.0;
+    m_hasTransit = false;
+    m_lastTransit = 0.0;
+
+    for (auto& packet : m_sentPackets) packet = SentPacket{ 0, false, false, 0.0 };
+    m_hasSent = false;
+    m_hasAck = false;
+    m_latestAck = 0;
+    m_nextToResolve = 0;
+    std::fill(std::begin(m_outcomeLost), std::end(m_outcomeLost), false);
+    m_outcomeHead = 0;
+    m_outcomeCount = 0;
+    m_outcomeLostCount = 0;
+
+    std::fill(std::begin(m_receivedBits), std::end(m_receivedBits), 0);
+    m_hasReceived = false;
+    m_newestReceived = 0;
+    m_receivedSpan = 0;
+    m_receivedCount = 0;
+
+    m_rateStart = 0.0;
+    m_sentBytes = 0;
+    m_receivedBytes = 0;
+    m_hasRate = false;
+}
+
+void CyborNetworkStats::OnPacketSent(uint16_t sequence, double time) {
+    if (!m_hasSent) {
+        m_nextToResolve = sequence;
+        m_hasSent = true;
+    }
+    m_sentPackets[sequence % LOSS_WINDOW] = SentPacket{ sequence, true, false, time };
+}
+
+void CyborNetworkStats::OnPacketReceived(uint16_t sequence, uint16_t ack, uint32_t ackBits, double time) {
+    RecordReceived(sequence);
+
+    AckPacket(ack, true, time);
+    for (int i = 0; i < ACK_BITS; i++) {
+        if (ackBits & (1u << i)) AckPacket(static_cast<uint16_t>(ack - 1 - i), false, time);
+    }
+    if (!m_hasAck || SequenceGreaterThan(ack, m_latestAck)) {
+        m_latestAck = ack;
+        m_hasAck = true;
+    }
+    ResolveSentPackets();
+    UpdateLoss();
+}
+
+void CyborNetworkStats::OnTimestamp(double senderTime, double arrivalTime) {
+    // The clocks differ by a constant, which drops out of the difference
+    const double transit = arrivalTime - senderTime;
+    if (m_hasTransit) {
+        const double difference = std::fabs(transit - m_lastTransit);
+        m_summary.jitter += static_cast<float>((difference - m_summary.jitter) * JITTER_GAIN);
+    }
+    m_lastTransit = transit;
+    m_hasTransit = true;
+}
+
+void CyborNetworkStats::Update(double time) {
+    if (!m_hasRate) {
+        m_rateStart = time;
+        m_sentBytes = 0;
+        m_receivedBytes = 0;
+        m_hasRate = true;
+        return;
+    }
+
+    const double elapsed = time - m_rateStart;
+    if (elapsed < BANDWIDTH_INTERVAL) return;
+
+    const double sendRate = m_sentBytes / elapsed;
+    const double receiveRate = m_receivedBytes / elapsed;
+    m_summary.sendBandwidth += static_cast<float>((sendRate - m_summary.sendBandwidth) * BANDWIDTH_SMOOTHING);
+    m_summary.receiveBandwidth += static_cast<float>((receiveRate - m_summary.receiveBandwidth) * BANDWIDTH_SMOOTHING);
+    m_rateStart = time;
+    m_sentBytes = 0;
+    m_receivedBytes = 0;
+}
+
+double CyborNetworkStats::GetRetransmitTimeout() const {
+    if (!m_summary.hasRtt) return INITIAL_RETRANSMIT_TIMEOUT;
+    return std::clamp(m_srtt + 4.0 * m_rttVariance, MIN_RETRANSMIT_TIMEOUT, MAX_RETRANSMIT_TIMEOUT);
+}
+
+void CyborNetworkStats::AckPacket(uint16_t sequence, bool direct, double time) {
+    SentPacket& packet = m_sentPackets[sequence % LOSS_WINDOW];
+    if (!packet.valid || packet.sequence != sequence || packet.acked) return;
+    packet.acked = true;
+
+    // Only the newest ack times a packet; one acked through the bit field may have sat
+    // at the peer for several of its packets
+    if (direct) AddRttSample(time - packet.time);
+}
+
+void CyborNetworkStats::AddRttSample(double rtt) {
+    if (!m_summary.hasRtt) {
+        m_srtt = rtt;
+        m_rttVariance = rtt / 2.0;
+        m_summary.hasRtt = true;
+    } else {
+        m_rttVariance += (std::fabs(m_srtt - rtt) - m_rttVariance) * RTT_VARIANCE_GAIN;
+        m_srtt += (rtt - m_srtt) * RTT_GAIN;
+
+        // Without timestamps from the peer, jitter is taken over round trips
+        if (!m_hasTransit) {
+            const double difference = std::fabs(rtt - m_lastRttSample);
+            m_summary.jitter += static_cast<float>((difference - m_summary.jitter) * JITTER_GAIN);
+        }
+    }
+    m_lastRttSample = rtt;
+    m_summary.rtt = static_cast<float>(m_srtt);
+    m_summary.rttVariance = static_cast<float>(m_rttVariance);
+}
+
+void CyborNetworkStats::ResolveSentPackets() {
+    if (!m_hasSent || !m_hasAck) return;
+
+    // Acks only ever cover the newest ack and the ACK_BITS before it; anything older is settled
+    const uint16_t settled = static_cast<uint16_t>(m_latestAck - ACK_BITS);
+    if (Distance(m_nextToResolve, settled) > LOSS_WINDOW && SequenceGreaterThan(settled, m_nextToResolve)) {
+        // Fell far behind, e.g. the peer stopped answering for a while; those slots are reused
+        m_nextToResolve = static_cast<uint16_t>(settled - LOSS_WINDOW);
+    }
+    for (; SequenceGreaterThan(settled, m_nextToResolve); m_nextToResolve++) {
+        SentPacket& packet = m_sentPackets[m_nextToResolve % LOSS_WINDOW];
+        if (!packet.valid || packet.sequence != m_nextToResolve) continue;
+        AddOutcome(!packet.acked);
+        packet.valid = false;
+    }
+}
+
+void CyborNetworkStats::AddOutcome(bool lost) {
+    if (m_outcomeCount == LOSS_WINDOW) {
+        if (m_outcomeLost[m_outcomeHead]) m_outcomeLostCount--;
+    } else {
+        m_outcomeCount++;
+    }
+    m_outcomeLost[m_outcomeHead] = lost;
+    if (lost) m_outcomeLostCount++;
+    m_outcomeHead = (m_outcomeHead + 1) % LOSS_WINDOW;
+}
+
+void CyborNetworkStats::RecordReceived(uint16_t sequence) {
+    if (!m_hasReceived) {
+        std::fill(std::begin(m_receivedBits), std::end(m_receivedBits), 0);
+        m_newestReceived = sequence;
+        m_receivedSpan = 1;
+        m_receivedCount = 1;
+        m_hasReceived = true;
+        SetReceived(sequence, true);
+        return;
+    }
+
+    if (SequenceGreaterThan(sequence, m_newestReceived)) {
+        // Sequences leaving the back of the window share a slot with the ones entering the front
+        const uint16_t advance = Distance(m_newestReceived, sequence);
+        if (advance >= LOSS_WINDOW) {
+            std::fill(std::begin(m_receivedBits), std::end(m_receivedBits), 0);
+            m_receivedCount = 0;
+        } else {
+            for (uint16_t i = 1; i <= advance; i++) {
+                const uint16_t entering = static_cast<uint16_t>(m_newestReceived + i);
+                if (TestReceived(entering)) m_receivedCount--;
+                SetReceived(entering, false);
+            }
+        }
+        m_receivedSpan = static_cast<uint16_t>(std::min<int>(LOSS_WINDOW, m_receivedSpan + advance));
+        m_newestReceived = sequence;
+        SetReceived(sequence, true);
+        m_receivedCount++;
+    } else {
+        // Late or duplicated; counts if it is still inside the window
+        const uint16_t behind = Distance(sequence, m_newestReceived);
+        if (behind < m_receivedSpan && !TestReceived(sequence)) {
+            SetReceived(sequence, true);
+            m_receivedCount++;
+        }
+    }
+}
+
+bool CyborNetworkStats::TestReceived(uint16_t sequence) const {
+    const uint16_t slot = sequence % LOSS_WINDOW;
+    return (m_receivedBits[slot / WORD_BITS] >> (slot % WORD_BITS)) & 1u;
+}
+
+void CyborNetworkStats::SetReceived(uint16_t sequence, bool received) {
+    const uint16_t slot = sequence % LOSS_WINDOW;
+    const uint64_t bit = uint64_t(1) << (slot % WORD_BITS);
+    if (received) {
+        m_receivedBits[slot / WORD_BITS] |= bit;
+    } else {
+        m_receivedBits[slot / WORD_BITS] &= ~bit;
+    }
+}
+
+void CyborNetworkStats::UpdateLoss() {
+    m_summary.packetLoss = m_receivedSpan > 0 ? 1.0f - static_cast<float>(m_receivedCount) / m_receivedSpan : 0.0f;
+    m_summary.outboundLoss = m_outcomeCount > 0 ? static_cast<float>(m_outcomeLostCount) / m_outcomeCount : 0.0f;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * CyborNetworkStats - Measured link quality of one connection
+ * Round-trip time comes from the reliable channel's acks, smoothed the way
+ * TCP does it (RFC 6298), which also gives a retransmission timeout. Jitter
+ * is the RFC 3550 estimator, over one-way transit when the peer timestamps
+ * its packets and over round trips otherwise. Loss is counted over a sliding
+ * window of sequence numbers in both directions, and bandwidth is averaged
+ * over short intervals. Everything is fixed-size; nothing allocates.
+ */
+class CyborNetworkStats {
+public:
+    static constexpr uint16_t LOSS_WINDOW = 256;      // Sequence numbers
+    static constexpr double BANDWIDTH_INTERVAL = 0.5; // Seconds per rate sample
+    static constexpr double INITIAL_RETRANSMIT_TIMEOUT = 0.1;
+    static constexpr double MIN_RETRANSMIT_TIMEOUT = 0.05;
+    static constexpr double MAX_RETRANSMIT_TIMEOUT = 1.0;
+
+    struct Summary {
+        float rtt;              // Smoothed round trip, seconds
+        float rttVariance;      // Mean deviation of the round trip, seconds
+        float jitter;           // Seconds
+        float packetLoss;       // Peer's packets that never arrived, 0..1
+        float outboundLoss;     // Our packets the peer never acked, 0..1
+        float sendBandwidth;    // Bytes per second
+        float receiveBandwidth; // Bytes per second
+        bool hasRtt;            // False until the first round trip is measured
+    };
+
+public:
+    CyborNetworkStats();
+
+    void Reset();
+
+    // Times are seconds on one steady clock
+    void OnPacketSent(uint16_t sequence, double time);
+    // Sequence and acks from the peer's packet header
+    void OnPacketReceived(uint16_t sequence, uint16_t ack, uint32_t ackBits, double time);
+    // Peer's send time (its own clock) of a packet arriving now; enables one-way jitter
+    void OnTimestamp(double senderTime, double arrivalTime);
+    void AddSentBytes(size_t bytes) { m_sentBytes += bytes; }
+    void AddReceivedBytes(size_t bytes) { m_receivedBytes += bytes; }
+    // Rolls the bandwidth averages; call once per tick
+    void Update(double time);
+
+    const Summary& GetSummary() const { return m_summary; }
+    // Smoothed RTT plus four deviations, clamped; INITIAL_RETRANSMIT_TIMEOUT until measured
+    double GetRetransmitTimeout() const;
+
+private:
+    static constexpr int ACK_BITS = 32;
+    static constexpr int WORD_BITS = 64;
+
+    struct SentPacket {
+        uint16_t sequence;
+        bool valid;
+        bool acked;
+        double time;
+    };
+
+    Summary m_summary;
+
+    // Round trip
+    double m_srtt;
+    double m_rttVariance;
+    double m_lastRttSample;
+
+    // One-way transit for RFC 3550 jitter
+    bool m_hasTransit;
+    double m_lastTransit;
+
+    // Sent packets by sequence % LOSS_WINDOW, and what became of them once out of ack range
+    SentPacket m_sentPackets[LOSS_WINDOW];
+    bool m_hasSent;
+    bool m_hasAck;
+    uint16_t m_latestAck;
+    uint16_t m_nextToResolve;
+    bool m_outcomeLost[LOSS_WINDOW];
+    uint16_t m_outcomeHead;
+    uint16_t m_outcomeCount;
+    uint16_t m_outcomeLostCount;
+
+    // Received sequence numbers, one bit each, trailing the newest
+    uint64_t m_receivedBits[LOSS_WINDOW / WORD_BITS];
+    bool m_hasReceived;
+    uint16_t m_newestReceived;
+    uint16_t m_receivedSpan;
+    uint16_t m_receivedCount;
+
+    // Bandwidth
+    double m_rateStart;
+    size_t m_sentBytes;
+    size_t m_receivedBytes;
+    bool m_hasRate;
+
+    void AckPacket(uint16_t sequence, bool direct, double time);
+    void AddRttSample(double rtt);
+    void ResolveSentPackets();
+    void AddOutcome(bool lost);
+    void RecordReceived(uint16_t sequence);
+    bool TestReceived(uint16_t sequence) const;
+    void SetReceived(uint16_t sequence, bool received);
+    void UpdateLoss();
+
+    // Wrap-around comparisons
+    static bool SequenceGreaterThan(uint16_t a, uint16_t b) { return static_cast<int16_t>(a - b) > 0; }
+    static uint16_t Distance(uint16_t from, uint16_t to) { return static_cast<uint16_t>(to - from); }
+};
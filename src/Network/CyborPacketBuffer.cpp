@@ -0,0 +1,121 @@
+#include "CyborPacketBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+uint8_t* CyborPacketBuffer::Prepend(size_t bytes) {
+    if (bytes > m_offset) return nullptr;
+    m_offset -= bytes;
+    m_size += bytes;
+    return Data();
+}
+
+uint8_t* CyborPacketBuffer::Append(size_t bytes) {
+    if (bytes > GetTailroom()) return nullptr;
+    uint8_t* tail = Tail();
+    m_size += bytes;
+    return tail;
+}
+
+bool CyborPacketBuffer::Append(const uint8_t* data, size_t bytes) {
+    uint8_t* destination = Append(bytes);
+    if (!destination) return false;
+    if (bytes > 0) std::memcpy(destination, data, bytes);
+    return true;
+}
+
+void CyborPacketBuffer::Consume(size_t bytes) {
+    if (bytes > m_size) bytes = m_size;
+    m_offset += bytes;
+    m_size -= bytes;
+}
+
+bool CyborPacketBuffer::Commit(size_t bytes) {
+    if (bytes > GetTailroom()) return false;
+    m_size += bytes;
+    return true;
+}
+
+CyborPacketPool::CyborPacketPool(size_t preallocate)
+    : m_chunkCount(0), m_freeHead(NO_BUFFER), m_freeCount(0) {
+    for (auto& chunk : m_chunks) chunk.store(nullptr, std::memory_order_relaxed);
+    Reserve(preallocate);
+}
+
+CyborPacketPool::~CyborPacketPool() {
+    const uint32_t chunks = std::min(m_chunkCount.load(), MAX_CHUNKS);
+    for (uint32_t i = 0; i < chunks; i++) delete m_chunks[i].load();
+}
+
+CyborPacketPool::Handle CyborPacketPool::Acquire(size_t headroom) {
+    CyborPacketBuffer* buffer = Pop();
+    while (!buffer) {
+        // Grow under load; the buffers stay with the pool from now on
+        if (!Grow()) {
+            buffer = new CyborPacketBuffer();
+            buffer->Reset(headroom);
+            return Handle(buffer, Releaser{ nullptr });
+        }
+        buffer = Pop();
+    }
+
+    buffer->Reset(headroom);
+    return Handle(buffer, Releaser{ this });
+}
+
+void CyborPacketPool::Reserve(size_t count) {
+    while (GetAllocatedCount() < count && Grow()) {}
+}
+
+size_t CyborPacketPool::GetAllocatedCount() const {
+    return static_cast<size_t>(std::min(m_chunkCount.load(std::memory_order_relaxed), MAX_CHUNKS)) * CHUNK_SIZE;
+}
+
+size_t CyborPacketPool::GetFreeCount() const {
+    return m_freeCount.load(std::memory_order_relaxed);
+}
+
+CyborPacketBuffer* CyborPacketPool::Pop() {
+    uint64_t head = m_freeHead.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t top = static_cast<uint32_t>(head);
+        if (top == NO_BUFFER) return nullptr;
+
+        const uint32_t index = top - 1;
+        Chunk* chunk = GetChunk(index);
+        const uint32_t next = chunk->next[index % CHUNK_SIZE].load(std::memory_order_relaxed);
+        const uint64_t changed = ((head >> 32) + 1) << 32;
+        if (m_freeHead.compare_exchange_weak(head, changed | next, std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+            m_freeCount.fetch_sub(1, std::memory_order_relaxed);
+            return &chunk->buffers[index % CHUNK_SIZE];
+        }
+    }
+}
+
+void CyborPacketPool::Release(CyborPacketBuffer* buffer) {
+    const uint32_t index = buffer->m_poolIndex;
+    std::atomic<uint32_t>& link = GetChunk(index)->next[index % CHUNK_SIZE];
+
+    uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+    uint64_t newHead;
+    do {
+        link.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        newHead = (((head >> 32) + 1) << 32) | (index + 1);
+    } while (!m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_release,
+                                               std::memory_order_relaxed));
+    m_freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool CyborPacketPool::Grow() {
+    // Each grower claims its own chunk slot, so two threads growing at once never wait on each other
+    uint32_t slot = m_chunkCount.load(std::memory_order_relaxed);
+    do {
+        if (slot >= MAX_CHUNKS) return false;
+    } while (!m_chunkCount.compare_exchange_weak(slot, slot + 1, std::memory_order_relaxed));
+
+    Chunk* chunk = new Chunk();
+    for (uint32_t i = 0; i < CHUNK_SIZE; i++) chunk->buffers[i].m_poolIndex = slot * CHUNK_SIZE + i;
+    m_chunks[slot].store(chunk, std::memory_order_release);
+    for (CyborPacketBuffer& buffer : chunk->buffers) Release(&buffer);
+    return true;
+}
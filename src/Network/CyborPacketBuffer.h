@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+ * CyborPacketBuffer - Fixed-size datagram buffer with headroom
+ * The payload sits in the middle of the storage so headers can be prepended
+ * and stripped, and payloads transformed, without moving any bytes
+ */
+class CyborPacketBuffer {
+public:
+    static constexpr size_t CAPACITY = 1600;
+    static constexpr size_t DEFAULT_HEADROOM = 64;
+
+public:
+    CyborPacketBuffer() : m_offset(DEFAULT_HEADROOM), m_size(0), m_poolIndex(0) {}
+
+    void Reset(size_t headroom = DEFAULT_HEADROOM) { m_offset = headroom; m_size = 0; }
+
+    uint8_t* Data() { return m_storage + m_offset; }
+    const uint8_t* Data() const { return m_storage + m_offset; }
+    size_t Size() const { return m_size; }
+    bool Empty() const { return m_size == 0; }
+    uint8_t operator[](size_t index) const { return m_storage[m_offset + index]; }
+
+    // Free space in front of and behind the payload
+    size_t GetHeadroom() const { return m_offset; }
+    size_t GetTailroom() const { return CAPACITY - m_offset - m_size; }
+    uint8_t* Tail() { return m_storage + m_offset + m_size; }
+
+    // Grow the payload at either end; nullptr when there is no room
+    uint8_t* Prepend(size_t bytes);
+    uint8_t* Append(size_t bytes);
+    bool Append(const uint8_t* data, size_t bytes);
+
+    // Shrink the payload at either end
+    void Consume(size_t bytes);
+    void Truncate(size_t size) { if (size < m_size) m_size = size; }
+
+    // Bytes written directly into Tail() become part of the payload
+    bool Commit(size_t bytes);
+
+private:
+    friend class CyborPacketPool;
+
+    alignas(16) uint8_t m_storage[CAPACITY];
+    size_t m_offset;
+    size_t m_size;
+    uint32_t m_poolIndex; // Where its pool keeps it
+};
+
+/*
+ * CyborPacketPool - Recycles packet buffers between the game and network threads
+ * Buffers come back to the free list when their handle goes out of scope, so
+ * steady-state traffic never touches the allocator. The free list is a
+ * lock-free stack of buffer indices; its head carries a count of changes,
+ * so a buffer taken and returned between another thread's read and swap
+ * cannot fool it. The pool grows a chunk of buffers at a time, without
+ * blocking the other thread, and must outlive every handle it gave out.
+ */
+class CyborPacketPool {
+public:
+    struct Releaser {
+        CyborPacketPool* pool; // Null for a buffer made past the pool's limit
+        void operator()(CyborPacketBuffer* buffer) const {
+            if (pool) pool->Release(buffer);
+            else delete buffer;
+        }
+    };
+    using Handle = std::unique_ptr<CyborPacketBuffer, Releaser>;
+
+public:
+    explicit CyborPacketPool(size_t preallocate = 256);
+    ~CyborPacketPool();
+
+    Handle Acquire(size_t headroom = CyborPacketBuffer::DEFAULT_HEADROOM);
+    // Grows the pool to at least this many buffers ahead of use
+    void Reserve(size_t count);
+
+    size_t GetAllocatedCount() const;
+    size_t GetFreeCount() const;
+
+private:
+    static constexpr uint32_t CHUNK_SIZE = 64;
+    static constexpr uint32_t MAX_CHUNKS = 1024;
+    static constexpr uint32_t NO_BUFFER = 0; // Links and the head hold index + 1
+
+    struct Chunk {
+        CyborPacketBuffer buffers[CHUNK_SIZE];
+        std::atomic<uint32_t> next[CHUNK_SIZE]; // Free-list links
+    };
+
+    std::atomic<Chunk*> m_chunks[MAX_CHUNKS];
+    std::atomic<uint32_t> m_chunkCount;
+    std::atomic<uint64_t> m_freeHead; // Change count in the high half, top of the stack in the low
+    std::atomic<size_t> m_freeCount;
+
+    CyborPacketBuffer* Pop();
+    void Release(CyborPacketBuffer* buffer);
+    bool Grow();
+    Chunk* GetChunk(uint32_t index) const { return m_chunks[index / CHUNK_SIZE].load(std::memory_order_acquire); }
+};
+
+using CyborPacketPtr = CyborPacketPool::Handle;
@@ -0,0 +1,408 @@
+#include "CyborPacketCrypto.h"
+#include <cstring>
+#include <random>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ChaCha20 works on little-endian words; these compile to plain loads on x86
+static inline uint32_t Load32(const uint8_t* bytes) {
+    return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+static inline uint64_t Load64(const uint8_t* bytes) {
+    return static_cast<uint64_t>(Load32(bytes)) | (static_cast<uint64_t>(Load32(bytes + 4)) << 32);
+}
+
+static inline void Store32(uint8_t* bytes, uint32_t value) {
+    bytes[0] = static_cast<uint8_t>(value);
+    bytes[1] = static_cast<uint8_t>(value >> 8);
+    bytes[2] = static_cast<uint8_t>(value >> 16);
+    bytes[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static inline void Store64(uint8_t* bytes, uint64_t value) {
+    Store32(bytes, static_cast<uint32_t>(value));
+    Store32(bytes + 4, static_cast<uint32_t>(value >> 32));
+}
+
+static inline uint32_t Rotate(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+#define CYBOR_QUARTER_ROUND(a, b, c, d) \
+    a += b; d = Rotate(d ^ a, 16);      \
+    c += d; b = Rotate(b ^ c, 12);      \
+    a += b; d = Rotate(d ^ a, 8);       \
+    c += d; b = Rotate(b ^ c, 7);
+
+static void ChaChaRounds(uint32_t x[16]) {
+    for (int i = 0; i < 10; i++) {
+        CYBOR_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        CYBOR_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        CYBOR_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        CYBOR_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        CYBOR_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        CYBOR_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        CYBOR_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        CYBOR_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+}
+
+static void ChaChaInit(uint32_t state[16], const uint32_t key[8], uint32_t counter, const uint8_t nonce[12]) {
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) state[4 + i] = key[i];
+    state[12] = counter;
+    state[13] = Load32(nonce);
+    state[14] = Load32(nonce + 4);
+    state[15] = Load32(nonce + 8);
+}
+
+static void ChaChaBlock(const uint32_t state[16], uint8_t out[64]) {
+    uint32_t x[16];
+    std::memcpy(x, state, sizeof(x));
+    ChaChaRounds(x);
+    for (int i = 0; i < 16; i++) Store32(out + i * 4, x[i] + state[i]);
+}
+
+#if defined(__SSE2__)
+
+static inline __m128i RotateLanes(__m128i value, int bits) {
+    return _mm_or_si128(_mm_slli_epi32(value, bits), _mm_srli_epi32(value, 32 - bits));
+}
+
+#define CYBOR_QUARTER_ROUND_X4(a, b, c, d)                                     \
+    a = _mm_add_epi32(a, b); d = RotateLanes(_mm_xor_si128(d, a), 16);         \
+    c = _mm_add_epi32(c, d); b = RotateLanes(_mm_xor_si128(b, c), 12);         \
+    a = _mm_add_epi32(a, b); d = RotateLanes(_mm_xor_si128(d, a), 8);          \
+    c = _mm_add_epi32(c, d); b = RotateLanes(_mm_xor_si128(b, c), 7);
+
+// Four consecutive blocks at once, one block per SIMD lane; XORs 256 bytes
+static void ChaChaXor4(const uint32_t state[16], uint8_t* data) {
+    __m128i x[16], initial[16];
+    for (int i = 0; i < 16; i++) initial[i] = _mm_set1_epi32(static_cast<int>(state[i]));
+    initial[12] = _mm_add_epi32(initial[12], _mm_set_epi32(3, 2, 1, 0));
+    for (int i = 0; i < 16; i++) x[i] = initial[i];
+
+    for (int i = 0; i < 10; i++) {
+        CYBOR_QUARTER_ROUND_X4(x[0], x[4], x[8], x[12]);
+        CYBOR_QUARTER_ROUND_X4(x[1], x[5], x[9], x[13]);
+        CYBOR_QUARTER_ROUND_X4(x[2], x[6], x[10], x[14]);
+        CYBOR_QUARTER_ROUND_X4(x[3], x[7], x[11], x[15]);
+        CYBOR_QUARTER_ROUND_X4(x[0], x[5], x[10], x[15]);
+        CYBOR_QUARTER_ROUND_X4(x[1], x[6], x[11], x[12]);
+        CYBOR_QUARTER_ROUND_X4(x[2], x[7], x[8], x[13]);
+        CYBOR_QUARTER_ROUND_X4(x[3], x[4], x[9], x[14]);
+    }
+
+    // Transpose word-major lanes back into four contiguous 64 byte blocks
+    for (int word = 0; word < 16; word += 4) {
+        const __m128i a = _mm_add_epi32(x[word], initial[word]);
+        const __m128i b = _mm_add_epi32(x[word + 1], initial[word + 1]);
+        const __m128i c = _mm_add_epi32(x[word + 2], initial[word + 2]);
+        const __m128i d = _mm_add_epi32(x[word + 3], initial[word + 3]);
+        const __m128i ab0 = _mm_unpacklo_epi32(a, b);
+        const __m128i cd0 = _mm_unpacklo_epi32(c, d);
+        const __m128i ab1 = _mm_unpackhi_epi32(a, b);
+        const __m128i cd1 = _mm_unpackhi_epi32(c, d);
+        const __m128i blocks[4] = {
+            _mm_unpacklo_epi64(ab0, cd0), _mm_unpackhi_epi64(ab0, cd0),
+            _mm_unpacklo_epi64(ab1, cd1), _mm_unpackhi_epi64(ab1, cd1)
+        };
+        for (int block = 0; block < 4; block++) {
+            __m128i* target = reinterpret_cast<__m128i*>(data + block * 64 + word * 4);
+            _mm_storeu_si128(target, _mm_xor_si128(_mm_loadu_si128(target), blocks[block]));
+        }
+    }
+}
+
+#endif
+
+// XORs the keystream starting at block 'counter' over data
+static void ChaChaXor(const uint32_t key[8], uint32_t counter, const uint8_t nonce[12], uint8_t* data, size_t size) {
+    uint32_t state[16];
+    ChaChaInit(state, key, counter, nonce);
+
+#if defined(__SSE2__)
+    while (size >= 256) {
+        ChaChaXor4(state, data);
+        state[12] += 4;
+        data += 256;
+        size -= 256;
+    }
+#endif
+
+    uint8_t block[64];
+    while (size > 0) {
+        ChaChaBlock(state, block);
+        state[12]++;
+        const size_t count = size < 64 ? size : 64;
+        for (size_t i = 0; i < count; i++) data[i] ^= block[i];
+        data += count;
+        size -= count;
+    }
+}
+
+// Poly1305 with 44/44/42 bit limbs
+class Poly1305 {
+public:
+    explicit Poly1305(const uint8_t key[32]) : m_h0(0), m_h1(0), m_h2(0) {
+        const uint64_t t0 = Load64(key);
+        const uint64_t t1 = Load64(key + 8);
+        m_r0 = t0 & 0xffc0fffffffULL;
+        m_r1 = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffffULL;
+        m_r2 = (t1 >> 24) & 0x00ffffffc0fULL;
+        m_pad0 = Load64(key + 16);
+        m_pad1 = Load64(key + 24);
+    }
+
+    // The AEAD zero-pads every segment, so only whole blocks are ever fed in
+    void UpdatePadded(const uint8_t* data, size_t size) {
+        const size_t whole = size & ~static_cast<size_t>(15);
+        Blocks(data, whole);
+        if (whole < size) {
+            uint8_t last[16] = {};
+            std::memcpy(last, data + whole, size - whole);
+            Blocks(last, 16);
+        }
+    }
+
+    void Finish(uint8_t outTag[16]) {
+        const uint64_t mask44 = 0xfffffffffffULL, mask42 = 0x3ffffffffffULL;
+        uint64_t h0 = m_h0, h1 = m_h1, h2 = m_h2, c;
+
+        c = h1 >> 44; h1 &= mask44;
+        h2 += c; c = h2 >> 42; h2 &= mask42;
+        h0 += c * 5; c = h0 >> 44; h0 &= mask44;
+        h1 += c; c = h1 >> 44; h1 &= mask44;
+        h2 += c; c = h2 >> 42; h2 &= mask42;
+        h0 += c * 5; c = h0 >> 44; h0 &= mask44;
+        h1 += c;
+
+        // h - p, kept only if it did not go negative
+        uint64_t g0 = h0 + 5; c = g0 >> 44; g0 &= mask44;
+        uint64_t g1 = h1 + c; c = g1 >> 44; g1 &= mask44;
+        uint64_t g2 = h2 + c - (1ULL << 42);
+        c = (g2 >> 63) - 1;
+        g0 &= c; g1 &= c; g2 &= c;
+        c = ~c;
+        h0 = (h0 & c) | g0;
+        h1 = (h1 & c) | g1;
+        h2 = (h2 & c) | g2;
+
+        h0 += m_pad0 & mask44; c = h0 >> 44; h0 &= mask44;
+        h1 += (((m_pad0 >> 44) | (m_pad1 << 20)) & mask44) + c; c = h1 >> 44; h1 &= mask44;
+        h2 += ((m_pad1 >> 24) & mask42) + c; h2 &= mask42;
+
+        Store64(outTag, h0 | (h1 << 44));
+        Store64(outTag + 8, (h1 >> 20) | (h2 << 24));
+    }
+
+private:
+    uint64_t m_r0, m_r1, m_r2;
+    uint64_t m_h0, m_h1, m_h2;
+    uint64_t m_pad0, m_pad1;
+
+    void Blocks(const uint8_t* data, size_t size) {
+        typedef unsigned __int128 uint128;
+        const uint64_t mask44 = 0xfffffffffffULL, mask42 = 0x3ffffffffffULL;
+        const uint64_t s1 = m_r1 * (5 << 2);
+        const uint64_t s2 = m_r2 * (5 << 2);
+        uint64_t h0 = m_h0, h1 = m_h1, h2 = m_h2;
+
+        for (; size >= 16; data += 16, size -= 16) {
+            const uint64_t t0 = Load64(data);
+            const uint64_t t1 = Load64(data + 8);
+            h0 += t0 & mask44;
+            h1 += ((t0 >> 44) | (t1 << 20)) & mask44;
+            h2 += ((t1 >> 24) & mask42) | (1ULL << 40);
+
+            uint128 d0 = static_cast<uint128>(h0) * m_r0 + static_cast<uint128>(h1) * s2 + static_cast<uint128>(h2) * s1;
+            uint128 d1 = static_cast<uint128>(h0) * m_r1 + static_cast<uint128>(h1) * m_r0 + static_cast<uint128>(h2) * s2;
+            uint128 d2 = static_cast<uint128>(h0) * m_r2 + static_cast<uint128>(h1) * m_r1 + static_cast<uint128>(h2) * m_r0;
+
+            uint64_t c = static_cast<uint64_t>(d0 >> 44); h0 = static_cast<uint64_t>(d0) & mask44;
+            d1 += c; c = static_cast<uint64_t>(d1 >> 44); h1 = static_cast<uint64_t>(d1) & mask44;
+            d2 += c; c = static_cast<uint64_t>(d2 >> 42); h2 = static_cast<uint64_t>(d2) & mask42;
+            h0 += c * 5; c = h0 >> 44; h0 &= mask44;
+            h1 += c;
+        }
+
+        m_h0 = h0;
+        m_h1 = h1;
+        m_h2 = h2;
+    }
+};
+
+static void ComputeTag(const uint32_t key[8], const uint8_t nonce[12], const uint8_t* aad, size_t aadSize,
+                       const uint8_t* ciphertext, size_t size, uint8_t outTag[16]) {
+    // One-time Poly1305 key is block 0 of the keystream; the payload starts at block 1
+    uint32_t state[16];
+    uint8_t block[64];
+    ChaChaInit(state, key, 0, nonce);
+    ChaChaBlock(state, block);
+
+    Poly1305 mac(block);
+    mac.UpdatePadded(aad, aadSize);
+    mac.UpdatePadded(ciphertext, size);
+    uint8_t lengths[16];
+    Store64(lengths, aadSize);
+    Store64(lengths + 8, size);
+    mac.UpdatePadded(lengths, sizeof(lengths));
+    mac.Finish(outTag);
+}
+
+CyborPacketCrypto::CyborPacketCrypto() {
+    Clear();
+}
+
+void CyborPacketCrypto::Clear() {
+    std::memset(m_sendKey, 0, sizeof(m_sendKey));
+    std::memset(m_receiveKey, 0, sizeof(m_receiveKey));
+    m_sendSequence = 0;
+    m_highestReceived = 0;
+    m_receivedMask = 0;
+    m_hasReceived = false;
+    m_ready = false;
+}
+
+void CyborPacketCrypto::DeriveKeys(const uint8_t sharedKey[KEY_SIZE], const uint8_t clientSalt[SALT_SIZE],
+                                   const uint8_t serverSalt[SALT_SIZE], bool isServer) {
+    Clear();
+
+    // HChaCha20 over both salts gives a connection key, whose first block holds both directions' keys
+    uint32_t state[16];
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) state[4 + i] = Load32(sharedKey + i * 4);
+    state[12] = Load32(clientSalt);
+    state[13] = Load32(clientSalt + 4);
+    state[14] = Load32(serverSalt);
+    state[15] = Load32(serverSalt + 4);
+    ChaChaRounds(state);
+
+    uint32_t connectionKey[8];
+    for (int i = 0; i < 4; i++) {
+        connectionKey[i] = state[i];
+        connectionKey[4 + i] = state[12 + i];
+    }
+
+    const uint8_t zeroNonce[NONCE_SIZE] = {};
+    uint8_t keys[64];
+    ChaChaInit(state, connectionKey, 0, zeroNonce);
+    ChaChaBlock(state, keys);
+
+    const uint8_t* clientToServer = keys;
+    const uint8_t* serverToClient = keys + KEY_SIZE;
+    for (int i = 0; i < 8; i++) {
+        m_sendKey[i] = Load32((isServer ? serverToClient : clientToServer) + i * 4);
+        m_receiveKey[i] = Load32((isServer ? clientToServer : serverToClient) + i * 4);
+    }
+    m_ready = true;
+}
+
+bool CyborPacketCrypto::Seal(CyborPacketBuffer& packet) {
+    if (!m_ready || packet.GetHeadroom() < SEQUENCE_SIZE || packet.GetTailroom() < TAG_SIZE) return false;
+
+    const uint64_t sequence = m_sendSequence++;
+    uint8_t nonce[NONCE_SIZE];
+    MakeNonce(sequence, nonce);
+
+    const size_t size = packet.Size();
+    uint8_t* tag = packet.Append(TAG_SIZE);
+    uint8_t* header = packet.Prepend(SEQUENCE_SIZE);
+    Store64(header, sequence);
+    Encrypt(m_sendKey, nonce, header, SEQUENCE_SIZE, header + SEQUENCE_SIZE, size, tag);
+    return true;
+}
+
+bool CyborPacketCrypto::Open(CyborPacketBuffer& packet) {
+    if (!m_ready || packet.Size() < OVERHEAD) return false;
+
+    uint8_t* header = packet.Data();
+    const uint64_t sequence = Load64(header);
+
+    // Cheap replay check first, the window only moves once the tag verifies
+    if (m_hasReceived && sequence <= m_highestReceived) {
+        const uint64_t age = m_highestReceived - sequence;
+        if (age >= REPLAY_WINDOW || (m_receivedMask & (1ULL << age))) return false;
+    }
+
+    uint8_t nonce[NONCE_SIZE];
+    MakeNonce(sequence, nonce);
+    const size_t size = packet.Size() - OVERHEAD;
+    uint8_t* data = header + SEQUENCE_SIZE;
+    if (!Decrypt(m_receiveKey, nonce, header, SEQUENCE_SIZE, data, size, data + size)) return false;
+
+    if (!m_hasReceived || sequence > m_highestReceived) {
+        const uint64_t shift = m_hasReceived ? sequence - m_highestReceived : REPLAY_WINDOW;
+        m_receivedMask = shift >= REPLAY_WINDOW ? 0 : m_receivedMask << shift;
+        m_receivedMask |= 1;
+        m_highestReceived = sequence;
+        m_hasReceived = true;
+    } else {
+        m_receivedMask |= 1ULL << (m_highestReceived - sequence);
+    }
+
+    packet.Consume(SEQUENCE_SIZE);
+    packet.Truncate(size);
+    return true;
+}
+
+void CyborPacketCrypto::Encrypt(const uint32_t key[8], const uint8_t nonce[NONCE_SIZE], const uint8_t* aad, size_t aadSize,
+                                uint8_t* data, size_t size, uint8_t outTag[TAG_SIZE]) {
+    ChaChaXor(key, 1, nonce, data, size);
+    ComputeTag(key, nonce, aad, aadSize, data, size, outTag);
+}
+
+bool CyborPacketCrypto::Decrypt(const uint32_t key[8], const uint8_t nonce[NONCE_SIZE], const uint8_t* aad, size_t aadSize,
+                                uint8_t* data, size_t size, const uint8_t tag[TAG_SIZE]) {
+    uint8_t expected[TAG_SIZE];
+    ComputeTag(key, nonce, aad, aadSize, data, size, expected);
+
+    // Constant time, so a forger learns nothing from the timing
+    uint8_t difference = 0;
+    for (size_t i = 0; i < TAG_SIZE; i++) difference |= expected[i] ^ tag[i];
+    if (difference != 0) return false;
+
+    ChaChaXor(key, 1, nonce, data, size);
+    return true;
+}
+
+bool CyborPacketCrypto::ParseKey(const std::string& hex, uint8_t outKey[KEY_SIZE]) {
+    if (hex.size() != KEY_SIZE * 2) return false;
+
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    for (size_t i = 0; i < KEY_SIZE; i++) {
+        const int high = nibble(hex[i * 2]);
+        const int low = nibble(hex[i * 2 + 1]);
+        if (high < 0 || low < 0) return false;
+        outKey[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+void CyborPacketCrypto::GenerateSalt(uint8_t outSalt[SALT_SIZE]) {
+    std::random_device rd;
+    for (size_t i = 0; i < SALT_SIZE; i += 4) {
+        Store32(outSalt + i, rd());
+    }
+}
+
+void CyborPacketCrypto::MakeNonce(uint64_t sequence, uint8_t outNonce[NONCE_SIZE]) {
+    // Directional keys never share a nonce space, so the prefix can stay zero
+    Store32(outNonce, 0);
+    Store64(outNonce + 4, sequence);
+}
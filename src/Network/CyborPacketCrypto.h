@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "CyborPacketBuffer.h"
+
+/*
+ * CyborPacketCrypto - ChaCha20-Poly1305 protection for one connection
+ * Each direction has its own key derived from the shared Cybor key and both
+ * peers' connection salts. The nonce is the packet's 64-bit sequence number,
+ * sent in the clear and authenticated; a sliding window rejects replays.
+ * Everything happens in place on the pooled buffer.
+ */
+class CyborPacketCrypto {
+public:
+    static constexpr size_t KEY_SIZE = 32;
+    static constexpr size_t SALT_SIZE = 8;
+    static constexpr size_t NONCE_SIZE = 12;
+    static constexpr size_t SEQUENCE_SIZE = 8;
+    static constexpr size_t TAG_SIZE = 16;
+    static constexpr size_t OVERHEAD = SEQUENCE_SIZE + TAG_SIZE;
+
+public:
+    CyborPacketCrypto();
+
+    // Session keys for this connection; both ends pass the same salts
+    void DeriveKeys(const uint8_t sharedKey[KEY_SIZE], const uint8_t clientSalt[SALT_SIZE],
+                    const uint8_t serverSalt[SALT_SIZE], bool isServer);
+    void Clear();
+    bool IsReady() const { return m_ready; }
+
+    // Encrypts the payload, prepends the sequence and appends the tag.
+    // Needs OVERHEAD bytes of head- and tailroom between them.
+    bool Seal(CyborPacketBuffer& packet);
+    // Verifies, decrypts and strips sequence and tag; false on forgery or replay
+    bool Open(CyborPacketBuffer& packet);
+
+    // 64 hex digits
+    static bool ParseKey(const std::string& hex, uint8_t outKey[KEY_SIZE]);
+    static void GenerateSalt(uint8_t outSalt[SALT_SIZE]);
+
+    // RFC 8439 AEAD
+    static void Encrypt(const uint32_t key[8], const uint8_t nonce[NONCE_SIZE], const uint8_t* aad, size_t aadSize,
+                        uint8_t* data, size_t size, uint8_t outTag[TAG_SIZE]);
+    static bool Decrypt(const uint32_t key[8], const uint8_t nonce[NONCE_SIZE], const uint8_t* aad, size_t aadSize,
+                        uint8_t* data, size_t size, const uint8_t tag[TAG_SIZE]);
+
+private:
+    static constexpr uint64_t REPLAY_WINDOW = 64;
+
+    uint32_t m_sendKey[8];
+    uint32_t m_receiveKey[8];
+    uint64_t m_sendSequence;
+    uint64_t m_highestReceived;
+    uint64_t m_receivedMask; // Bit n: highest - n was accepted
+    bool m_hasReceived;
+    bool m_ready;
+
+    static void MakeNonce(uint64_t sequence, uint8_t outNonce[NONCE_SIZE]);
+};
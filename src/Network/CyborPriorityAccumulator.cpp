@@ -0,0 +1,81 @@
+#include "CyborPriorityAccumulator.h"
+#include <algorithm>
+
+CyborPriorityAccumulator::CyborPriorityAccumulator()
+    : m_cursor(0), m_totalBits(0), m_selectedCount(0) {
+}
+
+void CyborPriorityAccumulator::Clear() {
+    m_entries.clear();
+    m_nextEntries.clear();
+    m_candidates.clear();
+    m_cursor = 0;
+    m_totalBits = 0;
+    m_selectedCount = 0;
+}
+
+void CyborPriorityAccumulator::Begin() {
+    m_nextEntries.clear();
+    m_candidates.clear();
+    m_cursor = 0;
+    m_totalBits = 0;
+    m_selectedCount = 0;
+}
+
+size_t CyborPriorityAccumulator::Add(uint32_t entityId, uint32_t bits, bool required) {
+    // Both lists are sorted by id, so the previous priority is found walking forward
+    while (m_cursor < m_entries.size() && m_entries[m_cursor].entityId < entityId) m_cursor++;
+    float priority = 0.0f;
+    if (m_cursor < m_entries.size() && m_entries[m_cursor].entityId == entityId) {
+        priority += m_entries[m_cursor].priority;
+    }
+
+    m_nextEntries.push_back({ entityId, priority });
+    m_candidates.push_back({ priority, bits, required, false });
+    m_totalBits += bits;
+    return m_candidates.size() - 1;
+}
+
+void CyborPriorityAccumulator::AddWeight(size_t index, float weight) {
+    m_candidates[index].priority += weight;
+    m_nextEntries[index].priority += weight;
+}
+
+uint32_t CyborPriorityAccumulator::Select(uint32_t budgetBits) {
+    // Usually everything fits and there is nothing to rank
+    if (m_totalBits <= budgetBits) {
+        for (auto& candidate : m_candidates) candidate.selected = true;
+        m_selectedCount = m_candidates.size();
+        return m_totalBits;
+    }
+
+    m_order.resize(m_candidates.size());
+    for (uint32_t i = 0; i < m_order.size(); i++) m_order[i] = i;
+    std::sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) {
+        const Candidate& first = m_candidates[a];
+        const Candidate& second = m_candidates[b];
+        if (first.required != second.required) return first.required;
+        return first.priority > second.priority;
+    });
+
+    // Greedy: a candidate too big for what is left doesn't stop smaller ones behind it
+    uint32_t used = 0;
+    m_selectedCount = 0;
+    for (uint32_t index : m_order) {
+        Candidate& candidate = m_candidates[index];
+        candidate.selected = candidate.required || used + candidate.bits <= budgetBits;
+        if (!candidate.selected) continue;
+        used += candidate.bits;
+        m_selectedCount++;
+    }
+    return used;
+}
+
+void CyborPriorityAccumulator::Commit() {
+    for (size_t i = 0; i < m_candidates.size(); i++) {
+        if (m_candidates[i].selected) m_nextEntries[i].priority = 0.0f;
+    }
+    m_entries.swap(m_nextEntries);
+    m_nextEntries.clear();
+    m_candidates.clear();
+}
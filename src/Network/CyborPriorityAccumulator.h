@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * CyborPriorityAccumulator - Decides which entities one client's snapshot carries
+ * Every snapshot each entity with news for the client adds its weight to a
+ * running priority (when everything fits there is no need to weigh them).
+ * The packet is then filled greedily, highest priority first, up to the
+ * client's bit budget; whatever goes out starts over from zero and the rest
+ * keep climbing, so nothing waits forever however small its weight.
+ * Entities are added in ascending id order, the order snapshots keep them
+ * in, which lets priorities carry over without a lookup table.
+ */
+class CyborPriorityAccumulator {
+public:
+    CyborPriorityAccumulator();
+
+    void Clear();
+
+    // One snapshot: Begin, Add every candidate in ascending id order, AddWeight to each when
+    // they won't all fit, Select (again with a smaller budget if need be), then Commit the last
+    // selection. Entities not added since the last Commit lose their priority.
+    void Begin();
+    // Returns the candidate's index; required ones are always selected
+    size_t Add(uint32_t entityId, uint32_t bits, bool required);
+    void AddWeight(size_t index, float weight);
+    uint32_t GetTotalBits() const { return m_totalBits; }
+    // Bits the selection uses
+    uint32_t Select(uint32_t budgetBits);
+    bool IsSelected(size_t index) const { return m_candidates[index].selected; }
+    void Commit();
+
+    size_t GetCandidateCount() const { return m_candidates.size(); }
+    size_t GetSelectedCount() const { return m_selectedCount; }
+
+private:
+    struct Entry {
+        uint32_t entityId;
+        float priority;
+    };
+
+    struct Candidate {
+        float priority;
+        uint32_t bits;
+        bool required;
+        bool selected;
+    };
+
+    std::vector<Entry> m_entries;     // Carried between snapshots, sorted by id
+    std::vector<Entry> m_nextEntries; // This snapshot's, parallel to m_candidates
+    std::vector<Candidate> m_candidates;
+    std::vector<uint32_t> m_order;    // Scratch: candidates by descending priority
+    size_t m_cursor;
+    uint32_t m_totalBits;
+    size_t m_selectedCount;
+};
@@ -0,0 +1,214 @@
+#include "CyborReliableChannel.h"
+
+static void WriteUint16(uint8_t* destination, uint16_t value) {
+    destination[0] = static_cast<uint8_t>(value);
+    destination[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static uint16_t ReadUint16(const uint8_t* source) {
+    return static_cast<uint16_t>(source[0] | (source[1] << 8));
+}
+
+CyborReliableChannel::CyborReliableChannel()
+    : m_outgoing(WINDOW), m_sentPackets(SENT_PACKETS), m_incoming(WINDOW) {
+    Reset();
+}
+
+void CyborReliableChannel::Reset() {
+    for (auto& message : m_outgoing) {
+        message.pending = false;
+        message.sent = false;
+    }
+    for (auto& packet : m_sentPackets) packet.valid = false;
+    for (auto& message : m_incoming) message.valid = false;
+
+    m_nextMessageId = 0;
+    m_oldestUnacked = 0;
+    m_nextSequence = 0;
+    m_backlog.clear();
+    m_resendDelay = RESEND_DELAY;
+    m_nextDeliverId = 0;
+    m_receivedSequence = 0xFFFF; // Acked until something arrives; no packet carries it for a long while
+    m_receivedBits = 0;
+    m_hasReceived = false;
+    m_ackPending = false;
+    m_lastReadHeader = PacketHeader{ 0, 0, 0 };
+    m_messagesResent = 0;
+}
+
+bool CyborReliableChannel::Queue(const uint8_t* data, size_t size) {
+    if (size > MAX_MESSAGE_SIZE) return false;
+
+    // Ids are only handed out inside the window; the rest wait their turn, in order
+    if (m_backlog.empty() && Distance(m_oldestUnacked, m_nextMessageId) < WINDOW) {
+        AddToWindow(data, size);
+    } else if (m_backlog.size() < MAX_BACKLOG) {
+        m_backlog.emplace_back(data, data + size);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void CyborReliableChannel::AddToWindow(const uint8_t* data, size_t size) {
+    OutgoingMessage& message = m_outgoing[m_nextMessageId % WINDOW];
+    message.data.assign(data, data + size);
+    message.lastSendTime = 0.0;
+    message.pending = true;
+    message.sent = false;
+    m_nextMessageId++;
+}
+
+bool CyborReliableChannel::WritePacket(CyborPacketBuffer& packet, size_t maxSize, double now) {
+    const uint16_t sequence = m_nextSequence++;
+    SentPacket& record = m_sentPackets[sequence % SENT_PACKETS];
+    record.sequence = sequence;
+    record.messageCount = 0;
+
+    // Oldest first: new messages, and old ones nobody has acked in time
+    const size_t payloadSize = packet.Size();
+    for (uint16_t id = m_oldestUnacked; id != m_nextMessageId && record.messageCount < MAX_MESSAGES_PER_PACKET; id++) {
+        OutgoingMessage& message = m_outgoing[id % WINDOW];
+        if (!message.pending || (message.sent && now - message.lastSendTime < m_resendDelay)) continue;
+        if (packet.Size() + MESSAGE_HEADER_SIZE + message.data.size() > maxSize) continue;
+
+        uint8_t* header = packet.Append(MESSAGE_HEADER_SIZE);
+        if (!header) break;
+        WriteUint16(header, id);
+        WriteUint16(header + 2, static_cast<uint16_t>(message.data.size()));
+        packet.Append(message.data.data(), message.data.size());
+
+        if (message.sent) m_messagesResent++;
+        message.sent = true;
+        message.lastSendTime = now;
+        record.messageIds[record.messageCount++] = id;
+    }
+    record.valid = record.messageCount > 0; // Only packets carrying messages need their ack noticed
+
+    uint8_t* header = packet.Prepend(HEADER_SIZE);
+    if (!header) return false;
+    WriteUint16(header, sequence);
+    WriteUint16(header + 2, m_receivedSequence);
+    for (int i = 0; i < 4; i++) header[4 + i] = static_cast<uint8_t>(m_receivedBits >> (8 * i));
+    WriteUint16(header + 8, static_cast<uint16_t>(packet.Size() - HEADER_SIZE - payloadSize));
+
+    m_ackPending = false;
+    return true;
+}
+
+bool CyborReliableChannel::ReadPacket(CyborPacketBuffer& packet) {
+    if (packet.Size() < HEADER_SIZE) return false;
+
+    const uint8_t* header = packet.Data();
+    const uint16_t sequence = ReadUint16(header);
+    const uint16_t ack = ReadUint16(header + 2);
+    uint32_t ackBits = 0;
+    for (int i = 0; i < 4; i++) ackBits |= static_cast<uint32_t>(header[4 + i]) << (8 * i);
+    const size_t reliableSize = ReadUint16(header + 8);
+    if (HEADER_SIZE + reliableSize > packet.Size()) return false;
+
+    // Validate the whole block before taking anything from it
+    const size_t reliableStart = packet.Size() - reliableSize;
+    size_t offset = reliableStart;
+    while (offset < packet.Size()) {
+        if (offset + MESSAGE_HEADER_SIZE > packet.Size()) return false;
+        const size_t size = ReadUint16(packet.Data() + offset + 2);
+        offset += MESSAGE_HEADER_SIZE + size;
+        if (offset > packet.Size()) return false;
+    }
+
+    RecordReceived(sequence);
+    ProcessAck(ack, ackBits);
+    m_lastReadHeader = PacketHeader{ sequence, ack, ackBits };
+
+    for (offset = reliableStart; offset < packet.Size();) {
+        const uint16_t id = ReadUint16(packet.Data() + offset);
+        const size_t size = ReadUint16(packet.Data() + offset + 2);
+        const uint8_t* data = packet.Data() + offset + MESSAGE_HEADER_SIZE;
+        offset += MESSAGE_HEADER_SIZE + size;
+        m_ackPending = true;
+
+        // Already delivered, or too far ahead to buffer; the sender tries again either way
+        if (Distance(m_nextDeliverId, id) >= WINDOW) continue;
+        IncomingMessage& message = m_incoming[id % WINDOW];
+        if (message.valid) continue;
+        message.data.assign(data, data + size);
+        message.valid = true;
+    }
+
+    packet.Truncate(reliableStart);
+    packet.Consume(HEADER_SIZE);
+    return true;
+}
+
+bool CyborReliableChannel::PopMessage(CyborPacketBuffer& out) {
+    IncomingMessage& message = m_incoming[m_nextDeliverId % WINDOW];
+    if (!message.valid) return false;
+
+    out.Reset();
+    if (!out.Append(message.data.data(), message.data.size())) return false;
+    message.valid = false;
+    m_nextDeliverId++;
+    return true;
+}
+
+bool CyborReliableChannel::WantsToSend(double now) const {
+    if (m_ackPending) return true;
+    for (uint16_t id = m_oldestUnacked; id != m_nextMessageId; id++) {
+        const OutgoingMessage& message = m_outgoing[id % WINDOW];
+        if (message.pending && (!message.sent || now - message.lastSendTime >= m_resendDelay)) return true;
+    }
+    return false;
+}
+
+void CyborReliableChannel::ProcessAck(uint16_t ack, uint32_t ackBits) {
+    AckPacket(ack);
+    for (int i = 0; i < 32; i++) {
+        if (ackBits & (1u << i)) AckPacket(static_cast<uint16_t>(ack - 1 - i));
+    }
+
+    while (m_oldestUnacked != m_nextMessageId && !m_outgoing[m_oldestUnacked % WINDOW].pending) {
+        m_oldestUnacked++;
+    }
+    while (!m_backlog.empty() && Distance(m_oldestUnacked, m_nextMessageId) < WINDOW) {
+        AddToWindow(m_backlog.front().data(), m_backlog.front().size());
+        m_backlog.pop_front();
+    }
+}
+
+void CyborReliableChannel::AckPacket(uint16_t sequence) {
+    SentPacket& record = m_sentPackets[sequence % SENT_PACKETS];
+    if (!record.valid || record.sequence != sequence) return;
+    record.valid = false;
+
+    for (uint8_t i = 0; i < record.messageCount; i++) {
+        const uint16_t id = record.messageIds[i];
+        // Ids outside the window were acked long ago and their slot may hold a newer message
+        if (Distance(m_oldestUnacked, id) < Distance(m_oldestUnacked, m_nextMessageId)) {
+            m_outgoing[id % WINDOW].pending = false;
+        }
+    }
+}
+
+void CyborReliableChannel::RecordReceived(uint16_t sequence) {
+    if (!m_hasReceived) {
+        m_receivedSequence = sequence;
+        m_receivedBits = 0;
+        m_hasReceived = true;
+        return;
+    }
+
+    if (SequenceGreaterThan(sequence, m_receivedSequence)) {
+        // The previous latest moves into the field along with everything before it
+        const uint16_t shift = Distance(m_receivedSequence, sequence);
+        if (shift < 32) {
+            m_receivedBits = (m_receivedBits << shift) | (1u << (shift - 1));
+        } else {
+            m_receivedBits = shift == 32 ? 1u << 31 : 0;
+        }
+        m_receivedSequence = sequence;
+    } else {
+        const uint16_t behind = Distance(sequence, m_receivedSequence);
+        if (behind >= 1 && behind <= 32) m_receivedBits |= 1u << (behind - 1);
+    }
+}
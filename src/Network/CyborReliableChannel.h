@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "CyborPacketBuffer.h"
+
+/*
+ * CyborReliableChannel - Reliable, ordered messages riding on unreliable packets
+ * Every packet to the peer carries its own sequence number, the latest sequence
+ * received from the peer and a 32-bit field acking the 32 before it. Reliable
+ * messages are coalesced into whatever packet goes out next and resent only
+ * while no packet carrying them has been acked, so one loss never holds up
+ * the state updates they travel with. The receiver releases them in order.
+ */
+class CyborReliableChannel {
+public:
+    // Sequence, ack, ack bits, reliable bytes
+    static constexpr size_t HEADER_SIZE = 10;
+    // Per message: id and length
+    static constexpr size_t MESSAGE_HEADER_SIZE = 4;
+    static constexpr size_t MAX_MESSAGE_SIZE = 1024;
+    // Messages in flight, and buffered out of order on the receiving side
+    static constexpr uint16_t WINDOW = 256;
+    // Messages waiting for room in the window, e.g. a full roster for a new player
+    static constexpr size_t MAX_BACKLOG = 4096;
+    static constexpr double RESEND_DELAY = 0.1;
+
+    struct PacketHeader {
+        uint16_t sequence;
+        uint16_t ack;
+        uint32_t ackBits;
+    };
+
+public:
+    CyborReliableChannel();
+
+    // Forget everything; both ends start over on a new connection
+    void Reset();
+
+    // Copies the message for sending; false when it is too big or too much is waiting
+    bool Queue(const uint8_t* data, size_t size);
+
+    // Sender: appends whatever reliable messages are due and fit within maxSize,
+    // then prepends the header. Call once for every packet that goes to the peer.
+    bool WritePacket(CyborPacketBuffer& packet, size_t maxSize, double now);
+    // Receiver: applies the peer's acks, takes the reliable messages and strips both,
+    // leaving the packet's unreliable message. False when the framing is malformed.
+    bool ReadPacket(CyborPacketBuffer& packet);
+    // Next reliable message in order, copied into 'out'
+    bool PopMessage(CyborPacketBuffer& out);
+    bool HasMessage() const { return m_incoming[m_nextDeliverId % WINDOW].valid; }
+
+    // A packet should go out even without anything unreliable to carry
+    bool WantsToSend(double now) const;
+
+    // How long a message waits for its ack before going out again; RESEND_DELAY by default
+    void SetResendDelay(double delay) { m_resendDelay = delay; }
+    double GetResendDelay() const { return m_resendDelay; }
+
+    // Sequence of the packet WritePacket last framed, and the header ReadPacket last accepted
+    uint16_t GetLastWrittenSequence() const { return static_cast<uint16_t>(m_nextSequence - 1); }
+    const PacketHeader& GetLastReadHeader() const { return m_lastReadHeader; }
+
+    // Statistics
+    uint64_t GetMessagesResent() const { return m_messagesResent; }
+    size_t GetMessagesInFlight() const { return static_cast<uint16_t>(m_nextMessageId - m_oldestUnacked) + m_backlog.size(); }
+
+private:
+    static constexpr uint16_t SENT_PACKETS = 256;
+    static constexpr size_t MAX_MESSAGES_PER_PACKET = 32;
+
+    struct OutgoingMessage {
+        std::vector<uint8_t> data; // Capacity kept between uses
+        double lastSendTime;
+        bool pending;              // Queued and not acked yet
+        bool sent;
+    };
+
+    struct SentPacket {
+        uint16_t sequence;
+        bool valid;
+        uint8_t messageCount;
+        uint16_t messageIds[MAX_MESSAGES_PER_PACKET];
+    };
+
+    struct IncomingMessage {
+        std::vector<uint8_t> data;
+        bool valid;
+    };
+
+    // Sending
+    std::vector<OutgoingMessage> m_outgoing; // Indexed by message id % WINDOW
+    std::vector<SentPacket> m_sentPackets;   // Indexed by sequence % SENT_PACKETS
+    uint16_t m_nextMessageId;
+    uint16_t m_oldestUnacked;
+    uint16_t m_nextSequence;
+    std::deque<std::vector<uint8_t>> m_backlog;
+    double m_resendDelay;
+
+    // Receiving
+    std::vector<IncomingMessage> m_incoming; // Indexed by message id % WINDOW
+    uint16_t m_nextDeliverId;
+    uint16_t m_receivedSequence;
+    uint32_t m_receivedBits; // Bit n: m_receivedSequence - 1 - n arrived
+    bool m_hasReceived;
+    bool m_ackPending;       // Reliable data arrived since our last packet
+    PacketHeader m_lastReadHeader;
+
+    uint64_t m_messagesResent;
+
+    void AddToWindow(const uint8_t* data, size_t size);
+    void ProcessAck(uint16_t ack, uint32_t ackBits);
+    void AckPacket(uint16_t sequence);
+    void RecordReceived(uint16_t sequence);
+
+    // Wrap-around comparisons
+    static bool SequenceGreaterThan(uint16_t a, uint16_t b) { return static_cast<int16_t>(a - b) > 0; }
+    static uint16_t Distance(uint16_t from, uint16_t to) { return static_cast<uint16_t>(to - from); }
+};
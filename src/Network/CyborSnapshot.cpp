@@ -0,0 +1,365 @@
+#include "CyborSnapshot.h"
+#include <algorithm>
+#include <cmath>
+
+// Field widths
+static const int SEQUENCE_BITS = 16;
+static const int ENTITY_COUNT_BITS = 10;
+static const int HEALTH_BITS = 7;
+static const int ARMOR_BITS = 7;
+static const int WEAPON_BITS = 4;
+static const int FLAGS_BITS = 3;
+static const int SMALL_ID_DELTA_BITS = 6;
+
+static bool CompareEntityId(const CyborSnapshotCodec::NetEntity& entity, uint32_t entityId) {
+    return entity.entityId < entityId;
+}
+
+CyborSnapshotCodec::CyborSnapshotCodec()
+    : m_settings(QuantizationSettings()) {
+}
+
+CyborSnapshotCodec::CyborSnapshotCodec(const QuantizationSettings& settings)
+    : m_settings(settings) {
+}
+
+void CyborSnapshotCodec::Quantize(const EntityState* states, size_t count, Snapshot& outSnapshot) const {
+    outSnapshot.entities.resize(std::min(count, MAX_ENTITIES));
+
+    for (size_t i = 0; i < outSnapshot.entities.size(); i++) {
+        const EntityState& state = states[i];
+        NetEntity& entity = outSnapshot.entities[i];
+
+        entity.entityId = state.entityId;
+        for (int axis = 0; axis < 3; axis++) {
+            entity.position[axis] = QuantizePosition(state.position[axis], axis);
+        }
+        entity.yaw = QuantizeAngle(state.yaw);
+        entity.pitch = QuantizeAngle(state.pitch);
+        entity.health = static_cast<uint8_t>(std::clamp(std::lround(state.health), 0L, (1L << HEALTH_BITS) - 1));
+        entity.armor = static_cast<uint8_t>(std::clamp(std::lround(state.armor), 0L, (1L << ARMOR_BITS) - 1));
+        entity.weaponType = state.weaponType & ((1 << WEAPON_BITS) - 1);
+        entity.flags = static_cast<uint8_t>((state.alive ? 1 : 0) | ((state.team & 3) << 1));
+    }
+
+    std::sort(outSnapshot.entities.begin(), outSnapshot.entities.end(),
+        [](const NetEntity& a, const NetEntity& b) { return a.entityId < b.entityId; });
+}
+
+void CyborSnapshotCodec::Dequantize(const NetEntity& entity, EntityState& outState) const {
+    outState.entityId = entity.entityId;
+    for (int axis = 0; axis < 3; axis++) {
+        outState.position[axis] = DequantizePosition(entity.position[axis], axis);
+    }
+    outState.yaw = DequantizeAngle(entity.yaw);
+    outState.pitch = DequantizeAngle(entity.pitch);
+    outState.health = entity.health;
+    outState.armor = entity.armor;
+    outState.weaponType = entity.weaponType;
+    outState.team = (entity.flags >> 1) & 3;
+    outState.alive = (entity.flags & 1) != 0;
+}
+
+void CyborSnapshotCodec::Encode(const Snapshot& snapshot, const Snapshot* baseline, CyborBitWriter& writer) const {
+    writer.WriteBits(snapshot.sequence, SEQUENCE_BITS);
+    writer.WriteFloat(snapshot.serverTime);
+    writer.WriteBool(baseline != nullptr);
+    if (baseline) {
+        writer.WriteBits(baseline->sequence, SEQUENCE_BITS);
+    }
+
+    static const std::vector<NetEntity> noEntities;
+    const std::vector<NetEntity>& previous = baseline ? baseline->entities : noEntities;
+    const std::vector<NetEntity>& current = snapshot.entities;
+
+    // Both lists are sorted by id, so one merge pass finds removals and changes
+    uint32_t removedIds[MAX_ENTITIES];
+    uint32_t changedIndices[MAX_ENTITIES];
+    int32_t changedBaseline[MAX_ENTITIES];
+    uint32_t changedMasks[MAX_ENTITIES];
+    size_t removedCount = 0;
+    size_t changedCount = 0;
+
+    size_t p = 0;
+    for (size_t c = 0; c < current.size(); c++) {
+        while (p < previous.size() && previous[p].entityId < current[c].entityId) {
+            removedIds[removedCount++] = previous[p++].entityId;
+        }
+
+        if (p < previous.size() && previous[p].entityId == current[c].entityId) {
+            uint32_t mask = ComputeChangeMask(current[c], previous[p]);
+            if (mask != 0) {
+                changedIndices[changedCount] = static_cast<uint32_t>(c);
+                changedBaseline[changedCount] = static_cast<int32_t>(p);
+                changedMasks[changedCount++] = mask;
+            }
+            p++;
+        } else {
+            changedIndices[changedCount] = static_cast<uint32_t>(c);
+            changedBaseline[changedCount] = -1;
+            changedMasks[changedCount++] = CHANGED_ALL;
+        }
+    }
+    while (p < previous.size() && removedCount < MAX_ENTITIES) {
+        removedIds[removedCount++] = previous[p++].entityId;
+    }
+
+    writer.WriteBits(static_cast<uint32_t>(removedCount), ENTITY_COUNT_BITS);
+    uint32_t previousId = 0;
+    for (size_t i = 0; i < removedCount; i++) {
+        WriteIdDelta(removedIds[i] - previousId, writer);
+        previousId = removedIds[i];
+    }
+
+    writer.WriteBits(static_cast<uint32_t>(changedCount), ENTITY_COUNT_BITS);
+    previousId = 0;
+    for (size_t i = 0; i < changedCount; i++) {
+        const NetEntity& entity = current[changedIndices[i]];
+        const NetEntity* base = changedBaseline[i] >= 0 ? &previous[changedBaseline[i]] : nullptr;
+
+        WriteIdDelta(entity.entityId - previousId, writer);
+        previousId = entity.entityId;
+        if (baseline) {
+            writer.WriteBool(base == nullptr);
+        }
+        WriteEntity(entity, base, changedMasks[i], writer);
+    }
+}
+
+bool CyborSnapshotCodec::Decode(CyborBitReader& reader, const CyborSnapshotHistory& baselines, Snapshot& outSnapshot) const {
+    outSnapshot.sequence = static_cast<uint16_t>(reader.ReadBits(SEQUENCE_BITS));
+    outSnapshot.serverTime = reader.ReadFloat();
+
+    const Snapshot* baseline = nullptr;
+    const bool hasBaseline = reader.ReadBool();
+    if (hasBaseline) {
+        baseline = baselines.Find(static_cast<uint16_t>(reader.ReadBits(SEQUENCE_BITS)));
+        if (!baseline) return false;
+    }
+
+    // Start from the baseline minus the entities it lost
+    outSnapshot.entities.clear();
+    const size_t removedCount = reader.ReadBits(ENTITY_COUNT_BITS);
+    uint32_t removedId = 0;
+    size_t p = 0;
+    for (size_t i = 0; i < removedCount && !reader.HasOverflowed(); i++) {
+        removedId += ReadIdDelta(reader);
+        if (!baseline) return false;
+        while (p < baseline->entities.size() && baseline->entities[p].entityId < removedId) {
+            outSnapshot.entities.push_back(baseline->entities[p++]);
+        }
+        if (p < baseline->entities.size() && baseline->entities[p].entityId == removedId) p++;
+    }
+    if (baseline) {
+        outSnapshot.entities.insert(outSnapshot.entities.end(), baseline->entities.begin() + p, baseline->entities.end());
+    }
+
+    // Apply changes in place; new entities are appended and sorted in at the end
+    const size_t unchangedCount = outSnapshot.entities.size();
+    const size_t changedCount = reader.ReadBits(ENTITY_COUNT_BITS);
+    uint32_t entityId = 0;
+    for (size_t i = 0; i < changedCount && !reader.HasOverflowed(); i++) {
+        entityId += ReadIdDelta(reader);
+        const bool isNew = hasBaseline ? reader.ReadBool() : true;
+
+        if (isNew) {
+            NetEntity entity = {};
+            entity.entityId = entityId;
+            ReadEntity(entity, false, reader);
+            outSnapshot.entities.push_back(entity);
+        } else {
+            auto end = outSnapshot.entities.begin() + unchangedCount;
+            auto it = std::lower_bound(outSnapshot.entities.begin(), end, entityId, CompareEntityId);
+            if (it == end || it->entityId != entityId) return false;
+            ReadEntity(*it, true, reader);
+        }
+    }
+
+    if (reader.HasOverflowed()) return false;
+
+    if (outSnapshot.entities.size() > unchangedCount) {
+        std::inplace_merge(outSnapshot.entities.begin(), outSnapshot.entities.begin() + unchangedCount,
+                           outSnapshot.entities.end(),
+            [](const NetEntity& a, const NetEntity& b) { return a.entityId < b.entityId; });
+    }
+    return true;
+}
+
+uint32_t CyborSnapshotCodec::GetHeaderBits(bool hasBaseline) {
+    return SEQUENCE_BITS + 32 + 1 + (hasBaseline ? SEQUENCE_BITS : 0) + 2 * ENTITY_COUNT_BITS;
+}
+
+uint32_t CyborSnapshotCodec::GetRemovedEntityBits() {
+    return 1 + SMALL_ID_DELTA_BITS;
+}
+
+uint32_t CyborSnapshotCodec::GetEntityBits(const NetEntity& entity, const NetEntity* entityBaseline, bool hasBaseline) const {
+    const uint32_t changeMask = entityBaseline ? ComputeChangeMask(entity, *entityBaseline) : static_cast<uint32_t>(CHANGED_ALL);
+    if (changeMask == 0) return 0;
+
+    // Mirrors WriteEntity
+    uint32_t bits = 1 + SMALL_ID_DELTA_BITS + (hasBaseline ? 1 : 0);
+    if (entityBaseline) bits += CHANGE_MASK_BITS;
+    const int32_t deltaLimit = 1 << (m_settings.positionDeltaBits - 1);
+    for (int axis = 0; axis < 3; axis++) {
+        if (!(changeMask & (CHANGED_POSITION_X << axis))) continue;
+        if (entityBaseline) {
+            const int32_t delta = static_cast<int32_t>(entity.position[axis]) - static_cast<int32_t>(entityBaseline->position[axis]);
+            bits++;
+            if (delta >= -deltaLimit && delta < deltaLimit) {
+                bits += m_settings.positionDeltaBits;
+                continue;
+            }
+        }
+        bits += m_settings.positionBits;
+    }
+    if (changeMask & CHANGED_YAW) bits += m_settings.angleBits;
+    if (changeMask & CHANGED_PITCH) bits += m_settings.angleBits;
+    if (changeMask & CHANGED_HEALTH) bits += HEALTH_BITS;
+    if (changeMask & CHANGED_ARMOR) bits += ARMOR_BITS;
+    if (changeMask & CHANGED_WEAPON) bits += WEAPON_BITS;
+    if (changeMask & CHANGED_FLAGS) bits += FLAGS_BITS;
+    return bits;
+}
+
+uint32_t CyborSnapshotCodec::QuantizePosition(float value, int axis) const {
+    const float range = m_settings.worldMax[axis] - m_settings.worldMin[axis];
+    const float normalized = std::clamp((value - m_settings.worldMin[axis]) / range, 0.0f, 1.0f);
+    const uint32_t maxValue = (1u << m_settings.positionBits) - 1;
+    return static_cast<uint32_t>(std::lround(normalized * maxValue));
+}
+
+float CyborSnapshotCodec::DequantizePosition(uint32_t value, int axis) const {
+    const float range = m_settings.worldMax[axis] - m_settings.worldMin[axis];
+    const uint32_t maxValue = (1u << m_settings.positionBits) - 1;
+    return m_settings.worldMin[axis] + range * (static_cast<float>(value) / maxValue);
+}
+
+uint32_t CyborSnapshotCodec::QuantizeAngle(float degrees) const {
+    float wrapped = std::fmod(degrees, 360.0f);
+    if (wrapped < 0.0f) wrapped += 360.0f;
+    const uint32_t steps = 1u << m_settings.angleBits;
+    return static_cast<uint32_t>(std::lround(wrapped / 360.0f * steps)) & (steps - 1);
+}
+
+float CyborSnapshotCodec::DequantizeAngle(uint32_t value) const {
+    float degrees = static_cast<float>(value) * 360.0f / static_cast<float>(1u << m_settings.angleBits);
+    return degrees > 180.0f ? degrees - 360.0f : degrees;
+}
+
+uint32_t CyborSnapshotCodec::ComputeChangeMask(const NetEntity& current, const NetEntity& baseline) {
+    uint32_t mask = 0;
+    if (current.position[0] != baseline.position[0]) mask |= CHANGED_POSITION_X;
+    if (current.position[1] != baseline.position[1]) mask |= CHANGED_POSITION_Y;
+    if (current.position[2] != baseline.position[2]) mask |= CHANGED_POSITION_Z;
+    if (current.yaw != baseline.yaw) mask |= CHANGED_YAW;
+    if (current.pitch != baseline.pitch) mask |= CHANGED_PITCH;
+    if (current.health != baseline.health) mask |= CHANGED_HEALTH;
+    if (current.armor != baseline.armor) mask |= CHANGED_ARMOR;
+    if (current.weaponType != baseline.weaponType) mask |= CHANGED_WEAPON;
+    if (current.flags != baseline.flags) mask |= CHANGED_FLAGS;
+    return mask;
+}
+
+void CyborSnapshotCodec::WriteEntity(const NetEntity& entity, const NetEntity* baseline, uint32_t changeMask,
+                                     CyborBitWriter& writer) const {
+    if (baseline) {
+        writer.WriteBits(changeMask, CHANGE_MASK_BITS);
+    }
+
+    const int32_t deltaLimit = 1 << (m_settings.positionDeltaBits - 1);
+    for (int axis = 0; axis < 3; axis++) {
+        if (!(changeMask & (CHANGED_POSITION_X << axis))) continue;
+
+        // Moving entities usually only shift a few quantization steps per snapshot
+        if (baseline) {
+            const int32_t delta = static_cast<int32_t>(entity.position[axis]) - static_cast<int32_t>(baseline->position[axis]);
+            const bool small = delta >= -deltaLimit && delta < deltaLimit;
+            writer.WriteBool(small);
+            if (small) {
+                writer.WriteBits(static_cast<uint32_t>(delta + deltaLimit), m_settings.positionDeltaBits);
+                continue;
+            }
+        }
+        writer.WriteBits(entity.position[axis], m_settings.positionBits);
+    }
+
+    if (changeMask & CHANGED_YAW) writer.WriteBits(entity.yaw, m_settings.angleBits);
+    if (changeMask & CHANGED_PITCH) writer.WriteBits(entity.pitch, m_settings.angleBits);
+    if (changeMask & CHANGED_HEALTH) writer.WriteBits(entity.health, HEALTH_BITS);
+    if (changeMask & CHANGED_ARMOR) writer.WriteBits(entity.armor, ARMOR_BITS);
+    if (changeMask & CHANGED_WEAPON) writer.WriteBits(entity.weaponType, WEAPON_BITS);
+    if (changeMask & CHANGED_FLAGS) writer.WriteBits(entity.flags, FLAGS_BITS);
+}
+
+void CyborSnapshotCodec::ReadEntity(NetEntity& entity, bool hasBaseline, CyborBitReader& reader) const {
+    const uint32_t changeMask = hasBaseline ? reader.ReadBits(CHANGE_MASK_BITS) : static_cast<uint32_t>(CHANGED_ALL);
+
+    const int32_t deltaLimit = 1 << (m_settings.positionDeltaBits - 1);
+    for (int axis = 0; axis < 3; axis++) {
+        if (!(changeMask & (CHANGED_POSITION_X << axis))) continue;
+
+        if (hasBaseline && reader.ReadBool()) {
+            const int32_t delta = static_cast<int32_t>(reader.ReadBits(m_settings.positionDeltaBits)) - deltaLimit;
+            entity.position[axis] = static_cast<uint32_t>(static_cast<int32_t>(entity.position[axis]) + delta);
+        } else {
+            entity.position[axis] = reader.ReadBits(m_settings.positionBits);
+        }
+    }
+
+    if (changeMask & CHANGED_YAW) entity.yaw = reader.ReadBits(m_settings.angleBits);
+    if (changeMask & CHANGED_PITCH) entity.pitch = reader.ReadBits(m_settings.angleBits);
+    if (changeMask & CHANGED_HEALTH) entity.health = static_cast<uint8_t>(reader.ReadBits(HEALTH_BITS));
+    if (changeMask & CHANGED_ARMOR) entity.armor = static_cast<uint8_t>(reader.ReadBits(ARMOR_BITS));
+    if (changeMask & CHANGED_WEAPON) entity.weaponType = static_cast<uint8_t>(reader.ReadBits(WEAPON_BITS));
+    if (changeMask & CHANGED_FLAGS) entity.flags = static_cast<uint8_t>(reader.ReadBits(FLAGS_BITS));
+}
+
+void CyborSnapshotCodec::WriteIdDelta(uint32_t delta, CyborBitWriter& writer) {
+    const bool small = delta < (1u << SMALL_ID_DELTA_BITS);
+    writer.WriteBool(small);
+    writer.WriteBits(delta, small ? SMALL_ID_DELTA_BITS : 32);
+}
+
+uint32_t CyborSnapshotCodec::ReadIdDelta(CyborBitReader& reader) {
+    const bool small = reader.ReadBool();
+    return reader.ReadBits(small ? SMALL_ID_DELTA_BITS : 32);
+}
+
+CyborSnapshotHistory::CyborSnapshotHistory()
+    : m_latestIndex(-1) {
+    Clear();
+}
+
+void CyborSnapshotHistory::Clear() {
+    for (int i = 0; i < CAPACITY; i++) {
+        m_valid[i] = false;
+    }
+    m_latestIndex = -1;
+}
+
+void CyborSnapshotHistory::Store(const CyborSnapshotCodec::Snapshot& snapshot) {
+    const int index = snapshot.sequence % CAPACITY;
+    m_snapshots[index].sequence = snapshot.sequence;
+    m_snapshots[index].serverTime = snapshot.serverTime;
+    m_snapshots[index].entities.assign(snapshot.entities.begin(), snapshot.entities.end());
+    m_valid[index] = true;
+
+    if (m_latestIndex < 0 || SequenceGreaterThan(snapshot.sequence, m_snapshots[m_latestIndex].sequence)) {
+        m_latestIndex = index;
+    }
+}
+
+const CyborSnapshotCodec::Snapshot* CyborSnapshotHistory::Find(uint16_t sequence) const {
+    const int index = sequence % CAPACITY;
+    if (!m_valid[index] || m_snapshots[index].sequence != sequence) return nullptr;
+    return &m_snapshots[index];
+}
+
+const CyborSnapshotCodec::Snapshot* CyborSnapshotHistory::GetLatest() const {
+    return m_latestIndex >= 0 ? &m_snapshots[m_latestIndex] : nullptr;
+}
+
+bool CyborSnapshotHistory::SequenceGreaterThan(uint16_t a, uint16_t b) {
+    return ((a > b) && (a - b <= 32768)) || ((a < b) && (b - a > 32768));
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "CyborBitStream.h"
+
+class CyborSnapshotHistory;
+
+/*
+ * CyborSnapshotCodec - Quantized, delta-compressed world snapshots
+ * Entities are quantized to configurable bit widths and encoded against the
+ * last snapshot the client acknowledged: unchanged entities cost nothing and
+ * changed ones only send the fields set in their change mask
+ */
+class CyborSnapshotCodec {
+public:
+    // World-space entity state as the game sees it
+    struct EntityState {
+        uint32_t entityId;
+        glm::vec3 position;
+        float yaw;   // Degrees
+        float pitch; // Degrees
+        float health;
+        float armor;
+        uint8_t weaponType;
+        uint8_t team;
+        bool alive;
+    };
+
+    struct QuantizationSettings {
+        glm::vec3 worldMin = glm::vec3(-64.0f, -8.0f, -64.0f);
+        glm::vec3 worldMax = glm::vec3(64.0f, 56.0f, 64.0f);
+        int positionBits = 16;   // 128 units / 65536 ~ 2 mm
+        int angleBits = 12;      // ~0.09 degrees
+        int positionDeltaBits = 8; // Signed, used when a component moved only a little
+    };
+
+    // Quantized entity, fields compared directly for change masks
+    struct NetEntity {
+        uint32_t entityId;
+        uint32_t position[3];
+        uint32_t yaw;
+        uint32_t pitch;
+        uint8_t health;
+        uint8_t armor;
+        uint8_t weaponType;
+        uint8_t flags; // Bit 0 alive, bits 1-2 team
+    };
+
+    // Entities sorted by id
+    struct Snapshot {
+        uint16_t sequence = 0;
+        float serverTime = 0.0f;
+        std::vector<NetEntity> entities;
+    };
+
+    static constexpr size_t MAX_ENTITIES = 1023;
+
+public:
+    CyborSnapshotCodec();
+    explicit CyborSnapshotCodec(const QuantizationSettings& settings);
+
+    // Entities need not be sorted; the snapshot is
+    void Quantize(const EntityState* states, size_t count, Snapshot& outSnapshot) const;
+    void Dequantize(const NetEntity& entity, EntityState& outState) const;
+
+    // baseline == nullptr sends every entity in full
+    void Encode(const Snapshot& snapshot, const Snapshot* baseline, CyborBitWriter& writer) const;
+    // Fails when the packet is truncated or its baseline is no longer available
+    bool Decode(CyborBitReader& reader, const CyborSnapshotHistory& baselines, Snapshot& outSnapshot) const;
+
+    // What Encode spends, for packing a snapshot into a budget: the header, each entity the
+    // baseline had and the snapshot drops, and each entity it carries (0 when unchanged).
+    // Gaps between consecutive ids are assumed to be short; a long one costs 26 bits more.
+    static uint32_t GetHeaderBits(bool hasBaseline);
+    static uint32_t GetRemovedEntityBits();
+    uint32_t GetEntityBits(const NetEntity& entity, const NetEntity* entityBaseline, bool hasBaseline) const;
+
+    // Single-value helpers, also used for client updates
+    uint32_t QuantizePosition(float value, int axis) const;
+    float DequantizePosition(uint32_t value, int axis) const;
+    uint32_t QuantizeAngle(float degrees) const;
+    float DequantizeAngle(uint32_t value) const;
+
+    const QuantizationSettings& GetSettings() const { return m_settings; }
+
+private:
+    enum ChangeBits : uint32_t {
+        CHANGED_POSITION_X = 1 << 0,
+        CHANGED_POSITION_Y = 1 << 1,
+        CHANGED_POSITION_Z = 1 << 2,
+        CHANGED_YAW        = 1 << 3,
+        CHANGED_PITCH      = 1 << 4,
+        CHANGED_HEALTH     = 1 << 5,
+        CHANGED_ARMOR      = 1 << 6,
+        CHANGED_WEAPON     = 1 << 7,
+        CHANGED_FLAGS      = 1 << 8,
+        CHANGED_ALL        = (1 << 9) - 1
+    };
+    static constexpr int CHANGE_MASK_BITS = 9;
+
+    QuantizationSettings m_settings;
+
+    // Private methods
+    static uint32_t ComputeChangeMask(const NetEntity& current, const NetEntity& baseline);
+    void WriteEntity(const NetEntity& entity, const NetEntity* baseline, uint32_t changeMask, CyborBitWriter& writer) const;
+    void ReadEntity(NetEntity& entity, bool hasBaseline, CyborBitReader& reader) const;
+    static void WriteIdDelta(uint32_t delta, CyborBitWriter& writer);
+    static uint32_t ReadIdDelta(CyborBitReader& reader);
+};
+
+/*
+ * CyborSnapshotHistory - Ring of recent snapshots, indexed by sequence
+ * The server keeps what it sent to each client, the client what it received
+ */
+class CyborSnapshotHistory {
+public:
+    static constexpr int CAPACITY = 32;
+
+public:
+    CyborSnapshotHistory();
+
+    void Clear();
+    void Store(const CyborSnapshotCodec::Snapshot& snapshot);
+    const CyborSnapshotCodec::Snapshot* Find(uint16_t sequence) const;
+    const CyborSnapshotCodec::Snapshot* GetLatest() const;
+
+    // True when a is newer than b, tolerating 16-bit wrap-around
+    static bool SequenceGreaterThan(uint16_t a, uint16_t b);
+
+private:
+    CyborSnapshotCodec::Snapshot m_snapshots[CAPACITY];
+    bool m_valid[CAPACITY];
+    int m_latestIndex;
+};
@@ -0,0 +1,655 @@
+#include "CyborUdpTransport.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// Every datagram starts with the protocol id and a packet type
+static const uint32_t PROTOCOL_ID = 0x31425943; // "CYB1"
+static const size_t MAX_DATAGRAM_SIZE = 1500;
+static const int BATCH_SIZE = 64;
+static const size_t SERVER_POOL_SIZE = 256;
+static const size_t CLIENT_POOL_SIZE = 2 * BATCH_SIZE; // A receive batch plus what is in flight; load tests run thousands
+static const int EPOLL_TIMEOUT_MS = 5;
+static const int SOCKET_BUFFER_SIZE = 4 * 1024 * 1024;
+static const uint64_t INBOUND_SEED_MIX = 0x9e3779b97f4a7c15ULL; // Gives the two directions unrelated streams
+
+CyborUdpTransport::CyborUdpTransport()
+    : m_packetPool(0), m_socket(-1), m_epoll(-1), m_wakeEvent(-1), m_running(false), m_isServer(false), m_maxPeers(0),
+      m_localPeerId(INVALID_PEER), m_connectedPeers(0),
+      m_outgoingQueue(QUEUE_CAPACITY), m_eventQueue(QUEUE_CAPACITY), m_emulateLink(false), m_linkSeed(1),
+      m_packetsSent(0), m_packetsReceived(0), m_bytesSent(0), m_bytesReceived(0) {
+}
+
+CyborUdpTransport::~CyborUdpTransport() {
+    Stop();
+}
+
+bool CyborUdpTransport::StartServer(uint16_t port, int maxPeers) {
+    if (m_running) return false;
+    if (!OpenSocket(port)) return false;
+
+    m_isServer = true;
+    m_maxPeers = maxPeers;
+    m_packetPool.Reserve(SERVER_POOL_SIZE);
+    m_peers.assign(maxPeers, Peer{ PeerState::DISCONNECTED, 0, 0, 0.0, 0.0, 0.0 });
+    m_peerAddresses.assign(maxPeers, std::string());
+    m_addressToPeer.clear();
+    m_localPeerId = INVALID_PEER;
+    m_connectedPeers = 0;
+    ResetLinkEmulation();
+
+    m_running = true;
+    m_networkThread = std::thread(&CyborUdpTransport::NetworkThreadFunction, this);
+    return true;
+}
+
+bool CyborUdpTransport::StartClient(const std::string& address, uint16_t port) {
+    if (m_running) return false;
+
+#ifdef __linux__
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(address.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        std::cerr << "Cannot resolve server address " << address << std::endl;
+        return false;
+    }
+    uint32_t serverAddress = reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr.s_addr;
+    uint16_t serverPort = htons(port);
+    freeaddrinfo(result);
+#else
+    uint32_t serverAddress = 0;
+    uint16_t serverPort = port;
+#endif
+
+    if (!OpenSocket(0)) return false;
+
+    // Peer 0 is always the server
+    const double now = Now();
+    m_isServer = false;
+    m_maxPeers = 1;
+    m_packetPool.Reserve(CLIENT_POOL_SIZE);
+    m_peers.assign(1, Peer{ PeerState::CONNECTING, serverAddress, serverPort, 0.0, 0.0, now });
+    m_peerAddresses.assign(1, address + ":" + std::to_string(port));
+    m_addressToPeer.clear();
+    m_addressToPeer[AddressKey(serverAddress, serverPort)] = 0;
+    m_localPeerId = INVALID_PEER;
+    m_connectedPeers = 0;
+    ResetLinkEmulation();
+
+    m_running = true;
+    m_networkThread = std::thread(&CyborUdpTransport::NetworkThreadFunction, this);
+    return true;
+}
+
+void CyborUdpTransport::Stop() {
+    if (!m_running) return;
+
+    // Say goodbye; the network thread flushes this before it exits
+    PushOutgoing(INVALID_PEER, PacketType::DISCONNECT, m_packetPool.Acquire());
+    m_running = false;
+    Flush();
+    if (m_networkThread.joinable()) {
+        m_networkThread.join();
+    }
+
+    // Nothing else touches the queues now; drop whatever is left for the next session
+    OutgoingPacket outgoing;
+    while (m_outgoingQueue.TryPop(outgoing)) {}
+    Event event;
+    while (m_eventQueue.TryPop(event)) {}
+
+    CloseSocket();
+    m_peers.clear();
+    m_addressToPeer.clear();
+    m_controlPackets.clear();
+    m_sending.clear();
+    m_eventBacklog.clear();
+    m_receivePackets.clear();
+    m_linkDeliveries.clear();
+    m_connectedPeers = 0;
+    m_localPeerId = INVALID_PEER;
+}
+
+bool CyborUdpTransport::Send(uint32_t peerId, CyborPacketPtr packet) {
+    if (!m_running || !packet || packet->Size() + HEADER_SIZE > MAX_PACKET_SIZE ||
+        packet->GetHeadroom() < HEADER_SIZE) {
+        return false;
+    }
+
+    return PushOutgoing(peerId, PacketType::PAYLOAD, std::move(packet));
+}
+
+bool CyborUdpTransport::Send(uint32_t peerId, const uint8_t* data, size_t size) {
+    if (!m_running || size + HEADER_SIZE > MAX_PACKET_SIZE) return false;
+
+    CyborPacketPtr packet = m_packetPool.Acquire();
+    packet->Append(data, size);
+    return Send(peerId, std::move(packet));
+}
+
+void CyborUdpTransport::Broadcast(const uint8_t* data, size_t size) {
+    Send(INVALID_PEER, data, size);
+}
+
+void CyborUdpTransport::Flush() {
+#ifdef __linux__
+    // One wakeup per tick rather than one per packet
+    if (m_wakeEvent >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(m_wakeEvent, &one, sizeof(one));
+        (void)written;
+    }
+#endif
+}
+
+bool CyborUdpTransport::PollEvent(Event& outEvent) {
+    if (!m_eventQueue.TryPop(outEvent)) return false;
+
+    if (outEvent.type == Event::Type::CONNECTED && outEvent.packet && outEvent.peerId < m_peerAddresses.size()) {
+        m_peerAddresses[outEvent.peerId].assign(reinterpret_cast<const char*>(outEvent.packet->Data()),
+                                                outEvent.packet->Size());
+    }
+    return true;
+}
+
+void CyborUdpTransport::DisconnectPeer(uint32_t peerId) {
+    if (peerId == INVALID_PEER) return;
+    PushOutgoing(peerId, PacketType::DISCONNECT, m_packetPool.Acquire());
+    Flush();
+}
+
+std::string CyborUdpTransport::GetPeerAddress(uint32_t peerId) const {
+    return peerId < m_peerAddresses.size() ? m_peerAddresses[peerId] : std::string();
+}
+
+bool CyborUdpTransport::SetLinkEmulation(const CyborLinkEmulator::Settings& outbound,
+                                         const CyborLinkEmulator::Settings& inbound, uint64_t seed) {
+    if (m_running) return false;
+
+    m_emulateLink = true;
+    m_linkSeed = seed;
+    m_outboundLink.Configure(outbound, seed);
+    m_inboundLink.Configure(inbound, seed ^ INBOUND_SEED_MIX);
+    return true;
+}
+
+bool CyborUdpTransport::DisableLinkEmulation() {
+    if (m_running) return false;
+
+    m_emulateLink = false;
+    m_outboundLink.Clear();
+    m_inboundLink.Clear();
+    return true;
+}
+
+void CyborUdpTransport::ResetLinkEmulation() {
+    // Every session replays the same fates
+    if (!m_emulateLink) return;
+    m_outboundLink.Configure(m_outboundLink.GetSettings(), m_linkSeed);
+    m_inboundLink.Configure(m_inboundLink.GetSettings(), m_linkSeed ^ INBOUND_SEED_MIX);
+}
+
+void CyborUdpTransport::DeliverInbound(double now) {
+    CyborLinkEmulator::Delivery delivery;
+    while (m_inboundLink.PollDelivered(now, delivery)) {
+        HandlePacket(delivery.address, delivery.port, delivery.packet, now);
+    }
+}
+
+bool CyborUdpTransport::PushOutgoing(uint32_t peerId, PacketType type, CyborPacketPtr packet) {
+    OutgoingPacket outgoing{ peerId, type, std::move(packet) };
+    return m_outgoingQueue.TryPush(std::move(outgoing));
+}
+
+void CyborUdpTransport::QueueControl(uint32_t peerId, PacketType type, const uint8_t* data, size_t size) {
+    // Network thread only, so it needs no queue of its own
+    CyborPacketPtr packet = m_packetPool.Acquire();
+    packet->Append(data, size);
+    m_controlPackets.push_back({ peerId, type, std::move(packet) });
+}
+
+uint32_t CyborUdpTransport::AllocatePeer(uint32_t address, uint16_t port, double now) {
+    for (uint32_t peerId = 0; peerId < m_peers.size(); peerId++) {
+        Peer& peer = m_peers[peerId];
+        if (peer.state != PeerState::DISCONNECTED) continue;
+
+        peer = { PeerState::CONNECTED, address, port, now, 0.0, now };
+        m_addressToPeer[AddressKey(address, port)] = peerId;
+        m_connectedPeers++;
+        return peerId;
+    }
+    return INVALID_PEER;
+}
+
+void CyborUdpTransport::ReleasePeer(uint32_t peerId) {
+    Peer& peer = m_peers[peerId];
+    if (peer.state == PeerState::CONNECTED) {
+        m_connectedPeers--;
+    }
+    peer.state = PeerState::DISCONNECTED;
+
+    // The client keeps its server mapping so a late accept is still recognised
+    if (m_isServer) {
+        m_addressToPeer.erase(AddressKey(peer.address, peer.port));
+    }
+}
+
+void CyborUdpTransport::PushEvent(Event::Type type, uint32_t peerId, CyborPacketPtr packet) {
+    Event event{ type, peerId, std::move(packet), Now() };
+    if (!m_eventBacklog.empty() || !m_eventQueue.TryPush(std::move(event))) {
+        m_eventBacklog.push_back(std::move(event));
+    }
+}
+
+void CyborUdpTransport::FlushEventBacklog() {
+    size_t delivered = 0;
+    while (delivered < m_eventBacklog.size() && m_eventQueue.TryPush(std::move(m_eventBacklog[delivered]))) {
+        delivered++;
+    }
+    m_eventBacklog.erase(m_eventBacklog.begin(), m_eventBacklog.begin() + delivered);
+}
+
+void CyborUdpTransport::HandlePacket(uint32_t address, uint16_t port, CyborPacketPtr& packet, double now) {
+    const uint8_t* data = packet->Data();
+    const size_t size = packet->Size();
+    if (size < HEADER_SIZE) return;
+
+    uint32_t protocolId;
+    std::memcpy(&protocolId, data, sizeof(protocolId));
+    if (protocolId != PROTOCOL_ID) return;
+
+    const PacketType type = static_cast<PacketType>(data[4]);
+    const uint8_t* payload = data + HEADER_SIZE;
+    const size_t payloadSize = size - HEADER_SIZE;
+
+    auto found = m_addressToPeer.find(AddressKey(address, port));
+    uint32_t peerId = found != m_addressToPeer.end() ? found->second : INVALID_PEER;
+
+    if (m_isServer && type == PacketType::CONNECT_REQUEST) {
+        if (peerId == INVALID_PEER) {
+            peerId = AllocatePeer(address, port, now);
+            if (peerId == INVALID_PEER) {
+                SendDirect(address, port, PacketType::CONNECT_DENIED);
+                return;
+            }
+            PushEvent(Event::Type::CONNECTED, peerId, FormatAddress(address, port));
+        }
+
+        // Repeated requests mean our accept was lost, so answer every one
+        uint8_t accept[4];
+        std::memcpy(accept, &peerId, sizeof(peerId));
+        QueueControl(peerId, PacketType::CONNECT_ACCEPT, accept, sizeof(accept));
+        m_peers[peerId].lastReceiveTime = now;
+        return;
+    }
+
+    if (peerId == INVALID_PEER) return;
+    Peer& peer = m_peers[peerId];
+
+    switch (type) {
+        case PacketType::CONNECT_ACCEPT:
+            if (!m_isServer && peer.state == PeerState::CONNECTING && payloadSize >= 4) {
+                uint32_t localPeerId;
+                std::memcpy(&localPeerId, payload, sizeof(localPeerId));
+                m_localPeerId = localPeerId;
+                peer.state = PeerState::CONNECTED;
+                peer.lastReceiveTime = now;
+                m_connectedPeers++;
+                PushEvent(Event::Type::CONNECTED, peerId);
+            }
+            break;
+
+        case PacketType::CONNECT_DENIED:
+            if (!m_isServer && peer.state == PeerState::CONNECTING) {
+                std::cerr << "Server is full, connection denied" << std::endl;
+                ReleasePeer(peerId);
+                PushEvent(Event::Type::DISCONNECTED, peerId);
+            }
+            break;
+
+        case PacketType::DISCONNECT:
+            if (peer.state == PeerState::CONNECTED) {
+                ReleasePeer(peerId);
+                PushEvent(Event::Type::DISCONNECTED, peerId);
+            }
+            break;
+
+        case PacketType::KEEPALIVE:
+            peer.lastReceiveTime = now;
+            break;
+
+        case PacketType::PAYLOAD:
+            if (peer.state == PeerState::CONNECTED) {
+                peer.lastReceiveTime = now;
+                // The receive buffer itself becomes the event, minus the header
+                packet->Consume(HEADER_SIZE);
+                PushEvent(Event::Type::PAYLOAD, peerId, std::move(packet));
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void CyborUdpTransport::UpdateConnections(double now) {
+    for (uint32_t peerId = 0; peerId < m_peers.size(); peerId++) {
+        Peer& peer = m_peers[peerId];
+
+        if (peer.state == PeerState::CONNECTING) {
+            if (now - peer.connectStartTime > CONNECTION_TIMEOUT) {
+                std::cerr << "Connection to " << GetPeerAddress(peerId) << " timed out" << std::endl;
+                ReleasePeer(peerId);
+                PushEvent(Event::Type::DISCONNECTED, peerId);
+            } else if (now - peer.lastSendTime >= CONNECT_RETRY_INTERVAL) {
+                QueueControl(peerId, PacketType::CONNECT_REQUEST);
+                peer.lastSendTime = now;
+            }
+        } else if (peer.state == PeerState::CONNECTED) {
+            if (now - peer.lastReceiveTime > CONNECTION_TIMEOUT) {
+                ReleasePeer(peerId);
+                PushEvent(Event::Type::DISCONNECTED, peerId);
+            } else if (now - peer.lastSendTime >= KEEPALIVE_INTERVAL) {
+                QueueControl(peerId, PacketType::KEEPALIVE);
+            }
+        }
+    }
+}
+
+double CyborUdpTransport::Now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+CyborPacketPtr CyborUdpTransport::FormatAddress(uint32_t address, uint16_t port) {
+    CyborPacketPtr packet = m_packetPool.Acquire();
+#ifdef __linux__
+    char text[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &address, text, sizeof(text));
+    const std::string formatted = std::string(text) + ":" + std::to_string(ntohs(port));
+    packet->Append(reinterpret_cast<const uint8_t*>(formatted.data()), formatted.size());
+#else
+    (void)address;
+    (void)port;
+#endif
+    return packet;
+}
+
+uint64_t CyborUdpTransport::AddressKey(uint32_t address, uint16_t port) {
+    return (static_cast<uint64_t>(address) << 16) | port;
+}
+
+#ifdef __linux__
+
+bool CyborUdpTransport::OpenSocket(uint16_t bindPort) {
+    m_socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_socket < 0) {
+        std::cerr << "Failed to create UDP socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // A full match sends bursts every tick; give the kernel room to queue them
+    int bufferSize = SOCKET_BUFFER_SIZE;
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+
+    sockaddr_in bindAddress = {};
+    bindAddress.sin_family = AF_INET;
+    bindAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    bindAddress.sin_port = htons(bindPort);
+    if (bind(m_socket, reinterpret_cast<sockaddr*>(&bindAddress), sizeof(bindAddress)) < 0) {
+        std::cerr << "Failed to bind UDP port " << bindPort << ": " << std::strerror(errno) << std::endl;
+        CloseSocket();
+        return false;
+    }
+
+    m_wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (m_wakeEvent < 0 || m_epoll < 0) {
+        std::cerr << "Failed to create epoll instance: " << std::strerror(errno) << std::endl;
+        CloseSocket();
+        return false;
+    }
+
+    epoll_event socketEvent = {};
+    socketEvent.events = EPOLLIN;
+    socketEvent.data.fd = m_socket;
+    epoll_event wakeEvent = {};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = m_wakeEvent;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket, &socketEvent) < 0 ||
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeEvent, &wakeEvent) < 0) {
+        std::cerr << "Failed to register with epoll: " << std::strerror(errno) << std::endl;
+        CloseSocket();
+        return false;
+    }
+
+    m_receivePackets.resize(BATCH_SIZE);
+    return true;
+}
+
+void CyborUdpTransport::CloseSocket() {
+    if (m_epoll >= 0) close(m_epoll);
+    if (m_wakeEvent >= 0) close(m_wakeEvent);
+    if (m_socket >= 0) close(m_socket);
+    m_epoll = -1;
+    m_wakeEvent = -1;
+    m_socket = -1;
+}
+
+void CyborUdpTransport::NetworkThreadFunction() {
+    epoll_event events[4];
+
+    // Emulated delays need a finer clock than the keepalive tick
+    const int timeout = m_emulateLink ? 1 : EPOLL_TIMEOUT_MS;
+
+    while (m_running) {
+        int ready = epoll_wait(m_epoll, events, 4, timeout);
+        const double now = Now();
+
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.fd == m_socket) {
+                ReceiveBatch(now);
+            } else if (events[i].data.fd == m_wakeEvent) {
+                uint64_t count;
+                ssize_t bytes = read(m_wakeEvent, &count, sizeof(count));
+                (void)bytes;
+            }
+        }
+
+        if (m_emulateLink) DeliverInbound(now);
+        FlushEventBacklog();
+        UpdateConnections(now);
+        SendBatch(now);
+    }
+
+    // Flush whatever Stop() queued
+    SendBatch(Now());
+}
+
+void CyborUdpTransport::ReceiveBatch(double now) {
+    mmsghdr messages[BATCH_SIZE];
+    iovec vectors[BATCH_SIZE];
+    sockaddr_in addresses[BATCH_SIZE];
+
+    for (;;) {
+        // Datagrams land directly in pooled buffers; only slots handed out last time need refilling
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            CyborPacketPtr& packet = m_receivePackets[i];
+            if (!packet) {
+                packet = m_packetPool.Acquire(0);
+            } else {
+                packet->Reset(0);
+            }
+            vectors[i].iov_base = packet->Data();
+            vectors[i].iov_len = MAX_DATAGRAM_SIZE;
+            messages[i].msg_hdr = {};
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_len = 0;
+        }
+
+        int received = recvmmsg(m_socket, messages, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        if (received <= 0) break;
+
+        for (int i = 0; i < received; i++) {
+            m_packetsReceived++;
+            m_bytesReceived += messages[i].msg_len;
+            m_receivePackets[i]->Commit(messages[i].msg_len);
+            if (m_emulateLink) {
+                m_inboundLink.Submit(std::move(m_receivePackets[i]), addresses[i].sin_addr.s_addr,
+                                     addresses[i].sin_port, now, m_packetPool);
+            } else {
+                HandlePacket(addresses[i].sin_addr.s_addr, addresses[i].sin_port, m_receivePackets[i], now);
+            }
+        }
+
+        if (received < BATCH_SIZE) break;
+    }
+}
+
+void CyborUdpTransport::SendBatch(double now) {
+    // Handshake replies first, then whatever the game thread queued
+    m_sending.swap(m_controlPackets);
+    OutgoingPacket outgoing;
+    while (m_outgoingQueue.TryPop(outgoing)) {
+        m_sending.push_back(std::move(outgoing));
+    }
+    if (m_sending.empty() && (!m_emulateLink || m_outboundLink.IsIdle())) return;
+
+    mmsghdr messages[BATCH_SIZE];
+    iovec vectors[BATCH_SIZE];
+    sockaddr_in addresses[BATCH_SIZE];
+    int pending = 0;
+
+    auto submit = [&]() {
+        int offset = 0;
+        while (offset < pending) {
+            int sent = sendmmsg(m_socket, messages + offset, pending - offset, 0);
+            if (sent <= 0) break; // Kernel queue full, drop like the network would
+            for (int i = offset; i < offset + sent; i++) {
+                m_packetsSent++;
+                m_bytesSent += messages[i].msg_len;
+            }
+            offset += sent;
+        }
+        pending = 0;
+    };
+
+    // The iovec points straight at the pooled buffer; a broadcast shares one buffer across peers
+    auto queue = [&](uint32_t address, uint16_t port, CyborPacketBuffer& packet) {
+        addresses[pending] = {};
+        addresses[pending].sin_family = AF_INET;
+        addresses[pending].sin_addr.s_addr = address;
+        addresses[pending].sin_port = port;
+
+        vectors[pending].iov_base = packet.Data();
+        vectors[pending].iov_len = packet.Size();
+
+        messages[pending].msg_hdr = {};
+        messages[pending].msg_hdr.msg_name = &addresses[pending];
+        messages[pending].msg_hdr.msg_namelen = sizeof(addresses[pending]);
+        messages[pending].msg_hdr.msg_iov = &vectors[pending];
+        messages[pending].msg_hdr.msg_iovlen = 1;
+        messages[pending].msg_len = 0;
+
+        if (++pending == BATCH_SIZE) submit();
+    };
+
+    // Emulated links get their own copy per peer and release it when it is due
+    auto dispatch = [&](uint32_t peerId, const OutgoingPacket& packet) {
+        Peer& peer = m_peers[peerId];
+        peer.lastSendTime = now;
+        if (!m_emulateLink) {
+            queue(peer.address, peer.port, *packet.packet);
+            return;
+        }
+        CyborPacketPtr copy = m_packetPool.Acquire(0);
+        copy->Append(packet.packet->Data(), packet.packet->Size());
+        m_outboundLink.Submit(std::move(copy), peer.address, peer.port, now, m_packetPool);
+    };
+
+    for (OutgoingPacket& packet : m_sending) {
+        // Header goes into the headroom in front of the payload
+        uint8_t* header = packet.packet->Prepend(HEADER_SIZE);
+        std::memcpy(header, &PROTOCOL_ID, sizeof(PROTOCOL_ID));
+        header[4] = static_cast<uint8_t>(packet.type);
+
+        if (packet.peerId == INVALID_PEER) {
+            for (uint32_t peerId = 0; peerId < m_peers.size(); peerId++) {
+                if (m_peers[peerId].state == PeerState::CONNECTED) dispatch(peerId, packet);
+            }
+        } else if (packet.peerId < m_peers.size() && m_peers[packet.peerId].state != PeerState::DISCONNECTED) {
+            dispatch(packet.peerId, packet);
+        }
+    }
+
+    if (m_emulateLink) {
+        CyborLinkEmulator::Delivery delivery;
+        while (m_outboundLink.PollDelivered(now, delivery)) {
+            m_linkDeliveries.push_back(std::move(delivery));
+        }
+        for (CyborLinkEmulator::Delivery& due : m_linkDeliveries) {
+            queue(due.address, due.port, *due.packet);
+        }
+    }
+    submit();
+    m_linkDeliveries.clear();
+
+    // Disconnects take effect once the goodbye is on the wire
+    for (const OutgoingPacket& packet : m_sending) {
+        if (packet.type != PacketType::DISCONNECT) continue;
+        for (uint32_t peerId = 0; peerId < m_peers.size(); peerId++) {
+            if ((packet.peerId == INVALID_PEER || packet.peerId == peerId) &&
+                m_peers[peerId].state != PeerState::DISCONNECTED) {
+                ReleasePeer(peerId);
+                PushEvent(Event::Type::DISCONNECTED, peerId);
+            }
+        }
+    }
+
+    m_sending.clear();
+}
+
+void CyborUdpTransport::SendDirect(uint32_t address, uint16_t port, PacketType type) {
+    uint8_t packet[HEADER_SIZE];
+    std::memcpy(packet, &PROTOCOL_ID, sizeof(PROTOCOL_ID));
+    packet[4] = static_cast<uint8_t>(type);
+
+    sockaddr_in destination = {};
+    destination.sin_family = AF_INET;
+    destination.sin_addr.s_addr = address;
+    destination.sin_port = port;
+    sendto(m_socket, packet, sizeof(packet), 0, reinterpret_cast<sockaddr*>(&destination), sizeof(destination));
+}
+
+#else
+
+// epoll and the batched socket calls are Linux-only
+bool CyborUdpTransport::OpenSocket(uint16_t) {
+    std::cerr << "CyborUdpTransport requires Linux (epoll, recvmmsg, sendmmsg)" << std::endl;
+    return false;
+}
+
+void CyborUdpTransport::CloseSocket() {}
+void CyborUdpTransport::NetworkThreadFunction() {}
+void CyborUdpTransport::ReceiveBatch(double) {}
+void CyborUdpTransport::SendBatch(double) {}
+void CyborUdpTransport::SendDirect(uint32_t, uint16_t, PacketType) {}
+
+#endif
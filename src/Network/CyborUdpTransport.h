@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "CyborPacketBuffer.h"
+#include "CyborLinkEmulator.h"
+#include "../Engine/CyborSpscQueue.h"
+
+/*
+ * CyborUdpTransport - Non-blocking UDP transport on a dedicated network thread
+ * epoll drives the socket, datagrams move in recvmmsg/sendmmsg batches and
+ * every peer gets its own connection state (handshake, keepalive, timeout)
+ */
+class CyborUdpTransport {
+public:
+    enum class PeerState : uint8_t {
+        DISCONNECTED,
+        CONNECTING,
+        CONNECTED
+    };
+
+    struct Event {
+        enum class Type : uint8_t {
+            CONNECTED,
+            DISCONNECTED,
+            PAYLOAD
+        };
+
+        Type type;
+        uint32_t peerId;
+        CyborPacketPtr packet; // PAYLOAD without the transport header; "ip:port" on a server's CONNECTED
+        double time;           // When the network thread saw it, on the Now() clock
+    };
+
+    static constexpr uint32_t INVALID_PEER = 0xFFFFFFFFu;
+    static constexpr size_t MAX_PACKET_SIZE = 1400;
+    static constexpr size_t HEADER_SIZE = 5; // Protocol id and packet type
+    static constexpr size_t MAX_PAYLOAD_SIZE = MAX_PACKET_SIZE - HEADER_SIZE;
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+
+public:
+    CyborUdpTransport();
+    ~CyborUdpTransport();
+
+    // Lifecycle, both start the network thread
+    bool StartServer(uint16_t port, int maxPeers);
+    bool StartClient(const std::string& address, uint16_t port);
+    void Stop();
+    bool IsRunning() const { return m_running; }
+    bool IsServer() const { return m_isServer; }
+
+    // Game thread API, never blocks on the network thread. Sends are queued and
+    // handed over by Flush(); they fail only when the outgoing queue is full.
+    // Build payloads directly in an acquired packet; the transport header goes into its headroom.
+    CyborPacketPtr AcquirePacket() { return m_packetPool.Acquire(); }
+    bool Send(uint32_t peerId, CyborPacketPtr packet);
+    bool Send(uint32_t peerId, const uint8_t* data, size_t size);
+    void Broadcast(const uint8_t* data, size_t size);
+    void Flush();
+    bool PollEvent(Event& outEvent);
+    void DisconnectPeer(uint32_t peerId);
+
+    // Peer info
+    uint32_t GetLocalPeerId() const { return m_localPeerId; }
+    std::string GetPeerAddress(uint32_t peerId) const;
+    int GetConnectedPeerCount() const { return m_connectedPeers; }
+
+    // Steady clock in seconds, the one event times are on
+    static double Now();
+
+    // Counters
+    uint64_t GetPacketsSent() const { return m_packetsSent; }
+    uint64_t GetPacketsReceived() const { return m_packetsReceived; }
+    uint64_t GetBytesSent() const { return m_bytesSent; }
+    uint64_t GetBytesReceived() const { return m_bytesReceived; }
+    const CyborPacketPool& GetPacketPool() const { return m_packetPool; }
+
+    // Testing: impair this endpoint's traffic, each direction through its own seeded
+    // emulator. Only while stopped; packets still on the emulated link at Stop() are lost.
+    bool SetLinkEmulation(const CyborLinkEmulator::Settings& outbound, const CyborLinkEmulator::Settings& inbound,
+                          uint64_t seed);
+    bool DisableLinkEmulation();
+    const CyborLinkEmulator& GetOutboundLink() const { return m_outboundLink; } // Read while stopped
+    const CyborLinkEmulator& GetInboundLink() const { return m_inboundLink; }
+
+    // Tuning
+    static constexpr double CONNECT_RETRY_INTERVAL = 0.25;
+    static constexpr double KEEPALIVE_INTERVAL = 0.25;
+    static constexpr double CONNECTION_TIMEOUT = 5.0;
+
+private:
+    enum class PacketType : uint8_t {
+        CONNECT_REQUEST,
+        CONNECT_ACCEPT,
+        CONNECT_DENIED,
+        DISCONNECT,
+        KEEPALIVE,
+        PAYLOAD
+    };
+
+    struct Peer {
+        PeerState state;
+        uint32_t address; // IPv4, network byte order
+        uint16_t port;    // Network byte order
+        double lastReceiveTime;
+        double lastSendTime;
+        double connectStartTime;
+    };
+
+    // peerId INVALID_PEER goes to every connected peer
+    struct OutgoingPacket {
+        uint32_t peerId;
+        PacketType type;
+        CyborPacketPtr packet;
+    };
+
+    // Declared first so it outlives every queued packet
+    CyborPacketPool m_packetPool;
+
+    // Sockets
+    int m_socket;
+    int m_epoll;
+    int m_wakeEvent;
+    std::thread m_networkThread;
+    std::atomic<bool> m_running;
+    bool m_isServer;
+    int m_maxPeers;
+
+    // Peers, owned by the network thread
+    std::vector<Peer> m_peers;
+    std::unordered_map<uint64_t, uint32_t> m_addressToPeer;
+    std::atomic<uint32_t> m_localPeerId;
+    std::atomic<int> m_connectedPeers;
+    std::vector<std::string> m_peerAddresses; // Game thread, filled from CONNECTED events
+
+    // Game thread -> network thread, and back
+    CyborSpscQueue<OutgoingPacket> m_outgoingQueue;
+    CyborSpscQueue<Event> m_eventQueue;
+
+    // Network thread only
+    std::vector<OutgoingPacket> m_controlPackets;
+    std::vector<OutgoingPacket> m_sending;
+    std::vector<Event> m_eventBacklog; // Held back while the game thread is behind, order preserved
+    std::vector<CyborPacketPtr> m_receivePackets; // recvmmsg targets, refilled as payloads are handed out
+
+    // Link emulation, network thread only while running
+    bool m_emulateLink;
+    uint64_t m_linkSeed;
+    CyborLinkEmulator m_outboundLink;
+    CyborLinkEmulator m_inboundLink;
+    std::vector<CyborLinkEmulator::Delivery> m_linkDeliveries;
+
+    // Counters
+    std::atomic<uint64_t> m_packetsSent;
+    std::atomic<uint64_t> m_packetsReceived;
+    std::atomic<uint64_t> m_bytesSent;
+    std::atomic<uint64_t> m_bytesReceived;
+
+    // Private methods
+    bool OpenSocket(uint16_t bindPort);
+    void CloseSocket();
+    void NetworkThreadFunction();
+    void ReceiveBatch(double now);
+    void HandlePacket(uint32_t address, uint16_t port, CyborPacketPtr& packet, double now);
+    void SendBatch(double now);
+    void SendDirect(uint32_t address, uint16_t port, PacketType type);
+    void UpdateConnections(double now);
+    bool PushOutgoing(uint32_t peerId, PacketType type, CyborPacketPtr packet);
+    void QueueControl(uint32_t peerId, PacketType type, const uint8_t* data = nullptr, size_t size = 0);
+    void FlushEventBacklog();
+    void ResetLinkEmulation();
+    void DeliverInbound(double now);
+    uint32_t AllocatePeer(uint32_t address, uint16_t port, double now);
+    void ReleasePeer(uint32_t peerId);
+    void PushEvent(Event::Type type, uint32_t peerId, CyborPacketPtr packet = CyborPacketPtr());
+    CyborPacketPtr FormatAddress(uint32_t address, uint16_t port);
+    static uint64_t AddressKey(uint32_t address, uint16_t port);
+};